@@ -34,6 +34,13 @@ public:
     AudioTrack(const std::string& title, const std::vector<std::string>& artists, 
                int duration, int bpm, size_t waveform_samples = 1000);
 
+    /**
+     * Constructor - uses a stored waveform (e.g. from a library snapshot)
+     * instead of generating one; the samples are copied
+     */
+    AudioTrack(const std::string& title, const std::vector<std::string>& artists, 
+               int duration, int bpm, const double* waveform, size_t waveform_samples);
+
     // ========== RULE OF 5 - STUDENTS MUST IMPLEMENT ALL OF THESE ==========
 
     /**
@@ -91,6 +98,12 @@ public:
      */
     virtual double get_quality_score() const = 0;
 
+    /**
+     * Pure virtual function - how precisely the format pins down beats (1 = exact)
+     * MP3 loses precision with compression; analyze_beatgrid() reports it
+     */
+    virtual double get_precision_factor() const = 0;
+
     /**
      * Pure virtual function - create a copy of this track
      * Demonstrates the prototype pattern with polymorphism
@@ -107,6 +120,9 @@ public:
     int get_bpm() const { return bpm; }
     int get_duration() const { return duration_seconds; }
     std::vector<std::string> get_artists() const { return artists; }
+    size_t get_waveform_size() const { return waveform_size; }
+    const double* get_waveform_data() const { return waveform_data; }
+    double get_estimated_beats() const { return (static_cast<double>(duration_seconds) / 60.0) * bpm; }
 
     // ========== SETTER FUNCTIONS ==========
     void set_bpm(int new_bpm);
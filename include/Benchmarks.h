@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Benchmarks and self-checks run by `dj_manager -B <name> [name=value ...]`
+ *
+ * Each benchmark generates its workload with ConfigGenerator into a scratch
+ * directory (removed afterwards), runs the code under test with its log output
+ * discarded, and prints one line per measurement. Results are also checked
+ * against a plain reference implementation; any mismatch fails the run.
+ *
+ * Benchmarks:
+ * - query: DJLibraryService::queryTracks against a column scan, for libraries of
+ *   10^3 tracks up to tracks=<max> (default 10^6) in steps of 10x
+ * - suggest: DJLibraryService::suggestNextTracks (k=<count> suggestions, default 10)
+ *   against a brute-force nearest-neighbour scan, for libraries of 10^3 tracks up to
+ *   tracks=<max> (default 10^5), then again while tracks are added, updated and removed
+ * - parse: single-threaded SessionFileParser::parse_config_file throughput (MB/s and
+ *   tracks/s, best of repeat=<runs>) on a config of tracks=<count> (default 2*10^6)
+ *   with a few malformed lines; every track must be parsed back. Then the same for
+ *   1, 2, 4, ... up to threads=<count> (default: hardware threads) parse threads, each
+ *   of which must produce the tracks, playlists and warnings of the sequential parse
+ * - malformed: checks every config of corpus=<dir> (default input_2/malformed) against
+ *   its "#expect name=value" comment lines (tracks, playlists, warnings, bpms, warning
+ *   texts and numeric settings), then times parsing a generated config of tracks=<count>
+ *   (default 10^6) without and with malformed=<rate> (default 1) invalid track lines
+ *   per valid one
+ * - playlists: SessionFileParser::parse_playlist_directory on files=<count> (default
+ *   10^4) generated .playlist files drawing from tracks=<count> (default 10^5) tracks,
+ *   for 1, 2, 4, ... up to threads=<count> parse threads (best of repeat=<runs>), each
+ *   of which must produce the playlists of the sequential parse. Then
+ *   DJLibraryService::resolvePlaylistTracks into the generated library and into an
+ *   empty one; every resolved ID must name its line's title
+ * - store: TrackStore's batch kernels (quality scores, beat-grid analysis, and
+ *   load() plus analyze_beatgrid()) against the same work as a virtual call per
+ *   AudioTrack*, over every track of generated libraries of 10^3 tracks up to
+ *   tracks=<max> (default 10^5), best of repeat=<runs>; the scores and analyses
+ *   must be equal and both passes must print the same lines
+ */
+class Benchmarks {
+public:
+    /**
+     * @brief Run one benchmark
+     * @param name Benchmark name (see above)
+     * @param options name=value options; unknown ones are rejected
+     * @return false if an option is invalid, the workload cannot be written or a check fails
+     */
+    static bool run(const std::string& name, const std::vector<std::string>& options);
+
+private:
+    struct Options {
+        size_t tracks;          // Largest library size; 0 = the benchmark's default
+        size_t queries;         // Queries per library size
+        size_t k;               // Suggestions per query
+        size_t repeat;          // Timed runs of which the fastest counts
+        size_t threads;         // Most threads of a scaling sweep; 0 = hardware concurrency
+        size_t files;           // Generated playlist files; 0 = the benchmark's default
+        double malformed_rate;  // Invalid track lines per valid one
+        std::string corpus;     // Directory of annotated configs
+        uint64_t seed;          // Workload and query generation
+
+        Options()
+            : tracks(0), queries(1000), k(10), repeat(3), threads(0), files(0), malformed_rate(1.0),
+              corpus("input_2/malformed"), seed(1) {}
+    };
+
+    /**
+     * @brief Apply one name=value option
+     * @return false (after an error message) for an unknown name or a bad value
+     */
+    static bool parse_option(const std::string& option, Options& options);
+
+    static bool run_query_benchmark(const Options& options);
+    static bool run_suggest_benchmark(const Options& options);
+    static bool run_parse_benchmark(const Options& options);
+    static bool run_malformed_benchmark(const Options& options);
+    static bool run_playlists_benchmark(const Options& options);
+    static bool run_store_benchmark(const Options& options);
+};
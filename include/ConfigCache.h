@@ -0,0 +1,142 @@
+#pragma once
+
+#include "SessionFileParser.h"
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Sidecar cache of what a config file parsed to (<config>.cache)
+ *
+ * The cache is keyed by a hash of the config's contents, not its timestamp, so
+ * a touched or re-checked-out file still hits. It replays exactly what the
+ * parser would produce: the settings the file assigns, its playlists, its
+ * warnings (between the same tracks) and its library tracks in batches.
+ *
+ * While a config is parsed, a ConfigCache streams each track and warning to
+ * <config>.cache.tmp as it is handed over; write() appends the settings, fills
+ * in the header and renames the file over the sidecar. replay() checks the whole
+ * mapped sidecar before the caller sees any of it, so an unreadable one costs a
+ * text parse, never a half-applied config, and then decodes one batch of tracks
+ * at a time. Neither side holds more than a batch of tracks in memory.
+ *
+ * File layout (host byte order): Header, then the payload: records (a uint8 tag,
+ * then a track or a warning's text) in the order the parser handed them over,
+ * then settings (tuning entries included) and playlists from settings_offset.
+ * Strings are a uint32 length and the bytes.
+ */
+class ConfigCache {
+public:
+    enum class LoadResult {
+        LOADED,     // Everything was decoded
+        MISSING,    // No usable cache (absent, for other contents, or an old format)
+        CORRUPT     // Checksummed but undecodable; the sidecar should be rewritten
+    };
+
+    /**
+     * @brief Sidecar path of a config file
+     */
+    static std::string path_for(const std::string& config_path) { return config_path + ".cache"; }
+
+    /**
+     * @brief 64-bit hash of a file's contents, eight bytes per step (not cryptographic)
+     */
+    static uint64_t hash_contents(const char* data, size_t size);
+
+    /**
+     * @brief Replay a cache written for the given contents
+     * @param on_tracks Receives the cached tracks in batches of batch_size; each warning is
+     * printed between the same tracks as when the cache was written
+     * @param settings Receives the cached setting values and playlists
+     * @param assigned_settings Receives which settings the config assigns (SessionFileParser bits)
+     * @param track_count Receives the number of tracks replayed
+     * @note Nothing is handed over or printed unless LOADED is returned; settings may
+     * then be partly written, so pass a scratch object.
+     */
+    static LoadResult replay(const std::string& cache_path, uint64_t content_hash, uint64_t content_size,
+                             size_t batch_size, const SessionFileParser::TrackBatchHandler& on_tracks,
+                             SessionConfig& settings, unsigned& assigned_settings, size_t& track_count);
+
+    /**
+     * @brief Start writing the cache of a config to <cache_path>.tmp
+     * The sidecar itself is only replaced by write(); an unfinished temporary file is removed
+     */
+    ConfigCache(const std::string& cache_path, uint64_t content_hash, uint64_t content_size);
+    ~ConfigCache();
+    ConfigCache(const ConfigCache&) = delete;
+    ConfigCache& operator=(const ConfigCache&) = delete;
+
+    /**
+     * @brief Record parsed tracks (before the batch handler can move from them)
+     */
+    void add_tracks(const std::vector<SessionConfig::TrackInfo>& batch);
+
+    /**
+     * @brief Record a printed warning, after the tracks handed over before it
+     */
+    void add_warning(const std::string& text);
+
+    /**
+     * @brief Finish the cache and replace the sidecar with it
+     * @param settings Setting values and playlists of the whole file
+     * @param assigned_settings Which settings the file assigns
+     * @return false (after a warning) if the file cannot be written
+     */
+    bool write(const SessionConfig& settings, unsigned assigned_settings);
+
+private:
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t header_size;
+        uint64_t content_hash;
+        uint64_t content_size;
+        uint64_t payload_size;
+        uint64_t payload_checksum;      // hash_contents of the payload
+        uint64_t settings_offset;       // Into the payload; the records end there
+        uint64_t track_count;
+        uint64_t warning_count;
+        uint64_t playlist_count;
+        uint32_t assigned_settings;
+        uint32_t reserved;
+    };
+
+    /**
+     * @brief Incremental form of hash_contents; the result does not depend on how
+     * the bytes are split across update() calls
+     */
+    class WordHasher {
+    public:
+        WordHasher();
+        void update(const char* data, size_t size);
+        uint64_t finish();
+
+    private:
+        uint64_t hash;
+        uint64_t total;
+        char pending[8];        // Bytes of a word not yet mixed
+        size_t pending_size;
+
+        void mix(const char* bytes);
+    };
+
+    static const uint32_t FORMAT_VERSION = 4;
+
+    /**
+     * @brief Write bytes of the payload to the temporary file, checksumming them
+     */
+    void append(const std::string& bytes);
+
+    std::string cache_path;
+    std::string temp_path;
+    std::ofstream out;
+    WordHasher checksum;
+    std::string record;         // Serialization buffer, reused for every record
+    uint64_t content_hash;
+    uint64_t content_size;
+    uint64_t payload_size;
+    uint64_t track_count;
+    uint64_t warning_count;
+};
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Writes synthetic session configs and .playlist files for benchmarks
+ *
+ * generate(dir) writes a workload directory laid out like a session's working
+ * directory: dir/bin/dj_config.txt and, if asked for, .playlist files in dir/playlists,
+ * so `cd dir && dj_manager -I -A` runs it as is. Output depends only on the
+ * options (including the seed).
+ *
+ * Playlists pick their tracks by a Zipf law over a shuffled popularity ranking:
+ * with exponent s the k-th most popular track is picked with weight 1/k^s, so a
+ * few tracks recur across many playlists (s = 0 picks uniformly).
+ */
+class ConfigGenerator {
+public:
+    /**
+     * @brief How playlist lengths are drawn from [min, max]
+     * - UNIFORM: every length equally likely
+     * - NORMAL: centred on the middle of the range, 99.7% of draws inside it (clamped)
+     * - ZIPF: mostly short playlists with a long tail (length - min + 1 is Zipf, s = 1)
+     */
+    enum class LengthDistribution { UNIFORM, NORMAL, ZIPF };
+
+    struct Options {
+        size_t track_count;
+        size_t playlist_count;              // Config playlists (name=1,2,3 lines)
+        size_t playlist_file_count;         // .playlist files
+        size_t min_playlist_length;
+        size_t max_playlist_length;
+        LengthDistribution length_distribution;
+        double zipf_exponent;               // Track reuse skew; 0 = uniform
+        size_t min_title_length;
+        size_t max_title_length;
+        size_t max_artists;                 // Per track, at least 1
+        double malformed_rate;              // Extra invalid track lines per valid one
+        uint64_t seed;
+
+        Options()
+            : track_count(10000), playlist_count(100), playlist_file_count(0),
+              min_playlist_length(5), max_playlist_length(50), length_distribution(LengthDistribution::UNIFORM),
+              zipf_exponent(1.0), min_title_length(8), max_title_length(40), max_artists(3),
+              malformed_rate(0.0), seed(1) {}
+    };
+
+    /**
+     * @brief Apply one name=value command-line option
+     * @return false (after an error message) for an unknown name or a bad value
+     *
+     * Names: tracks, playlists, playlist_files, playlist_length=<min>:<max>,
+     * length_distribution=uniform|normal|zipf, zipf=<exponent>,
+     * title_length=<min>:<max>, max_artists, malformed=<rate>, seed
+     */
+    static bool parse_option(const std::string& option, Options& options);
+
+    explicit ConfigGenerator(const Options& options);
+
+    /**
+     * @brief Write the workload into a directory (created if needed)
+     * @return false if a file cannot be written
+     * @note Files are overwritten; .playlist files from an earlier, larger run are left in place
+     */
+    bool generate(const std::string& directory);
+
+private:
+    /**
+     * @brief Draws ranks 1..n with weight 1/k^exponent by rejection-inversion
+     * (Hormann and Derflinger), in constant time and memory
+     */
+    class ZipfSampler {
+    public:
+        ZipfSampler(size_t n, double exponent);
+        size_t draw(uint64_t& random_state) const;
+
+    private:
+        double exponent;
+        double n;
+        double h_integral_x1;
+        double h_integral_n;
+        double squeeze;
+
+        double h(double x) const;
+        double h_integral(double x) const;
+        double h_integral_inverse(double x) const;
+    };
+
+    Options options;
+    uint64_t random_state;              // Playlist draws
+    std::vector<uint32_t> popularity;   // Track index (0-based) of each popularity rank
+    ZipfSampler track_ranks;
+    ZipfSampler length_ranks;           // For LengthDistribution::ZIPF
+
+    bool write_config(const std::string& path);
+    bool write_playlist_file(const std::string& path, size_t number);
+
+    size_t draw_playlist_length();
+    size_t draw_track();                // 0-based track index
+
+    /**
+     * @brief Append "type,title,artists,duration,bpm,param1,param2" for a track
+     * @param artist_list true for the config's {a;b;} list, false for a .playlist's single artist
+     * @note A track's fields depend only on the seed and its index, so the config and
+     * the .playlist files agree without keeping every track in memory
+     */
+    void append_track_fields(std::string& line, size_t track, bool artist_list) const;
+};
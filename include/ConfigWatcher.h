@@ -0,0 +1,40 @@
+#pragma once
+
+#include <string>
+
+/**
+ * @brief Notices when a config file is rewritten (Linux inotify)
+ *
+ * Watches the file's directory rather than the file itself, so a file that an
+ * editor saves by writing a new copy and renaming it over the old one is still
+ * seen. Nothing runs in the background: the owner calls poll() at points where
+ * it is safe to apply a reload, and poll() never blocks.
+ */
+class ConfigWatcher {
+public:
+    ConfigWatcher();
+    ~ConfigWatcher();
+    ConfigWatcher(const ConfigWatcher&) = delete;
+    ConfigWatcher& operator=(const ConfigWatcher&) = delete;
+
+    /**
+     * @brief Start watching a file (stops watching any previous one)
+     * @return false if inotify is unavailable or the directory cannot be watched
+     */
+    bool watch(const std::string& path);
+
+    void stop();
+    bool is_watching() const { return inotify_fd >= 0; }
+
+    /**
+     * @brief Drain pending events without blocking
+     * @return true if the file was written and closed, or renamed into place,
+     * since the last call (several saves in a row are reported once)
+     */
+    bool poll();
+
+private:
+    int inotify_fd;
+    int watch_descriptor;
+    std::string file_name;      // Name of the watched file within its directory
+};
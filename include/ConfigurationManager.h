@@ -1,50 +1,133 @@
 #pragma once
 
+#include <functional>
+#include <iosfwd>
+#include <map>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 /**
  * @brief Configuration Management (Single Responsibility)
- * 
+ *
  * Handles application configuration settings from config files.
  * Phase 4 note: For this assignment, the playlists directory is always "./playlists"
  * and cache capacity is fixed to 8 by policy; ConfigurationManager may still parse
  * bpm_tolerance and auto_sync.
+ *
+ * It also owns the tuning registry: typed performance knobs set by
+ * tuning.<name>=<value> lines of the session config. Every knob has a type, a
+ * default and a valid range; a value outside it is rejected with a warning.
+ * Services register hooks to react when a (re)load changes a knob.
  */
 class ConfigurationManager {
+public:
+    /**
+     * @brief Knobs of the tuning registry (see TUNABLES in ConfigurationManager.cpp)
+     */
+    enum class Tunable {
+        PARSE_THREADS,          // Config and .playlist parsing; 0 = hardware concurrency
+        PARSE_BATCH_SIZE,       // Library tracks per parser batch
+        BUILD_THREADS,          // Materializing a loaded playlist's tracks; 0 = hardware concurrency
+        OPTIMIZER_THREADS,      // BPM order search; 0 = hardware concurrency
+        PRINT_SETTINGS,         // Print the effective settings after each (re)load
+        SUGGEST_NEXT,           // Library tracks suggested after each deck load; 0 = off
+        PLAYLIST_ANALYSIS,      // Print quality and beat-grid totals of each loaded playlist
+        COUNT
+    };
+
+    /**
+     * @brief Called with a knob's new value after a load changed it
+     */
+    typedef std::function<void(Tunable knob, int value)> TuningHook;
+
+    // Config keys of the registry start with this prefix
+    static const char* const TUNING_PREFIX;
+
 private:
     int cache_size;
     int bpm_tolerance;
     bool auto_sync;
-    
+
     // Additional config parameters
     std::unordered_map<std::string, std::string> additional_settings;
 
+    // Tuning registry, indexed by Tunable
+    std::vector<int> tuning_values;
+    std::vector<std::vector<TuningHook>> tuning_hooks;
+
+    /**
+     * @brief Parse an integer setting, warning and leaving it unchanged if invalid
+     */
+    static void parseIntSetting(const std::string& key, const std::string& value, int& setting);
+
+    /**
+     * @brief Check a tuning value against its knob's type and range
+     * @param value Output, unchanged (after a warning) if the text is rejected
+     */
+    static bool parseTuningValue(Tunable knob, const std::string& text, int& value);
+
 public:
     /**
      * @brief Construct with default configuration
      */
     ConfigurationManager();
-    
+
     /**
      * @brief Load configuration from file
      * @param config_path Path to dj_config.txt file
      * @return true if loaded successfully
      */
     bool loadFromFile(const std::string& config_path);
-    
+
     // Configuration getters
     int getCacheSize() const { return cache_size; }
     int getBPMTolerance() const { return bpm_tolerance; }
     bool getAutoSync() const { return auto_sync; }
-    
+
     /**
      * @brief Get additional configuration value by key
      */
     std::string getSetting(const std::string& key) const;
-    
+
     /**
      * @brief Display current configuration
      */
     void displayConfiguration() const;
+
+    // ========== TUNING REGISTRY ==========
+
+    /**
+     * @brief Set every knob from a config's tuning entries (name without the prefix -> value)
+     * @return false if an entry was rejected (unknown name, or a value of the wrong
+     * type or out of range); that knob keeps its current value
+     *
+     * A knob the entries leave out goes back to its default, so removing a line
+     * from the config undoes it on reload. Hooks run once every entry is applied,
+     * for each knob whose value changed.
+     */
+    bool applyTuning(const std::map<std::string, std::string>& entries);
+
+    /**
+     * @brief Register a hook run whenever applyTuning changes a knob
+     */
+    void onTuningChange(Tunable knob, const TuningHook& hook);
+
+    int getTuning(Tunable knob) const { return tuning_values[static_cast<size_t>(knob)]; }
+
+    /**
+     * @brief Config key of a knob, without the prefix
+     */
+    static const char* tuningName(Tunable knob);
+
+    /**
+     * @brief A knob value as it is written in the config (true/false for a flag)
+     */
+    static std::string tuningText(Tunable knob, int value);
+
+    /**
+     * @brief Write every knob as a tuning.<name>=<value> config line, defaults included,
+     * so the output can be pasted into a config to reproduce a run
+     */
+    void printTuning(std::ostream& out) const;
 };
\ No newline at end of file
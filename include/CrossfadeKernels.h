@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+
+/**
+ * @brief Gain curve of a crossfade, by ramp position t in [0, 1]
+ * - EQUAL_POWER: outgoing cos(t*pi/2), incoming sin(t*pi/2); the summed power
+ *   stays constant, so uncorrelated tracks do not dip in loudness mid-fade
+ * - LINEAR: outgoing 1 - t, incoming t
+ */
+enum class CrossfadeCurve { EQUAL_POWER, LINEAR };
+
+/**
+ * @brief Mix two sample buffers under a crossfade gain ramp
+ * output[i] = outgoing[i] * gain_out(t) + incoming[i] * gain_in(t),
+ * with t = (ramp_offset + i) / (ramp_length - 1)
+ * @param count Samples to write (ramp_offset + count <= ramp_length)
+ * @param ramp_offset Position of outgoing[0] in the whole ramp, so a long fade
+ * can be rendered in blocks
+ * @param ramp_length Samples in the whole ramp; the first is all outgoing, the
+ * last all incoming (a ramp of 1 sample is all incoming)
+ *
+ * Gains are computed per sample from the index, never accumulated, so blocks
+ * join without drift. Equal-power gains use a polynomial sine (error < 1e-7)
+ * instead of libm calls. The loop runs two samples per SSE2 instruction where
+ * SSE2 is available, and the same arithmetic in scalar code elsewhere.
+ * output may alias either input.
+ */
+void crossfade(const double* outgoing, const double* incoming, double* output, size_t count,
+               size_t ramp_offset, size_t ramp_length, CrossfadeCurve curve);
+
+/**
+ * @brief Parse "equal_power" or "linear"
+ * @return false (curve unchanged) for anything else
+ */
+bool parse_crossfade_curve(const char* first, const char* last, CrossfadeCurve& curve);
+
+/**
+ * @brief Config spelling of a curve
+ */
+const char* crossfade_curve_name(CrossfadeCurve curve);
@@ -40,6 +40,13 @@ public:
      */
     AudioTrack* getTrackFromCache(const std::string& track_title);
 
+    /**
+     * @brief Drop a cached track whose library entry was removed or changed.
+     * @param track_title The title of the track to drop.
+     * @return true if the track was cached.
+     */
+    bool removeTrackFromCache(const std::string& track_title);
+
 private:
     LRUCache cache;
 };
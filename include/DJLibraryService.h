@@ -1,21 +1,42 @@
-<<<<<<< HEAD
 #ifndef DJLIBRARYSERVICE_H
 #define DJLIBRARYSERVICE_H
 
 #include "Playlist.h"
 #include "AudioTrack.h"
 #include "SessionFileParser.h"
+#include "TrackMetadataTable.h"
+#include "TrackQueryIndex.h"
+#include "TrackSuggestionIndex.h"
 #include <vector>
 #include <string>
+#include <functional>
+#include <map>
+#include <memory>
+#include <unordered_map>
+
+class LibrarySnapshot;
 
 // Service responsible for managing the track library and playlists
 // Phase 4 behavior alignment:
 // - Load library tracks from config file
 // - Build playlists from track indices referencing the library
+// Ownership: library owns every AudioTrack; the playlist only borrows them,
+// so the playlist must never outlive (or be handed tracks from) another library
+// Storage: track metadata lives in a columnar TrackMetadataTable; the heavy
+// AudioTrack objects are only created when a track is first needed for playback
+// Edits: addTrack/removeTrack/updateTrack change one track at a time and keep the
+// lookup indexes and the loaded playlist current; IDs are never reused or shifted
 class DJLibraryService {
 public:
+    /**
+     * @brief Called when a playlist track is ready, once per position and in playlist order
+     * @param position 0-based position in the playlist being loaded
+     * @param track Library-owned track at that position
+     */
+    typedef std::function<void(size_t position, AudioTrack* track)> TrackReadyHandler;
+
     DJLibraryService(const Playlist& playlist);
-    DJLibraryService() = default;
+    DJLibraryService();
     // =================================================================================
     // Rule of 3 Declarations
     // Required because we manage raw pointers in std::vector<AudioTrack*> library
@@ -41,15 +62,95 @@ public:
     /**
      * @brief Build the track library from parsed config data
      * @param library_tracks Vector of track info from config
+     * @note Only fills the metadata table; track objects are materialized on
+     * first use (loadPlaylistFromIndices, findTrack, findTrackById).
      */
     void buildLibrary(const std::vector<SessionConfig::TrackInfo>& library_tracks);
 
+    /**
+     * @brief Parse a config file and build the library from it as it is read
+     * @param config_path Text config file
+     * @param config Output for settings and playlists (library_tracks stays empty)
+     * @param batch_size Tracks per parser batch
+     * @param thread_count Parser threads (0 = hardware concurrency)
+     * @return false if the file could not be parsed
+     * @note Tracks go from the parser into the metadata table in small batches, so
+     * no full list of TrackInfo records is ever held next to the library.
+     */
+    bool buildLibraryFromFile(const std::string& config_path, SessionConfig& config, size_t batch_size = 1024,
+                              unsigned thread_count = 0);
+
+    /**
+     * @brief Append a batch of tracks to the library (metadata only, no logging)
+     */
+    void appendTracks(const std::vector<SessionConfig::TrackInfo>& tracks);
+
+    /**
+     * @brief Use a mapped library snapshot as the whole library
+     * @param snapshot Opened snapshot; the library keeps it mapped while in use
+     * @note Replaces any existing library. Constant time apart from resetting the
+     * track slots: metadata is read from the mapping and indexes are built on first use.
+     */
+    void attachSnapshot(const std::shared_ptr<const LibrarySnapshot>& snapshot);
+
+    /**
+     * @brief Add one track to the library
+     * @return 1-based ID of the new track
+     * @note Lookup indexes that are already built are updated in place (O(log n) amortized)
+     */
+    int addTrack(const SessionConfig::TrackInfo& track_info);
+
+    /**
+     * @brief Remove a track from the library
+     * @param track_id 1-based library ID
+     * @return false if there is no track with that ID
+     * @note The ID is not reused and other IDs do not shift, so playlist indices stay
+     * valid (the removed one becomes an invalid index). The track object, if any, is
+     * dropped from the loaded playlist and deleted: pointers to it become invalid.
+     */
+    bool removeTrack(int track_id);
+
+    /**
+     * @brief Replace a track's metadata, keeping its ID
+     * @param track_id 1-based library ID
+     * @param track_info New track data
+     * @return false if there is no track with that ID
+     * @note An existing track object is recreated from the new data and swapped into the
+     * loaded playlist; pointers to the old object become invalid.
+     */
+    bool updateTrack(int track_id, const SessionConfig::TrackInfo& track_info);
+
+    /**
+     * @brief Library IDs of parsed .playlist files' tracks, in playlist order
+     * @param playlists Parsed playlist files
+     * @param resolved Receives each playlist's IDs under its name
+     * @return Number of tracks added to the library
+     * @note Tracks are matched by title, like findTrack. Titles the library lacks are
+     * collected while the playlists are resolved and only then added, in order of first
+     * appearance, each from its first playlist line (with its one artist). So a library
+     * that already holds every title is not modified at all, and one attached to a
+     * snapshot stays mapped. Adds are silent, unlike addTrack, since a playlist directory
+     * can bring in thousands of them.
+     */
+    size_t resolvePlaylistTracks(const std::vector<PlaylistData>& playlists,
+                                 std::map<std::string, std::vector<int>>& resolved);
+
+    /**
+     * @brief Set the number of worker threads used to materialize tracks
+     * @param threads Thread count; 0 uses one per hardware thread
+     */
+    void set_build_threads(unsigned threads) { build_threads = threads; }
+
     /**
      * @brief Load a playlist by constructing it from track indices
      * @param playlist_name Name of the playlist
      * @param track_indices Vector of 1-based track indices referencing the library
+     * @param on_ready Optional; fires for position k as soon as tracks 0..k exist, while
+     * later tracks are still being created, so a caller can start on track 1 early.
+     * It runs on the calling thread; the playlist itself is replaced only after all tracks exist.
      */
-    void loadPlaylistFromIndices(const std::string& playlist_name, const std::vector<int>& track_indices);
+    void loadPlaylistFromIndices(const std::string& playlist_name, const std::vector<int>& track_indices,
+                                 const TrackReadyHandler& on_ready = TrackReadyHandler());
 
     // Returns a reference to the loaded playlist
     Playlist& getPlaylist();
@@ -62,9 +163,60 @@ public:
      * @param track_title The title of the track to find.
      * @return A raw pointer to the AudioTrack if found, otherwise nullptr.
      * The library retains ownership of the track.
+     * @note O(1) hash lookup; with duplicate titles the first library entry wins.
+     * Materializes the track if it has not been created yet.
      */
     AudioTrack* findTrack(const std::string& track_title);
 
+    /**
+     * @brief Find a track in the library by its ID.
+     * @param track_id 1-based library ID (N in library_track_N, as used by playlist indices)
+     * @return A raw pointer to the AudioTrack if found, otherwise nullptr.
+     * The library retains ownership of the track.
+     * Materializes the track if it has not been created yet.
+     */
+    AudioTrack* findTrackById(int track_id);
+
+    /**
+     * @brief Columnar metadata for every library track (row = ID - 1)
+     * @note Use this for scans and aggregations; it never creates track objects
+     */
+    const TrackMetadataTable& getMetadata() const { return metadata; }
+
+    /**
+     * @brief Find library tracks matching every filter of a query
+     * @param query BPM/duration ranges, format, minimum quality, artist, ordering and top-k limit
+     * @return 1-based library IDs (usable as playlist indices)
+     * @note Answered from the metadata indexes; no track objects are created
+     */
+    std::vector<int> queryTracks(const TrackQuery& query) const;
+
+    /**
+     * @brief Library tracks most similar to a given track, for picking what to play next
+     * @param current Track to match, e.g. MixingEngineService::get_active_track(); its
+     * current (possibly synced) BPM is used, and its library entry is never suggested
+     * @param k Number of suggestions
+     * @return Suggestions (1-based library IDs and distances), closest first
+     * @note Weighted BPM/quality/duration distance with a bonus for a shared artist;
+     * see TrackSuggestionIndex. No track objects are created.
+     */
+    std::vector<TrackSuggestionIndex::Suggestion> suggestNextTracks(const AudioTrack& current, size_t k) const;
+
+    /**
+     * @brief Same as above, for a library track given by its 1-based ID
+     */
+    std::vector<TrackSuggestionIndex::Suggestion> suggestNextTracks(int track_id, size_t k) const;
+
+    /**
+     * @brief Number of tracks in the library (removed tracks are not counted)
+     */
+    size_t getLibrarySize() const { return metadata.live_size(); }
+
+    /**
+     * @brief Number of library tracks that currently exist as AudioTrack objects
+     */
+    size_t getMaterializedCount() const;
+
     /**
      * @brief Get a vector of all track titles in the current playlist.
      * @return A vector of strings containing the track titles.
@@ -73,66 +225,84 @@ public:
 
 private:
     Playlist playlist;
-    std::vector<AudioTrack*> library;  // Library of all tracks (owned)
+    TrackMetadataTable metadata;       // One row per library track
+    std::vector<AudioTrack*> library;  // Track objects by row (owned); nullptr until materialized
+
+    // Lookup indexes over metadata, built on first use after a bulk load and then
+    // kept current by single-track edits. Title -> rows of the tracks with that
+    // title (the first one wins lookups); rows double as the ID index
+    mutable std::unordered_multimap<std::string, size_t> title_index;
+    mutable TrackQueryIndex query_index;
+    mutable TrackSuggestionIndex suggestion_index;
+    mutable bool title_index_ready;
+    mutable bool query_index_ready;
+    mutable bool suggestion_index_ready;
+
+    unsigned build_threads;
+
+    /**
+     * @brief Create the track objects for the given rows (in parallel) if missing
+     * @param rows Row indices; duplicates and already materialized rows are built once
+     * @param on_ready Optional; called with (k, track) for every k in order, as soon as rows[0..k] exist
+     * @note Workers take rows in order, so the first rows are ready first. Storing,
+     * logging (one creation line per new track) and on_ready all happen on the calling thread.
+     */
+    void materialize_rows(const std::vector<size_t>& rows, const TrackReadyHandler& on_ready = TrackReadyHandler());
+
+    /**
+     * @brief Track object for a row, materializing it if needed
+     */
+    AudioTrack* track_at(size_t row);
+
+    /**
+     * @brief Build the title index if the library changed since it was last built
+     */
+    void ensure_title_index() const;
+
+    /**
+     * @brief Lowest live row with a title, or size_t(-1)
+     */
+    size_t first_row_with_title(const std::string& title) const;
+
+    /**
+     * @brief Whether an ID names a track that is in the library
+     */
+    bool is_track_id(int track_id) const;
+
+    /**
+     * @brief Build the query (and artist posting list) index if it is out of date
+     */
+    void ensure_query_index() const;
+
+    /**
+     * @brief Build the suggestion index if it is out of date
+     */
+    void ensure_suggestion_index() const;
+
+    /**
+     * @brief Add a row that was just appended or overwritten to every built index
+     */
+    void index_row(size_t row);
+
+    /**
+     * @brief Drop a row from every built index; call before the row is removed or overwritten
+     */
+    void unindex_row(size_t row);
+
+    /**
+     * @brief Mark every lookup index out of date after the library changed
+     */
+    void invalidate_indexes();
+
+    /**
+     * @brief Deep copy other's metadata and materialized tracks, remapping the playlist
+     */
+    void copy_library_from(const DJLibraryService& other);
+
+    /**
+     * @brief Delete all track objects
+     */
+    void clear_library();
 };
 
 #endif // DJLIBRARYSERVICE_H
-=======
-#ifndef DJLIBRARYSERVICE_H
-#define DJLIBRARYSERVICE_H
-
-#include "Playlist.h"
-#include "AudioTrack.h"
-#include "SessionFileParser.h"
-#include <vector>
-#include <string>
-
-// Service responsible for managing the track library and playlists
-// Phase 4 behavior alignment:
-// - Load library tracks from config file
-// - Build playlists from track indices referencing the library
-class DJLibraryService {
-public:
-    DJLibraryService(const Playlist& playlist);
-    DJLibraryService(): playlist(), library(){}
-
-    /**
-     * @brief Build the track library from parsed config data
-     * @param library_tracks Vector of track info from config
-     */
-    void buildLibrary(const std::vector<SessionConfig::TrackInfo>& library_tracks);
-
-    /**
-     * @brief Load a playlist by constructing it from track indices
-     * @param playlist_name Name of the playlist
-     * @param track_indices Vector of 1-based track indices referencing the library
-     */
-    void loadPlaylistFromIndices(const std::string& playlist_name, const std::vector<int>& track_indices);
-
-    // Returns a reference to the loaded playlist
-    Playlist& getPlaylist();
-
-    // Display all playlists in the library (debug aid; optional for Phase 4)
-    void displayLibrary() const;
-
-    /**
-     * @brief Find a track in the library by its title.
-     * @param track_title The title of the track to find.
-     * @return A raw pointer to the AudioTrack if found, otherwise nullptr.
-     * The library retains ownership of the track.
-     */
-    AudioTrack* findTrack(const std::string& track_title);
-
-    /**
-     * @brief Get a vector of all track titles in the current playlist.
-     * @return A vector of strings containing the track titles.
-     */
-    std::vector<std::string> getTrackTitles() const;
-
-private:
-    Playlist playlist;
-    std::vector<AudioTrack*> library;  // Library of all tracks (owned)
-};
-
-#endif // DJLIBRARYSERVICE_H
->>>>>>> origin/main
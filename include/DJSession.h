@@ -1,4 +1,3 @@
-<<<<<<< HEAD
 #pragma once
 
 #include "DJLibraryService.h"
@@ -6,6 +5,8 @@
 #include "MixingEngineService.h"
 #include "SessionFileParser.h"
 #include "ConfigurationManager.h"
+#include "ConfigWatcher.h"
+#include "PlaylistOptimizer.h"
 #include <string>
 #include <vector>
 
@@ -27,6 +28,16 @@ struct ControllerStats {
  * @brief Professional DJ Session System Orchestrator
  */
 class DJSession {
+public:
+    /**
+     * @brief How a loaded playlist is ordered before playback
+     * - AS_CONFIGURED: play in the order the playlist was loaded
+     * - PREVIEW: print the BPM-optimized order, but play as configured
+     * - BPM_OPTIMIZED: play in the BPM-optimized order
+     * - CACHE_OPTIMIZED: replay repeated tracks while they are still cached
+     */
+    enum class OrderMode { AS_CONFIGURED, PREVIEW, BPM_OPTIMIZED, CACHE_OPTIMIZED };
+
 private:
     // Session identification
     std::string session_name;
@@ -39,8 +50,12 @@ private:
     // Configuration and session state
     ConfigurationManager config_manager;
     SessionConfig session_config;
+    ConfigWatcher config_watcher;
+    std::vector<int> config_track_ids;      // Library ID of each config library_track, in file order
+    std::map<std::string, std::vector<int>> directory_playlists;   // From .playlist files: name -> library IDs
     std::vector<std::string> track_titles;
     bool play_all = false;
+    OrderMode order_mode;
     // Session statistics
     struct SessionStats {
         size_t tracks_processed = 0;
@@ -50,7 +65,10 @@ private:
         size_t deck_loads_a = 0;
         size_t deck_loads_b = 0;
         size_t transitions = 0;
+        size_t rendered_samples = 0;    // Crossfade samples the render thread mixed
         size_t errors = 0;
+        bool has_cache_prediction = false;
+        size_t predicted_cache_hits = 0;
     } stats;
 
 public:
@@ -60,13 +78,18 @@ public:
      * @brief Construct a new DJSession orchestrator
      * @param name Session identifier
      */
-    DJSession(const std::string& name = "DJ Session", bool play_all = false);
+    DJSession(const std::string& name = "DJ Session", bool play_all = false,
+              OrderMode order_mode = OrderMode::AS_CONFIGURED);
 
     /**
      * @brief Destructor
      */
     ~DJSession();
 
+    // Tuning hooks capture this session
+    DJSession(const DJSession&) = delete;
+    DJSession& operator=(const DJSession&) = delete;
+
     // ========== ORCHESTRATION METHODS ==========
 
 
@@ -91,11 +114,53 @@ public:
      */
     bool load_track_to_mixer_deck(const std::string& track_title);
 
+    /**
+     * Contract: Edit the track library while the session runs
+     * - Input: track data and/or a 1-based library ID
+     * - Output: the new track's ID (add), or true on success (remove, update)
+     * - The loaded playlist follows the change, and a controller-cached copy of a
+     *   removed or updated track is dropped so the next load sees the new data
+     */
+    int add_library_track(const SessionConfig::TrackInfo& track_info);
+    bool remove_library_track(int track_id);
+    bool update_library_track(int track_id, const SessionConfig::TrackInfo& track_info);
+
+    /**
+     * Contract: Re-read bin/dj_config.txt and apply only what changed
+     * - Tracks are matched to the library by content, then by title (an update);
+     *   the rest are added or removed through add/remove/update_library_track,
+     *   so unchanged tracks keep their IDs, track objects and cached copies
+     * - Playlists, cache size, BPM tolerance, auto-sync, crossfade and tuning knobs take effect
+     *   at once; the playlists directory is only re-read if playlists_directory changed
+     *   or a track one of its playlists names was removed or renamed
+     * - Output: false if the file cannot be parsed (the session is left as it was)
+     */
+    bool reload_configuration();
+
+    /**
+     * Contract: Compute and print a BPM-optimized order for the loaded playlist
+     * - Output: proposed order (indices into the current play order); the playlist is not modified
+     */
+    std::vector<size_t> preview_playlist_order();
+
+    /**
+     * Contract: Compute a cache-friendly order for the loaded playlist and print its predicted hit rate
+     * - Output: proposed order (indices into the current play order); the playlist is not modified
+     */
+    std::vector<size_t> preview_cache_order();
+
     /**
      * Contract: Orchestrate the DJ performance simulation
      */
     void simulate_dj_performance();
 
+    /**
+     * Contract: Compile bin/dj_config.txt into the binary snapshot bin/dj_config.djlib
+     * - Output: true if the snapshot was written and verified
+     * - Later sessions map the snapshot instead of parsing the text config while it is up to date
+     */
+    static bool compile_library_snapshot();
+
 
     // ========== STATUS & DISPLAY METHODS ==========
 
@@ -107,11 +172,26 @@ private:
     // ========== PROVIDED HELPER METHODS (Menu and Config) ==========
     
     /**
-     * @brief Load configuration from bin/dj_config.txt
+     * @brief Load configuration and the track library from bin/dj_config.djlib if it is
+     * up to date, else by streaming bin/dj_config.txt into the library
      * @return true if configuration loaded successfully
      */
     bool load_configuration();
     
+    /**
+     * @brief Parse the .playlist files of a directory into directory_playlists,
+     * adding tracks the library lacks
+     * @param configured playlists_directory from the config; empty means ./playlists,
+     * which may be missing without a warning
+     */
+    void load_playlist_directory(const std::string& configured);
+    
+    /**
+     * @brief Add directory_playlists to a config's playlists; a config playlist of the
+     * same name wins
+     */
+    void merge_directory_playlists(std::map<std::string, std::vector<int>>& playlists) const;
+    
     /**
      * @brief Display available playlists from config and prompt user to select one
      * @return Selected playlist name, or empty string if cancelled
@@ -121,128 +201,33 @@ private:
      * @brief Print final session summary with statistics
      */
     void print_session_summary() const;
-=======
-#pragma once
-
-#include "DJLibraryService.h"
-#include "DJControllerService.h"
-#include "MixingEngineService.h"
-#include "SessionFileParser.h"
-#include "ConfigurationManager.h"
-#include <string>
-#include <vector>
-
-/**
- * @brief DJ Controller Memory Statistics
- * Phase 4: Track how memory is used in the DJ controller simulation
- */
-struct ControllerStats {
-    size_t tracks_in_controller;      // Tracks currently loaded in controller memory
-    size_t total_tracks_processed;    // Total tracks that passed through controller
-    size_t memory_slots_used;         // How many memory slots are occupied
-    size_t tracks_evicted;            // How many tracks were removed due to memory limits
-    
-    ControllerStats() : tracks_in_controller(0), total_tracks_processed(0), 
-                       memory_slots_used(0), tracks_evicted(0) {}
-};
-
-/**
- * @brief Professional DJ Session System Orchestrator
- */
-class DJSession {
-private:
-    // Session identification
-    std::string session_name;
-
-    // Service-oriented architecture: delegate to services
-    DJLibraryService library_service;
-    DJControllerService controller_service;
-    MixingEngineService mixing_service;
-    
-    // Configuration and session state
-    ConfigurationManager config_manager;
-    SessionConfig session_config;
-    std::vector<std::string> track_titles;
-    bool play_all;
-    // Session statistics
-    struct SessionStats {
-        size_t tracks_processed = 0;
-        size_t cache_hits = 0;
-        size_t cache_misses = 0;
-        size_t cache_evictions = 0;
-        size_t deck_loads_a = 0;
-        size_t deck_loads_b = 0;
-        size_t transitions = 0;
-        size_t errors = 0;
-    } stats;
-
-public:
-    // ========== CONSTRUCTORS & DESTRUCTOR ==========
-
-    /**
-     * @brief Construct a new DJSession orchestrator
-     * @param name Session identifier
-     */
-    DJSession(const std::string& name = "DJ Session", bool play_all = false);
-
-    /**
-     * @brief Destructor
-     */
-    ~DJSession();
-
-    // ========== ORCHESTRATION METHODS ==========
-
-
-    /**
-     * Contract: Load playlist into the session library
-     * - Input: playlist name (key from session config)
-     * - Output: true on success; false if playlist not found or empty
-     */
-    bool load_playlist(const std::string& playlist_name);
-
-    /**
-     * Contract: Demand-load a track into the controller cache.
-     * - Input: The name of the track to load.
-     * - Output: An integer indicating a HIT (1) or MISS (0).
-     */
-    int load_track_to_controller(const std::string& track_name);
-
-    /**
-     * Contract: Load a cached track into a mixer deck (instant-transition model)
-     * - Input: track title (or key).
-     * - Output: true on success; false if not found in cache or clone fails
-     */
-    bool load_track_to_mixer_deck(const std::string& track_title);
-
-    /**
-     * Contract: Orchestrate the DJ performance simulation
-     */
-    void simulate_dj_performance();
-
-
-    // ========== STATUS & DISPLAY METHODS ==========
-
-    const std::string& get_session_name() const { return session_name; }
-
-    // TODO: Add more status and display methods as needed, delegating to services
-
-private:
-    // ========== PROVIDED HELPER METHODS (Menu and Config) ==========
-    
-    /**
-     * @brief Load configuration from bin/dj_config.txt
-     * @return true if configuration loaded successfully
-     */
-    bool load_configuration();
-    
-    /**
-     * @brief Display available playlists from config and prompt user to select one
-     * @return Selected playlist name, or empty string if cancelled
-     */
-    std::string display_playlist_menu_from_config();
-    /**
-     * @brief Print final session summary with statistics
-     */
-    void print_session_summary() const;
->>>>>>> origin/main
+
+    /**
+     * @brief Apply order_mode to the playlist that was just loaded
+     */
+    void apply_order_mode();
+
+    /**
+     * @brief Print every setting in effect, in config syntax (tuning knobs with
+     * their defaults included), so a benchmark run can be reproduced from the log
+     */
+    void print_effective_settings() const;
+
+    /**
+     * @brief Print the library tracks closest to the active deck's track
+     * (tuning.suggest_next of them; nothing when it is 0)
+     */
+    void print_next_suggestions() const;
+
+    /**
+     * @brief Print quality and beat-grid totals of the playlist that was just loaded
+     * (when tuning.playlist_analysis is set), computed by TrackStore's batch kernels
+     */
+    void print_playlist_analysis();
+
+    /**
+     * @brief Reload the configuration if the watcher saw the file change
+     * Called between playlists, where no playlist is being iterated
+     */
+    void poll_config_changes();
 };
\ No newline at end of file
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <climits>
+#include <cstddef>
+#include <string>
+
+/**
+ * @brief Why an integer could not be parsed (mirrors std::errc for std::from_chars)
+ */
+enum class IntegerParseError {
+    NONE,
+    INVALID_ARGUMENT,       // No digits where the number should start
+    RESULT_OUT_OF_RANGE     // The digits do not fit in an int
+};
+
+struct IntegerParseResult {
+    const char* ptr;            // First character not consumed
+    IntegerParseError error;
+};
+
+/**
+ * @brief Parse a decimal int from [first, last) like C++17 std::from_chars
+ *
+ * Accepts an optional '-' and then digits; stops at the first non-digit.
+ * Never throws, allocates or consults the locale. On error value is left
+ * unchanged; ptr is first for INVALID_ARGUMENT and just past the digits for
+ * RESULT_OUT_OF_RANGE.
+ */
+inline IntegerParseResult parse_integer(const char* first, const char* last, int& value) {
+    const char* p = first;
+    bool negative = (p != last && *p == '-');
+    if (negative) {
+        ++p;
+    }
+    const unsigned long long limit = negative ? 0ULL - static_cast<unsigned long long>(INT_MIN)
+                                              : static_cast<unsigned long long>(INT_MAX);
+    const char* digits = p;
+    unsigned long long magnitude = 0;
+    for (; p != last && static_cast<unsigned>(*p - '0') < 10u; ++p) {
+        // Keep consuming digits once out of range, but stop accumulating
+        if (magnitude <= limit) {
+            magnitude = magnitude * 10 + static_cast<unsigned>(*p - '0');
+        }
+    }
+    if (p == digits) {
+        IntegerParseResult result = { first, IntegerParseError::INVALID_ARGUMENT };
+        return result;
+    }
+    if (magnitude > limit) {
+        IntegerParseResult result = { p, IntegerParseError::RESULT_OUT_OF_RANGE };
+        return result;
+    }
+    value = negative ? static_cast<int>(-static_cast<long long>(magnitude)) : static_cast<int>(magnitude);
+    IntegerParseResult result = { p, IntegerParseError::NONE };
+    return result;
+}
+
+/**
+ * @brief Parse the int at the start of [first, last) with std::stoi's rules
+ *
+ * Skips leading whitespace, accepts '+' or '-', and ignores anything after the
+ * digits, so it accepts exactly what std::stoi accepts without its exceptions.
+ */
+inline IntegerParseError parse_leading_integer(const char* first, const char* last, int& value) {
+    while (first != last && (*first == ' ' || (*first >= '\t' && *first <= '\r'))) {
+        ++first;
+    }
+    if (first != last && *first == '+') {
+        ++first;
+        if (first != last && *first == '-') {
+            return IntegerParseError::INVALID_ARGUMENT;
+        }
+    }
+    return parse_integer(first, last, value).error;
+}
+
+/**
+ * @brief Parse a whole string as a non-negative count (command-line name=value options)
+ * @return false, leaving value unchanged, for a sign, trailing characters or an out-of-range number
+ */
+inline bool parse_size(const std::string& text, size_t& value) {
+    int parsed = 0;
+    IntegerParseResult result = parse_integer(text.data(), text.data() + text.size(), parsed);
+    if (result.error != IntegerParseError::NONE || result.ptr != text.data() + text.size() || parsed < 0) {
+        return false;
+    }
+    value = static_cast<size_t>(parsed);
+    return true;
+}
+
+/**
+ * @brief Short description of an error, for warnings
+ */
+inline const char* integer_parse_error_text(IntegerParseError error) {
+    switch (error) {
+        case IntegerParseError::NONE:
+            return "ok";
+        case IntegerParseError::INVALID_ARGUMENT:
+            return "not a number";
+        case IntegerParseError::RESULT_OUT_OF_RANGE:
+            return "out of range";
+    }
+    return "unknown error";
+}
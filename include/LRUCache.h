@@ -65,6 +65,13 @@ public:
      * @return true if a track was evicted
      */
     bool evictLRU();
+
+    /**
+     * @brief Drop a specific track, e.g. after the library changed it
+     * @param track_id Track identifier
+     * @return true if the track was cached
+     */
+    bool remove(const std::string& track_id);
     
     /**
      * @brief Get current cache usage
@@ -93,7 +100,7 @@ public:
     void displayStatus() const;
     /**
      * @brief Update LRU Cache capacity
-     * This method should be used only once.
+     * Shrinking evicts the least recently used tracks that no longer fit.
      */
     void set_capacity(size_t capacity);
 private:
@@ -0,0 +1,176 @@
+#pragma once
+
+#include "SessionFileParser.h"
+#include "TrackMetadataTable.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Compiled, memory-mapped form of a session config (library + settings)
+ *
+ * write() compiles a parsed config into a binary file; open() maps it
+ * read-only and checks the header and section bounds without touching the
+ * per-track data, so opening costs the same for 10 tracks or 10 million.
+ * Per-row references (strings, artists, waveforms) are bounds-checked when
+ * they are read; verify() checks the whole-file checksum on demand.
+ *
+ * File layout (host byte order, every section 8-byte aligned):
+ *   Header
+ *   Columns: bpm, duration, rate, depth (int32), format (uint8), quality (double)
+ *   Title refs, artist index (n + 1 offsets) and artist refs
+ *   Playlist refs and playlist track IDs
+ *   Tuning refs (tuning.<name>=<value> entries)
+ *   String pool
+ *   Waveform samples and waveform index (n + 1 sample offsets)
+ */
+class LibrarySnapshot {
+public:
+    struct StringRef {
+        uint64_t offset;    // Into the string pool
+        uint64_t length;
+    };
+
+    struct PlaylistRef {
+        StringRef name;
+        uint64_t first_id;  // Into the playlist ID section
+        uint64_t id_count;
+    };
+
+    struct TuningRef {
+        StringRef name;     // Without the tuning. prefix
+        StringRef value;
+    };
+
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t header_size;
+        uint64_t file_size;
+        uint64_t payload_checksum;      // FNV-1a over everything after the header
+
+        // Source text config, to detect a stale snapshot
+        uint64_t source_size;
+        uint64_t source_hash;           // ConfigCache::hash_contents of the text
+
+        // Settings
+        StringRef app_name;
+        StringRef version_string;
+        StringRef playlists_directory;
+        int32_t controller_cache_size;
+        int32_t cache_order_max_bpm_jump;
+        int32_t default_crossfade_time;
+        int32_t bpm_tolerance;
+        int32_t auto_sync;
+        int32_t crossfade_curve;        // CrossfadeCurve; 0 (equal power) in files that predate it
+
+        // Counts
+        uint64_t track_count;
+        uint64_t config_track_count;    // Leading rows from the config; the rest come from playlist files
+        uint64_t artist_ref_count;
+        uint64_t playlist_count;
+        uint64_t playlist_id_count;
+        uint64_t tuning_count;
+        uint64_t string_pool_size;
+        uint64_t waveform_sample_count;
+
+        // Section offsets from the start of the file
+        uint64_t bpm_offset;
+        uint64_t duration_offset;
+        uint64_t rate_offset;
+        uint64_t depth_offset;
+        uint64_t format_offset;
+        uint64_t quality_offset;
+        uint64_t title_offset;
+        uint64_t artist_index_offset;
+        uint64_t artist_ref_offset;
+        uint64_t playlist_offset;
+        uint64_t playlist_id_offset;
+        uint64_t tuning_offset;
+        uint64_t string_pool_offset;
+        uint64_t waveform_offset;
+        uint64_t waveform_index_offset;
+    };
+
+    LibrarySnapshot();
+    ~LibrarySnapshot();
+    LibrarySnapshot(const LibrarySnapshot&) = delete;
+    LibrarySnapshot& operator=(const LibrarySnapshot&) = delete;
+
+    /**
+     * @brief Compile a parsed config into a snapshot file
+     * @param snapshot_path Output file (replaced if it exists)
+     * @param config Parsed settings and playlists
+     * @param table Library metadata; every track is created once, one at a time, to capture its waveform
+     * @param config_track_count Leading rows of table that are the config's tracks
+     * @param source_path Text config the snapshot was compiled from (size and content hash are recorded)
+     * @return true on success
+     */
+    static bool write(const std::string& snapshot_path, const SessionConfig& config,
+                      const TrackMetadataTable& table, size_t config_track_count,
+                      const std::string& source_path);
+
+    /**
+     * @brief Map a snapshot file and validate its header
+     * @return false if the file is missing, truncated or not a snapshot (a warning
+     * is printed unless the file simply does not exist)
+     */
+    bool open(const std::string& snapshot_path);
+
+    void close();
+    bool is_open() const { return data != nullptr; }
+
+    /**
+     * @brief Recompute the payload checksum (reads the whole file)
+     */
+    bool verify() const;
+
+    /**
+     * @brief Whether the source text config exists and differs from the one compiled
+     * Compares the size, then (reading the file, but not parsing it) the content hash,
+     * so an edit that keeps the size and modification time is still noticed
+     */
+    bool is_stale_for(const std::string& source_path) const;
+
+    /**
+     * @brief Copy the settings, tuning entries and playlists into a config (library_tracks is left untouched)
+     */
+    void read_settings(SessionConfig& config) const;
+
+    // ========== TRACK DATA (row = library ID - 1) ==========
+    size_t track_count() const { return static_cast<size_t>(header->track_count); }
+    size_t config_track_count() const { return static_cast<size_t>(header->config_track_count); }
+    const int32_t* bpms() const { return section<int32_t>(header->bpm_offset); }
+    const int32_t* durations() const { return section<int32_t>(header->duration_offset); }
+    const int32_t* rates() const { return section<int32_t>(header->rate_offset); }
+    const int32_t* depths() const { return section<int32_t>(header->depth_offset); }
+    const uint8_t* formats() const { return section<uint8_t>(header->format_offset); }
+    const double* quality_scores() const { return section<double>(header->quality_offset); }
+
+    std::string title(size_t row) const;
+    std::vector<std::string> artists(size_t row) const;
+
+    /**
+     * @brief Stored waveform of a row; nullptr (and size 0) if the index is corrupt
+     */
+    const double* waveform(size_t row, size_t& sample_count) const;
+
+private:
+    static const uint32_t FORMAT_VERSION = 4;
+
+    const char* data;
+    size_t size;
+    const Header* header;
+
+    template<typename T>
+    const T* section(uint64_t offset) const { return reinterpret_cast<const T*>(data + offset); }
+
+    /**
+     * @brief Whether count elements of elem_size bytes fit at offset, 8-byte aligned
+     */
+    bool section_fits(uint64_t offset, uint64_t count, size_t elem_size) const;
+
+    bool validate_header() const;
+    std::string string_at(const StringRef& ref) const;
+};
@@ -2,6 +2,7 @@
 #define MP3TRACK_H
 
 #include "AudioTrack.h"
+#include <algorithm>
 
 /**
  * MP3Track - Represents an MP3 audio file with lossy compression
@@ -14,7 +15,7 @@
  * - get_quality_score(): derived from bitrate (e.g., normalized by 320kbps).
  * - clone(): return a deep polymorphic copy used by the mixer; source remains unchanged.
  */
-class MP3Track : public AudioTrack {
+class MP3Track final : public AudioTrack {
 private:
     int bitrate;        // Compression level: 128, 192, 320 kbps (higher = better quality)
     bool has_id3_tags;  // Whether file contains ID3 metadata (artist, album, etc.)
@@ -26,6 +27,13 @@ public:
     MP3Track(const std::string& title, const std::vector<std::string>& artists, 
              int duration, int bpm, int bitrate, bool has_tags = true);
 
+    /**
+     * Constructor with a stored waveform (see AudioTrack)
+     */
+    MP3Track(const std::string& title, const std::vector<std::string>& artists, 
+             int duration, int bpm, int bitrate, bool has_tags,
+             const double* waveform, size_t waveform_samples);
+
     // ========== TODO: IMPLEMENT VIRTUAL FUNCTIONS ==========
 
     /**
@@ -46,6 +54,21 @@ public:
      */
     double get_quality_score() const override;
 
+    /**
+     * @brief Quality score for MP3 metadata, without needing a track object
+     * Defined inline so column scans (TrackMetadataTable) and batch kernels (TrackStore) can inline it
+     */
+    static double compute_quality_score(int bitrate, bool has_tags) {
+        double final_score = ((double)bitrate / 320.0) * 100.0;
+        if (has_tags) {
+            final_score += 5.0;
+        }
+        if (bitrate < 128) {
+            final_score -= 10.0;
+        }
+        return std::min(100.0, std::max(0.0, final_score));
+    }
+
     /**
      * TODO: Implement clone function
      * HINT: Return a unique_ptr to a new MP3Track with same properties
@@ -55,6 +78,7 @@ public:
     // Getters
     int get_bitrate() const { return bitrate; }
     bool has_tags() const { return has_id3_tags; }
+    double get_precision_factor() const override { return (double)bitrate / 320.0; }
 };
 
 #endif // MP3TRACK_H
\ No newline at end of file
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+/**
+ * @brief Read-only view of a whole file's contents
+ *
+ * Maps the file into memory when it can. Files that cannot be mapped (empty
+ * files, pipes, special files) are read into an owned buffer instead, so
+ * callers always get one contiguous block.
+ */
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * @brief Open a file (closing any previous one)
+     * @return false if the file cannot be opened or read
+     */
+    bool open(const std::string& path);
+
+    void close();
+
+    const char* data() const { return mapped ? mapped : buffer.data(); }
+    size_t size() const { return mapped ? mapped_size : buffer.size(); }
+
+    /**
+     * @brief Hint that the contents will be read front to back once
+     */
+    void advise_sequential() const;
+
+private:
+    const char* mapped;     // nullptr when the contents are in buffer
+    size_t mapped_size;
+    std::string buffer;
+};
+
+/**
+ * @brief Read a whole regular file, named relative to an open directory, into buffer
+ *
+ * Meant for many small files, where one read() of the fstat size is cheaper than
+ * setting up a mapping. The buffer keeps its capacity between calls, so reading
+ * file after file into the same buffer allocates only for the largest one.
+ * @return false if the file cannot be opened or read or is not a regular file
+ */
+bool read_file_at(int directory_fd, const char* name, std::string& buffer);
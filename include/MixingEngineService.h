@@ -2,22 +2,102 @@
 #define MIXINGENGINESERVICE_H
 
 #include "AudioTrack.h"
+#include "CrossfadeKernels.h"
+#include "SpscRing.h"
+#include <atomic>
 #include <string>
+#include <thread>
+#include <vector>
 
 // Service responsible for deck operations and track analysis
 // Phase 4 binding:
 // - Enforces instant transitions and deck alternation policy.
 // - After loading to a deck: call track.load(); then analyze_beatgrid(); then switch active deck.
 // - The previously active deck becomes finished and is unloaded immediately.
+// Threading: deck decisions and logging stay on the caller's (control) thread,
+// whose decks[] is its view of the mixer. Each change is posted as a command to
+// a render thread that owns the decks being played: it installs the new deck,
+// renders the crossfade from the outgoing one and hands replaced decks back
+// through a second ring; the control thread deletes them. The render thread
+// never locks, waits on the control thread, allocates or logs.
 class MixingEngineService {
 private:
+    /**
+     * @brief A change posted from the control thread to the render thread
+     */
+    struct DeckCommand {
+        enum Type {
+            LOAD_DECK,          // Install track on deck; the other deck fades out into it
+            SET_CROSSFADE,      // value = seconds
+            STOP                // Hand back every deck and exit
+        };
+        Type type;
+        int deck;
+        AudioTrack* track;
+        int value;
+        CrossfadeCurve curve;
+    };
+
+    static const size_t COMMAND_CAPACITY = 64;
+    // A command retires at most two decks, so this holds what every queued command can retire
+    static const size_t RETIRED_CAPACITY = 4 * COMMAND_CAPACITY;
+    // Longest rendered transition; longer fades are cut to it
+    static const size_t RENDER_BUFFER_SAMPLES = 1 << 16;
+
+    // Control thread
     AudioTrack* decks[2];
     size_t active_deck;
     bool auto_sync;
     int bpm_tolerance;
+
+    SpscRing<DeckCommand, COMMAND_CAPACITY> commands;               // Control -> render
+    SpscRing<AudioTrack*, RETIRED_CAPACITY> retired;                // Render -> control, to delete
+    std::atomic<size_t> rendered_samples;                           // All transitions so far
+    std::atomic<size_t> applied_commands;                           // Written by the render thread
+    size_t posted_commands;
+    size_t reported_samples;                                        // rendered_samples at the last take
+
+    // Render thread only (after construction)
+    AudioTrack* render_decks[2];
+    int crossfade_seconds;
+    CrossfadeCurve crossfade_curve;
+    std::vector<double> render_buffer;     // Last rendered transition; allocated once, up front
+
+    std::thread render_thread;
+
+    /**
+     * @brief Control thread: hand a command to the render thread, waiting only
+     * while the ring is full (retired decks are deleted meanwhile)
+     */
+    void post(const DeckCommand& command);
+
+    /**
+     * @brief Control thread: delete the decks the render thread has handed back
+     */
+    void collect_retired();
+
+    /**
+     * @brief Render thread body: apply commands in order, once per period
+     */
+    void render_loop();
+
+    /**
+     * @brief Render thread: apply one command
+     * @return false for STOP
+     */
+    bool apply_command(const DeckCommand& command);
+
+    /**
+     * @brief Render thread: hand a deck back to the control thread for deletion
+     * @note Never waits: render_loop only takes a command while the retired ring has
+     * room for the two decks it can retire, so the push always succeeds
+     */
+    void retire(AudioTrack* deck);
 public:
     MixingEngineService();
     ~MixingEngineService();
+    MixingEngineService(const MixingEngineService&) = delete;
+    MixingEngineService& operator=(const MixingEngineService&) = delete;
 
     /** Contract: Load a track to the next deck per instant-transition policy
      * - @param track: reference to a cached track to be cloned for the mixer
@@ -30,6 +110,11 @@ public:
     // Display deck status
     void displayDeckStatus() const;
 
+    /**
+     * @brief Track on the active deck (the mixer's own clone), or nullptr if it is empty
+     */
+    const AudioTrack* get_active_track() const { return decks[active_deck]; }
+
     /**
      * Contract: Determine if decks A and the given track can be mixed
      * @return true if mixable by BPM/key criteria; false otherwise
@@ -60,6 +145,45 @@ public:
         bpm_tolerance = tolerance;
     }
 
+    /**
+     * @brief Set how later transitions are rendered (seconds <= 0 renders nothing)
+     */
+    void set_crossfade(int seconds, CrossfadeCurve curve);
+
+    /**
+     * @brief Wait until the render thread has applied every command posted so far
+     * @return Crossfade samples rendered since the previous call
+     */
+    size_t take_rendered_samples();
+
+    /**
+     * @brief Render a crossfade from the end of one track into the start of another
+     * @param seconds Fade length; converted to samples at the outgoing track's
+     * waveform rate (samples / duration) and capped at either waveform's length
+     * @param output Resized to the fade and overwritten
+     * @return Samples written
+     * @note The incoming waveform is taken to share the outgoing one's sample rate;
+     * nothing is resampled
+     */
+    static size_t render_crossfade(const AudioTrack& outgoing, const AudioTrack& incoming, int seconds,
+                                   CrossfadeCurve curve, std::vector<double>& output);
+
+    /**
+     * @brief render_crossfade into a fixed buffer, cutting the fade to capacity samples
+     * (allocates nothing, for the render thread)
+     */
+    static size_t render_crossfade(const AudioTrack& outgoing, const AudioTrack& incoming, int seconds,
+                                   CrossfadeCurve curve, double* output, size_t capacity);
+
+    /**
+     * @brief Time the crossfade kernels against a per-sample libm loop and print
+     * samples per second per core for each curve
+     * @param sample_count Length of the fade rendered per run (in 4096-sample blocks)
+     * @param thread_count Threads rendering at once, each its own fade (0 = hardware concurrency)
+     * @return false if the kernels disagree with the reference loop
+     */
+    static bool run_crossfade_benchmark(size_t sample_count, unsigned thread_count);
+
 };
 
 #endif // MIXINGENGINESERVICE_H
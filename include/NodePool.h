@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Fixed-size slab allocator with a free list (Single Responsibility)
+ *
+ * Hands out equally sized slots carved from large slabs. Freed slots go on
+ * a free list and are reused before the slab's bump pointer advances, so
+ * building and tearing down playlists costs a pointer bump / push instead
+ * of a heap call per node. Slabs are only returned to the heap when the
+ * pool itself is destroyed.
+ *
+ * Used through PlaylistNode's class-specific operator new/delete; one pool
+ * is shared by every Playlist in the process. Not thread-safe: playlists
+ * are built and destroyed on the session thread.
+ */
+class NodePool {
+public:
+    /**
+     * @brief Allocation counters
+     */
+    struct Stats {
+        size_t slot_allocations;    // allocate() calls
+        size_t slot_frees;          // deallocate() calls
+        size_t slab_allocations;    // Heap allocations made by the pool
+        size_t slots_in_use;
+        size_t peak_slots_in_use;
+
+        Stats() : slot_allocations(0), slot_frees(0), slab_allocations(0),
+                  slots_in_use(0), peak_slots_in_use(0) {}
+    };
+
+    /**
+     * @param slot_size Size of each object (rounded up for alignment)
+     * @param slots_per_slab Number of slots carved from each heap allocation
+     */
+    explicit NodePool(size_t slot_size, size_t slots_per_slab = 256);
+    ~NodePool();
+
+    NodePool(const NodePool&) = delete;
+    NodePool& operator=(const NodePool&) = delete;
+
+    /**
+     * @brief Get an uninitialized slot
+     */
+    void* allocate();
+
+    /**
+     * @brief Return a slot obtained from allocate()
+     */
+    void deallocate(void* slot);
+
+    const Stats& get_stats() const { return stats; }
+
+    /**
+     * @brief Print allocation counters
+     * @param name Label for the pooled type
+     */
+    void displayStats(const std::string& name) const;
+
+private:
+    struct FreeSlot {
+        FreeSlot* next;
+    };
+
+    size_t slot_size;
+    size_t slots_per_slab;
+    std::vector<char*> slabs;
+    FreeSlot* free_list;
+    char* bump;        // Next unused slot in the newest slab
+    char* bump_end;
+    Stats stats;
+};
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Resolve a requested worker count
+ * @param requested Number of threads; 0 means "one per hardware thread"
+ * @return At least 1
+ */
+inline unsigned resolve_thread_count(unsigned requested) {
+    if (requested == 0) {
+        requested = std::thread::hardware_concurrency();
+    }
+    return std::max(1u, requested);
+}
+
+/**
+ * @brief Run fn(begin, end) over [0, count) split into contiguous chunks
+ * @param count Number of work items
+ * @param thread_count Worker threads (0 = hardware concurrency); never more than count
+ * @param fn Callable taking (size_t begin, size_t end); chunks are disjoint
+ *
+ * The calling thread processes the first chunk itself. If any chunk throws,
+ * the first exception is rethrown on the calling thread after every worker
+ * has finished, so callers can clean up what the other chunks produced.
+ */
+template<typename Fn>
+void parallel_for(size_t count, unsigned thread_count, Fn fn) {
+    if (count == 0) {
+        return;
+    }
+    size_t workers = std::min(static_cast<size_t>(resolve_thread_count(thread_count)), count);
+    size_t chunk = (count + workers - 1) / workers;
+
+    std::vector<std::exception_ptr> errors(workers);
+    auto run_chunk = [&](size_t w) {
+        size_t begin = w * chunk;
+        size_t end = std::min(count, begin + chunk);
+        try {
+            if (begin < end) {
+                fn(begin, end);
+            }
+        } catch (...) {
+            errors[w] = std::current_exception();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t w = 1; w < workers; ++w) {
+        threads.push_back(std::thread(run_chunk, w));
+    }
+    run_chunk(0);
+    for (std::thread& t : threads) {
+        t.join();
+    }
+
+    for (const std::exception_ptr& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
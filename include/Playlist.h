@@ -2,27 +2,49 @@
 #define PLAYLIST_H
 
 #include "AudioTrack.h"
+#include "NodePool.h"
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 /**
- * ⚠️  WARNING: THIS CLASS HAS INTENTIONAL MEMORY LEAKS! ⚠️
- * 
- * This is Phase 1 of the assignment - students must identify and fix all memory leaks.
- * @todo Implement proper memory management to prevent leaks.
- * @note In phase 4, the library service should provide canonical ownership semantics
- * for tracks referenced by playlists. Fixes in earlier phases should ensure
- * clear ownership and safe iteration without leaks.
+ * Nodes are shared between playlist versions (copies of a Playlist point at the
+ * same chain). ref_count counts the incoming links: a Playlist head or the
+ * next pointer of another node. A node is freed when the last link to it goes away.
+ *
+ * Tracks are borrowed: the owner (DJLibraryService::library in phase 4) must
+ * outlive every playlist that references them. The same track may appear in
+ * several nodes.
+ *
+ * Nodes are allocated from a NodePool shared by all playlists (see
+ * Playlist::node_pool()) rather than one heap call per node.
  */
-
 struct PlaylistNode {
     AudioTrack* track; 
     PlaylistNode* next;
+    size_t ref_count;
 
-    PlaylistNode(AudioTrack* t) : track(t), next(nullptr) {}
+    PlaylistNode(AudioTrack* t) : track(t), next(nullptr), ref_count(1) {}
     ~PlaylistNode() = default;
+
+    PlaylistNode(const PlaylistNode&) = delete;
+    PlaylistNode& operator=(const PlaylistNode&) = delete;
+
+    static void* operator new(size_t size);
+    static void operator delete(void* node, size_t size) noexcept;
 };
 
+/**
+ * @brief Singly linked playlist of borrowed tracks
+ *
+ * A Playlist owns references to its nodes, not the nodes themselves: nodes are
+ * reference counted (see PlaylistNode) and shared between copies, so copying a
+ * playlist is O(1) and a node is freed by whichever playlist drops its last link.
+ * Moves transfer the head without touching the counts.
+ *
+ * Tracks are never owned: in phase 4 DJLibraryService::library owns them and
+ * must outlive every playlist that references them.
+ */
 class Playlist {
 private:
     PlaylistNode* head;
@@ -40,13 +62,22 @@ public:
      */
     ~Playlist();
 
-    // Rule of 3 Declarations
-    Playlist(const Playlist& other);            // Copy Constructor
-    Playlist& operator=(const Playlist& other); // Copy Assignment Operator
+    // Rule of 5 Declarations
+    // Copies share the node chain with the source (O(1), no allocations);
+    // remove_track copies only the shared prefix it has to modify.
+    Playlist(const Playlist& other);                // Copy Constructor
+    Playlist& operator=(const Playlist& other);     // Copy Assignment Operator
+    Playlist(Playlist&& other) noexcept;            // Move Constructor
+    Playlist& operator=(Playlist&& other) noexcept; // Move Assignment Operator
+
+    /**
+     * Swap contents with another playlist in O(1)
+     */
+    void swap(Playlist& other) noexcept;
 
     /**
      * Add a track to the playlist
-     * @param track Pointer to AudioTrack to add
+     * @param track Pointer to AudioTrack to add (borrowed, not owned)
      */
     void add_track(AudioTrack* track);
 
@@ -90,6 +121,41 @@ public:
      */
     std::vector<AudioTrack*> getTracks() const;
 
+    /**
+     * Rearrange the tracks into a new play order
+     * @param order Position k holds the index (into getTracks()) of the k-th track
+     * @return false if order is not a permutation of the current tracks
+     */
+    bool reorder(const std::vector<size_t>& order);
+
+    /**
+     * Point entries at different track objects (e.g. after the owning library was deep-copied)
+     * @param mapping Old track -> new track; tracks missing from the map are kept
+     */
+    void remap_tracks(const std::unordered_map<const AudioTrack*, AudioTrack*>& mapping);
+
+    /**
+     * Remove every entry that borrows a given track object (e.g. before its owner deletes it)
+     * @return Number of entries removed
+     */
+    size_t remove_track_object(const AudioTrack* track);
+
+    /**
+     * Pool every PlaylistNode is allocated from
+     */
+    static NodePool& node_pool();
+
+private:
+    /**
+     * Take an additional link to a node chain
+     */
+    static void retain(PlaylistNode* node);
+
+    /**
+     * Drop one link to a node chain, freeing every node that is no longer referenced
+     */
+    static void release(PlaylistNode* node);
+
 };
 
 
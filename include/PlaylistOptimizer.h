@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * @brief BPM-aware playlist ordering (Single Responsibility)
+ *
+ * Reorders a set of tracks so that consecutive tracks are as close in BPM as
+ * possible, which keeps MixingEngineService::sync_bpm from firing.
+ * The optimizer works on plain BPM values; callers map the resulting order
+ * back onto their own containers (see Playlist::reorder).
+ *
+ * Algorithm:
+ * - Greedy nearest-neighbour construction from several start tracks
+ * - 2-opt (segment reversal) and Or-opt (segment move) local search on the
+ *   static edge cost |bpm_a - bpm_b| + sync_penalty if the jump exceeds tolerance
+ *   (moves are limited to a window of nearby positions to keep passes linear)
+ * - Start tracks are spread over worker threads; the best candidate under the
+ *   mixer's actual sync rules (see evaluate()) wins
+ *
+ * cache_order() is a second, independent ordering that targets the
+ * controller's LRUCache instead of BPM (see below).
+ */
+class PlaylistOptimizer {
+public:
+    /**
+     * @brief Cost of playing tracks in a given order
+     */
+    struct OrderStats {
+        long long total_bpm_jump;   // Sum of BPM differences between consecutive tracks
+        size_t sync_events;         // Transitions where the mixer has to sync BPM
+
+        OrderStats() : total_bpm_jump(0), sync_events(0) {}
+    };
+
+    /**
+     * @param bpm_tolerance Same tolerance the MixingEngineService uses
+     * @param auto_sync Whether a sync rewrites the incoming track's BPM (as the mixer does)
+     * @param thread_count Worker threads for the search; 0 picks hardware concurrency
+     */
+    explicit PlaylistOptimizer(int bpm_tolerance, bool auto_sync = true, unsigned thread_count = 0);
+
+    /**
+     * @brief Find a low-cost play order
+     * @param bpms BPM of each track, in current play order
+     * @return Permutation: position k holds the index (into bpms) of the k-th track to play
+     */
+    std::vector<size_t> optimize(const std::vector<int>& bpms) const;
+
+    /**
+     * @brief Replay the mixer's sync rules over an order
+     * @param bpms BPM of each track
+     * @param order Play order (indices into bpms)
+     * @return Total BPM jump and number of sync events
+     */
+    OrderStats evaluate(const std::vector<int>& bpms, const std::vector<size_t>& order) const;
+
+    /**
+     * @brief Reorder so repeated tracks are replayed while still in the controller cache
+     * @param keys Cache key (track title) of each track, in current play order
+     * @param bpms BPM of each track
+     * @param capacity LRUCache capacity (controller_cache_size)
+     * @param max_bpm_jump Largest BPM jump a move may introduce; 0 means no limit
+     * @return Permutation in the same form as optimize()
+     *
+     * Walks the current order and, whenever a track with later repeats is
+     * played, pulls its next repeat forward so at most capacity - 1 other
+     * tracks are played in between (an LRU cache of that capacity still holds it).
+     * A pulled repeat that would break max_bpm_jump is left where it was.
+     */
+    static std::vector<size_t> cache_order(const std::vector<std::string>& keys, const std::vector<int>& bpms,
+                                           size_t capacity, int max_bpm_jump = 0);
+
+    /**
+     * @brief Number of cache hits an LRU cache of the given capacity would see, starting empty
+     * @param keys Cache key of each track
+     * @param order Play order (indices into keys)
+     */
+    static size_t predict_cache_hits(const std::vector<std::string>& keys, const std::vector<size_t>& order,
+                                     size_t capacity);
+
+    /**
+     * @brief Penalty added to a transition that needs a BPM sync
+     */
+    void set_sync_penalty(int penalty) { sync_penalty = penalty; }
+
+    unsigned get_thread_count() const { return thread_count; }
+
+private:
+    int bpm_tolerance;
+    bool auto_sync;
+    unsigned thread_count;
+    int sync_penalty;
+
+    /**
+     * @brief Static cost of playing b right after a
+     */
+    long long edge_cost(int a, int b) const;
+
+    /**
+     * @brief Total static cost of an order
+     */
+    long long path_cost(const std::vector<int>& bpms, const std::vector<size_t>& order) const;
+
+    /**
+     * @brief Nearest-neighbour order starting from a given track
+     * @param sorted Track indices sorted by BPM
+     * @param start_rank Position in sorted of the first track
+     */
+    std::vector<size_t> greedy_order(const std::vector<int>& bpms, const std::vector<size_t>& sorted,
+                                     size_t start_rank) const;
+
+    /**
+     * @brief Improve an order in place with 2-opt and Or-opt until no move helps
+     */
+    void local_search(const std::vector<int>& bpms, std::vector<size_t>& order) const;
+
+    /**
+     * @brief One sweep of 2-opt moves (reverse a segment)
+     * @return true if any move improved the order
+     */
+    bool two_opt_pass(const std::vector<int>& bpms, std::vector<size_t>& order) const;
+
+    /**
+     * @brief One sweep of Or-opt moves (relocate a segment of 1-3 tracks)
+     * @return true if any move improved the order
+     */
+    bool or_opt_pass(const std::vector<int>& bpms, std::vector<size_t>& order) const;
+};
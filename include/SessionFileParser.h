@@ -1,10 +1,14 @@
-<<<<<<< HEAD
 #pragma once
 
+#include "CrossfadeKernels.h"
+#include "IntegerParsing.h"
+#include "StringSlice.h"
 #include <string>
 #include <vector>
 #include <map>
 #include <fstream>
+#include <functional>
+#include <utility>
 
 /**
  * @brief Configuration data parsed from DJ session config files
@@ -38,23 +42,32 @@ struct SessionConfig {
     
     // Cache settings
     int controller_cache_size;
+    int cache_order_max_bpm_jump;    // BPM limit for cache-optimized ordering (0 = no limit)
     
     // Mixing settings
-    int default_crossfade_time;
+    int default_crossfade_time;      // Seconds a transition is rendered over (0 = cut)
+    CrossfadeCurve crossfade_curve;
     int bpm_tolerance;
     bool auto_sync;
     
     // Playlists - name mapped to list of track indices
     std::map<std::string, std::vector<int>> playlists;
+    
+    // Tuning knobs - tuning.<name>=<value> lines, name (without the prefix) mapped to
+    // the raw value; ConfigurationManager checks and applies them
+    std::map<std::string, std::string> tuning;
     SessionConfig() 
         : app_name(""), 
           version(""), 
           library_tracks(), 
           controller_cache_size(8), 
+          cache_order_max_bpm_jump(0), 
           default_crossfade_time(5), 
+          crossfade_curve(CrossfadeCurve::EQUAL_POWER), 
           bpm_tolerance(10), 
           auto_sync(true), 
-          playlists() {}
+          playlists(), 
+          tuning() {}
 };
 
 /**
@@ -72,18 +85,31 @@ struct PlaylistData {
         int bpm;
         int extra_param1;        // bitrate for MP3, sample_rate for WAV  
         int extra_param2;        // has_tags for MP3, bit_depth for WAV
+        
+        PlaylistTrack()
+            : type(), title(), artist(), duration_seconds(0), bpm(0), extra_param1(0), extra_param2(0) {}
     };
     
     std::vector<PlaylistTrack> tracks;
+    
+    PlaylistData() : name(), comment(), tracks() {}
 };
 
 /**
  * @brief File parser for DJ session configuration and playlist files
  * 
  * This helper class handles parsing of the file formats.
+ * Config files are memory-mapped and cut into StringSlices in place; strings
+ * are only allocated for the values stored in the SessionConfig / TrackInfo.
+ * Large configs are split into newline-aligned chunks that are parsed in
+ * parallel and merged in file order, so the result and every warning (with
+ * its line number) are the same as parsing the file front to back.
+ * Configs of 1 MB or more keep a parsed copy in <config>.cache (ConfigCache),
+ * replayed instead of parsing while the file's contents are unchanged.
  * Phase 4 note: Playlists are discovered under ./playlists (interactive selection).
- * The app uses bpm_tolerance and auto_sync settings; default_crossfade_time is ignored
- * for logging/behavior in the instant-transition model.
+ * The app uses bpm_tolerance and auto_sync settings; default_crossfade_time and
+ * crossfade_curve only shape the rendered mix (MixingEngineService), not the
+ * instant-transition deck policy or its logging.
  */
 class SessionFileParser {
 public:
@@ -100,11 +126,37 @@ public:
      * library_track_1=MP3,title,{artist1;artist2;},duration,bpm,bitrate,has_tags
      * library_track_2=WAV,title,{artist1;artist2;},duration,bpm,sample_rate,bit_depth
      * controller_cache_size=8
+     * cache_order_max_bpm_jump=0
      * bpm_tolerance=10
      * auto_sync=true
+     * default_crossfade_time=5
+     * crossfade_curve=equal_power
+     * playlists_directory=playlists
+     * tuning.parse_threads=4
      * playlistname=1,2,3
      */
     static bool parse_config_file(const std::string& config_path, SessionConfig& config);
+
+    /**
+     * @brief Receives parsed library tracks, a batch at a time, in file order
+     * The handler may move from the tracks; the parser refills the same entries for a later batch
+     */
+    typedef std::function<void(std::vector<SessionConfig::TrackInfo>& batch)> TrackBatchHandler;
+
+    /**
+     * @brief Parse a config file, streaming library tracks to a handler
+     * @param config Output for settings and playlists; library_tracks is left untouched
+     * @param on_tracks Called with up to batch_size tracks at a time, on the calling thread
+     * @param batch_size Most tracks per handler call (a batch never spans two chunks)
+     * @param thread_count Chunks parsed at once (0 = hardware concurrency); the parser
+     * holds the tracks of at most that many 1 MB chunks in memory
+     * @param use_cache Replay and rewrite the <config>.cache sidecar of a large config;
+     * false always parses the text and leaves the sidecar alone (for benchmarks)
+     * @return true if parsing successful, false on error
+     */
+    static bool parse_config_file(const std::string& config_path, SessionConfig& config,
+                                  const TrackBatchHandler& on_tracks, size_t batch_size = 1024,
+                                  unsigned thread_count = 0, bool use_cache = true);
     
     /**
      * @brief Parse a playlist file
@@ -119,6 +171,20 @@ public:
      */
     static bool parse_playlist_file(const std::string& playlist_path, PlaylistData& playlist_data);
     
+    /**
+     * @brief Parse every *.playlist file of a directory
+     * @param directory Directory to scan (not recursive)
+     * @param playlists Output, one entry per readable file, sorted by file name
+     * @param thread_count Files parsed at once (0 = hardware concurrency)
+     * @return false if the directory cannot be opened
+     * 
+     * Each worker reads its files with one read() each into a buffer it reuses,
+     * so the I/O allocates nothing per file. Warnings are printed after all
+     * files are parsed, in file order.
+     */
+    static bool parse_playlist_directory(const std::string& directory, std::vector<PlaylistData>& playlists,
+                                         unsigned thread_count = 0);
+    
     /**
      * @brief Extract playlist name from file path
      * @param playlist_path Full path to playlist file
@@ -135,42 +201,115 @@ public:
 
 private:
     /**
-     * @brief Split a string by delimiter
-     * @param str String to split
-     * @param delimiter Character to split on
-     * @return Vector of split parts
+     * @brief A problem found in a config chunk, printed when the chunk is merged
+     */
+    struct ConfigWarning {
+        enum Kind {
+            INVALID_TRACK,
+            INVALID_CACHE_SIZE,
+            INVALID_BPM_JUMP,
+            INVALID_BPM_TOLERANCE,
+            INVALID_CROSSFADE_TIME,
+            INVALID_CROSSFADE_CURVE,
+            INVALID_PLAYLIST_INDEX,
+            UNKNOWN_KEY,
+            UNPARSABLE_LINE
+        };
+        
+        Kind kind;
+        int line;                   // Line number within the chunk
+        size_t track_position;      // Tracks the chunk had parsed before this line
+        StringSlice text;           // Key, playlist name or whole line
+        StringSlice index_text;     // Rejected playlist index
+        
+        ConfigWarning(Kind kind, int line, size_t track_position,
+                      const StringSlice& text = StringSlice(), const StringSlice& index_text = StringSlice())
+            : kind(kind), line(line), track_position(track_position), text(text), index_text(index_text) {}
+    };
+    
+    // Settings a chunk assigned (ConfigChunk::assigned)
+    enum SettingBit {
+        SET_APP_NAME = 1,
+        SET_VERSION = 2,
+        SET_CACHE_SIZE = 4,
+        SET_BPM_JUMP = 8,
+        SET_BPM_TOLERANCE = 16,
+        SET_AUTO_SYNC = 32,
+        SET_PLAYLISTS_DIRECTORY = 64,
+        SET_CROSSFADE_TIME = 128,
+        SET_CROSSFADE_CURVE = 256
+    };
+    
+    // Fields of a library or playlist track line
+    static const size_t TRACK_FIELD_COUNT = 7;
+    
+    /**
+     * @brief What one newline-aligned slice of a config file parsed to
+     */
+    struct ConfigChunk {
+        StringSlice text;
+        int line_count;
+        std::vector<std::vector<SessionConfig::TrackInfo>> batches;    // Parsed tracks, batch_size per batch
+        size_t track_count;
+        unsigned assigned;                              // SettingBit flags
+        SessionConfig settings;                         // Last value of each assigned setting
+        std::vector<std::pair<std::string, std::vector<int>>> playlists;   // In file order
+        std::vector<ConfigWarning> warnings;            // In file order
+        
+        ConfigChunk()
+            : text(), line_count(0), batches(), track_count(0), assigned(0), settings(), playlists(), warnings() {}
+    };
+    
+    /**
+     * @brief Parse chunk.text (whole lines) into the rest of the chunk
+     * @param batch_size Tracks per entry of chunk.batches
+     */
+    static void parse_config_chunk(ConfigChunk& chunk, size_t batch_size);
+    
+    /**
+     * @brief Write a chunk warning the way the sequential parser words it (no newline)
+     * @param first_line Line number of the chunk's first line
      */
-    static std::vector<std::string> split_string(const std::string& str, char delimiter);
+    static void print_warning(std::ostream& out, const ConfigWarning& warning, int first_line);
     
     /**
-     * @brief Trim whitespace from string
-     * @param str String to trim
-     * @return Trimmed string
+     * @brief Copy the settings flagged in assigned (SettingBit) and every tuning entry into config
      */
-    static std::string trim_string(const std::string& str);
+    static void apply_settings(const SessionConfig& settings, unsigned assigned, SessionConfig& config);
+    
+    /**
+     * @brief Parse a decimal integer with std::stoi's rules, without exceptions
+     * (see parse_leading_integer)
+     * @param str Text to parse
+     * @param value Output value, unchanged on error
+     * @return IntegerParseError::NONE on success
+     */
+    static IntegerParseError parse_int(const StringSlice& str, int& value) {
+        return parse_leading_integer(str.begin(), str.end(), value);
+    }
     
     /**
      * @brief Parse boolean value from string
      * @param str String containing "true" or "false"
      * @return Parsed boolean value
      */
-    static bool parse_bool(const std::string& str);
+    static bool parse_bool(const StringSlice& str);
     
     /**
      * @brief Check if line is a comment (starts with #)
      * @param line Line to check
      * @return true if comment line
      */
-    static bool is_comment_line(const std::string& line);
+    static bool is_comment_line(const StringSlice& line);
     
     /**
      * @brief Parse key=value pair from configuration line
      * @param line Configuration line
-     * @param key Output key
-     * @param value Output value
+     * @param key Output key (trimmed, points into line)
+     * @param value Output value (trimmed, points into line)
      * @return true if parsing successful
      */
-    static bool parse_key_value(const std::string& line, std::string& key, std::string& value);
+    static bool parse_key_value(const StringSlice& line, StringSlice& key, StringSlice& value);
     
     /**
      * @brief Parse library_track line from config
@@ -178,23 +317,33 @@ private:
      * @param track_info Output track information
      * @return true if parsing successful
      */
-    static bool parse_library_track(const std::string& line, SessionConfig::TrackInfo& track_info);
+    static bool parse_library_track(const StringSlice& line, SessionConfig::TrackInfo& track_info);
+    
+    /**
+     * @brief Split a track line into its (trimmed) fields and parse the numeric ones
+     * @param fields Output type, title, artist(s), then the four numbers as text
+     * @return false if a field is missing, a number is invalid or the type is not MP3/WAV
+     * (the numeric outputs may then be partly written)
+     */
+    static bool parse_track_fields(const StringSlice& line, StringSlice (&fields)[TRACK_FIELD_COUNT],
+                                   int& duration_seconds, int& bpm, int& extra_param1, int& extra_param2);
     
     /**
      * @brief Parse artist list from {artist1;artist2;...} format
      * @param artist_str String containing artists in curly braces
-     * @return Vector of artist names
+     * @param artists Output artist names
      */
-    static std::vector<std::string> parse_artist_list(const std::string& artist_str);
+    static void parse_artist_list(const StringSlice& artist_str, std::vector<std::string>& artists);
     
     /**
-     * @brief Parse playlist line from config (playlist_name=1,2,3)
-     * @param line Playlist line from config
-     * @param playlist_name Output playlist name
+     * @brief Parse playlist entry from config (playlist_name=1,2,3)
+     * @param value Value of the config line
      * @param track_indices Output vector of track indices
+     * @param invalid_indices Output entries that are not integers (skipped)
      * @return true if parsing successful
      */
-    static bool parse_playlist_line(const std::string& line, std::string& playlist_name, std::vector<int>& track_indices);
+    static bool parse_playlist_line(const StringSlice& value, std::vector<int>& track_indices,
+                                    std::vector<StringSlice>& invalid_indices);
     
     /**
      * @brief Parse track line from playlist
@@ -202,210 +351,12 @@ private:
      * @param track Output track information
      * @return true if parsing successful
      */
-    static bool parse_playlist_track(const std::string& line, PlaylistData::PlaylistTrack& track);
-=======
-#pragma once
-
-#include <string>
-#include <vector>
-#include <map>
-#include <fstream>
-
-/**
- * @brief Configuration data parsed from DJ session config files
- */
-struct SessionConfig {
-    std::string app_name;
-    std::string version;
-    
-    // Library tracks from config file
-    struct TrackInfo {
-        std::string type;        // MP3 or WAV
-        std::string title;
-        std::vector<std::string> artists;  // Changed to vector for multiple artists
-        int duration_seconds;
-        int bpm;
-        int extra_param1;        // bitrate for MP3, sample_rate for WAV
-        int extra_param2;        // has_tags for MP3, bit_depth for WAV
-        
-        TrackInfo() 
-            : type(""), 
-              title(""), 
-              artists(), 
-              duration_seconds(0), 
-              bpm(0), 
-              extra_param1(0), 
-              extra_param2(0) {}
-    };
-    
-    std::vector<TrackInfo> library_tracks;
-    
-    // Cache settings
-    int controller_cache_size;
-    
-    // Mixing settings
-    int default_crossfade_time;
-    int bpm_tolerance;
-    bool auto_sync;
-    
-    // Playlists - name mapped to list of track indices
-    std::map<std::string, std::vector<int>> playlists;
-    SessionConfig() 
-        : app_name(""), 
-          version(""), 
-          library_tracks(), 
-          controller_cache_size(8), 
-          default_crossfade_time(5), 
-          bpm_tolerance(10), 
-          auto_sync(true), 
-          playlists() {}
-};
-
-/**
- * @brief Playlist data parsed from .playlist files
- */
-struct PlaylistData {
-    std::string name;
-    std::string comment;  // From first line if it's a comment
-    
-    struct PlaylistTrack {
-        std::string type;        // MP3 or WAV
-        std::string title;
-        std::string artist;
-        int duration_seconds;
-        int bpm;
-        int extra_param1;        // bitrate for MP3, sample_rate for WAV  
-        int extra_param2;        // has_tags for MP3, bit_depth for WAV
-    };
-    
-    std::vector<PlaylistTrack> tracks;
-};
-
-/**
- * @brief File parser for DJ session configuration and playlist files
- * 
- * This helper class handles parsing of the file formats.
- * Phase 4 note: Playlists are discovered under ./playlists (interactive selection).
- * The app uses bpm_tolerance and auto_sync settings; default_crossfade_time is ignored
- * for logging/behavior in the instant-transition model.
- */
-class SessionFileParser {
-public:
-    /**
-     * @brief Parse a DJ session configuration file
-     * @param config_path Path to the .txt configuration file
-     * @param config Output structure for parsed data
-     * @return true if parsing successful, false on error
-     * 
-     * Expected format:
-     * # Comments start with #
-     * app_name=DJ Track Library Manager
-     * version=2.0
-     * library_track_1=MP3,title,{artist1;artist2;},duration,bpm,bitrate,has_tags
-     * library_track_2=WAV,title,{artist1;artist2;},duration,bpm,sample_rate,bit_depth
-     * controller_cache_size=8
-     * bpm_tolerance=10
-     * auto_sync=true
-     * playlistname=1,2,3
-     */
-    static bool parse_config_file(const std::string& config_path, SessionConfig& config);
-    
-    /**
-     * @brief Parse a playlist file
-     * @param playlist_path Path to the .playlist file
-     * @param playlist_data Output structure for parsed data
-     * @return true if parsing successful, false on error
-     * 
-     * Expected format:
-     * # Optional comment describing playlist
-     * MP3,title,artist,duration,bpm,bitrate,has_tags
-     * WAV,title,artist,duration,bpm,sample_rate,bit_depth
-     */
-    static bool parse_playlist_file(const std::string& playlist_path, PlaylistData& playlist_data);
-    
-    /**
-     * @brief Extract playlist name from file path
-     * @param playlist_path Full path to playlist file
-     * @return Extracted name (filename without extension)
-     */
-    static std::string extract_playlist_name(const std::string& playlist_path);
-    
-    /**
-     * @brief Validate track format line
-     * @param line Line to validate
-     * @return true if line matches expected track format
-     */
-    static bool validate_track_format(const std::string& line);
-
-private:
-    /**
-     * @brief Split a string by delimiter
-     * @param str String to split
-     * @param delimiter Character to split on
-     * @return Vector of split parts
-     */
-    static std::vector<std::string> split_string(const std::string& str, char delimiter);
-    
-    /**
-     * @brief Trim whitespace from string
-     * @param str String to trim
-     * @return Trimmed string
-     */
-    static std::string trim_string(const std::string& str);
-    
-    /**
-     * @brief Parse boolean value from string
-     * @param str String containing "true" or "false"
-     * @return Parsed boolean value
-     */
-    static bool parse_bool(const std::string& str);
-    
-    /**
-     * @brief Check if line is a comment (starts with #)
-     * @param line Line to check
-     * @return true if comment line
-     */
-    static bool is_comment_line(const std::string& line);
-    
-    /**
-     * @brief Parse key=value pair from configuration line
-     * @param line Configuration line
-     * @param key Output key
-     * @param value Output value
-     * @return true if parsing successful
-     */
-    static bool parse_key_value(const std::string& line, std::string& key, std::string& value);
-    
-    /**
-     * @brief Parse library_track line from config
-     * @param line library_track configuration line
-     * @param track_info Output track information
-     * @return true if parsing successful
-     */
-    static bool parse_library_track(const std::string& line, SessionConfig::TrackInfo& track_info);
-    
-    /**
-     * @brief Parse artist list from {artist1;artist2;...} format
-     * @param artist_str String containing artists in curly braces
-     * @return Vector of artist names
-     */
-    static std::vector<std::string> parse_artist_list(const std::string& artist_str);
-    
-    /**
-     * @brief Parse playlist line from config (playlist_name=1,2,3)
-     * @param line Playlist line from config
-     * @param playlist_name Output playlist name
-     * @param track_indices Output vector of track indices
-     * @return true if parsing successful
-     */
-    static bool parse_playlist_line(const std::string& line, std::string& playlist_name, std::vector<int>& track_indices);
-    
-    /**
-     * @brief Parse track line from playlist
-     * @param line Track line from playlist file
-     * @param track Output track information
-     * @return true if parsing successful
-     */
-    static bool parse_playlist_track(const std::string& line, PlaylistData::PlaylistTrack& track);
->>>>>>> origin/main
+    static bool parse_playlist_track(const StringSlice& line, PlaylistData::PlaylistTrack& track);
+    
+    /**
+     * @brief Parse the contents of a playlist file (everything but the name)
+     * @param invalid_lines Output line numbers of track lines that did not parse (skipped)
+     */
+    static void parse_playlist_text(const StringSlice& text, PlaylistData& playlist_data,
+                                    std::vector<int>& invalid_lines);
 };
\ No newline at end of file
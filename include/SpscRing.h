@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+/**
+ * @brief Wait-free single-producer single-consumer ring of Capacity values
+ *
+ * One thread may call try_push / free_slots, one other thread try_pop. Every
+ * call finishes in a fixed number of steps (no locks, loops or allocation),
+ * so a real-time thread can use either end. Values are copied in and out and
+ * the storage lives inside the ring, so T should be small and trivially copyable.
+ *
+ * head and tail only ever grow (slot = index % Capacity), and each is written
+ * by one side only: the release store that publishes an index makes the slot
+ * it covers visible to the other side's acquire load.
+ */
+template<typename T, size_t Capacity>
+class SpscRing {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+
+public:
+    SpscRing() : head(0), head_padding(), tail(0), tail_padding(), slots() {}
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    /**
+     * @brief Producer: append a value
+     * @return false if the ring is full
+     */
+    bool try_push(const T& value) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) == Capacity) {
+            return false;
+        }
+        slots[h & (Capacity - 1)] = value;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Consumer: take the oldest value
+     * @return false if the ring is empty
+     */
+    bool try_pop(T& value) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (head.load(std::memory_order_acquire) == t) {
+            return false;
+        }
+        value = slots[t & (Capacity - 1)];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Producer: slots certainly free (the consumer may free more meanwhile)
+     */
+    size_t free_slots() const {
+        return Capacity - (head.load(std::memory_order_relaxed) - tail.load(std::memory_order_acquire));
+    }
+
+private:
+    // Each index on its own cache line, so the two threads do not contend on one
+    std::atomic<size_t> head;       // Next slot to write; written by the producer
+    char head_padding[64 - sizeof(std::atomic<size_t>)];
+    std::atomic<size_t> tail;       // Next slot to read; written by the consumer
+    char tail_padding[64 - sizeof(std::atomic<size_t>)];
+    T slots[Capacity];
+};
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <ostream>
+#include <string>
+
+/**
+ * @brief Non-owning view of a run of characters (pointer + length)
+ *
+ * Lets the parsers cut lines, keys and fields out of a mapped file without
+ * copying them; a std::string is only made (str()) for values that are kept.
+ * The viewed characters must outlive the slice.
+ */
+class StringSlice {
+public:
+    static const size_t npos = static_cast<size_t>(-1);
+
+    StringSlice() : chars(nullptr), length(0) {}
+    StringSlice(const char* chars, size_t length) : chars(chars), length(length) {}
+    explicit StringSlice(const std::string& str) : chars(str.data()), length(str.size()) {}
+
+    const char* data() const { return chars; }
+    size_t size() const { return length; }
+    bool empty() const { return length == 0; }
+    const char* begin() const { return chars; }
+    const char* end() const { return chars + length; }
+    char operator[](size_t i) const { return chars[i]; }
+    char front() const { return chars[0]; }
+    char back() const { return chars[length - 1]; }
+
+    std::string str() const { return std::string(chars, length); }
+
+    /**
+     * @brief Position of the first c at or after from, or npos
+     */
+    size_t find(char c, size_t from = 0) const {
+        if (from >= length) {
+            return npos;
+        }
+        const void* hit = std::memchr(chars + from, c, length - from);
+        return hit ? static_cast<size_t>(static_cast<const char*>(hit) - chars) : npos;
+    }
+
+    /**
+     * @brief Up to count characters starting at pos (clamped like std::string::substr)
+     */
+    StringSlice substr(size_t pos, size_t count = npos) const {
+        if (pos > length) {
+            pos = length;
+        }
+        return StringSlice(chars + pos, (count < length - pos) ? count : length - pos);
+    }
+
+    /**
+     * @brief Without leading and trailing spaces, tabs, CR and LF
+     */
+    StringSlice trim() const {
+        size_t start = 0;
+        size_t stop = length;
+        while (start < stop && is_blank(chars[start])) {
+            start++;
+        }
+        while (stop > start && is_blank(chars[stop - 1])) {
+            stop--;
+        }
+        return StringSlice(chars + start, stop - start);
+    }
+
+    bool starts_with(const char* prefix) const {
+        size_t prefix_length = std::strlen(prefix);
+        return prefix_length <= length && std::memcmp(chars, prefix, prefix_length) == 0;
+    }
+
+    bool operator==(const char* other) const {
+        size_t other_length = std::strlen(other);
+        return other_length == length && std::memcmp(chars, other, length) == 0;
+    }
+    bool operator!=(const char* other) const { return !(*this == other); }
+
+    /**
+     * @brief Cut the next delimiter-separated token off the front of rest
+     * @return false once rest is used up; like std::getline, a trailing
+     * delimiter does not produce a final empty token
+     */
+    static bool next_token(StringSlice& rest, char delimiter, StringSlice& token) {
+        if (rest.empty()) {
+            return false;
+        }
+        size_t stop = rest.find(delimiter);
+        if (stop == npos) {
+            token = rest;
+            rest = StringSlice(rest.end(), 0);
+        } else {
+            token = StringSlice(rest.chars, stop);
+            rest = StringSlice(rest.chars + stop + 1, rest.length - stop - 1);
+        }
+        return true;
+    }
+
+private:
+    const char* chars;
+    size_t length;
+
+    static bool is_blank(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+};
+
+inline std::ostream& operator<<(std::ostream& out, const StringSlice& slice) {
+    return out.write(slice.data(), static_cast<std::streamsize>(slice.size()));
+}
@@ -0,0 +1,175 @@
+#pragma once
+
+#include "AudioTrack.h"
+#include "SessionFileParser.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class LibrarySnapshot;
+
+/**
+ * @brief Read-only view of one contiguous metadata column
+ */
+template<typename T>
+class ColumnView {
+public:
+    ColumnView(const T* values, size_t count) : values(values), count(count) {}
+
+    const T& operator[](size_t row) const { return values[row]; }
+    size_t size() const { return count; }
+    const T* begin() const { return values; }
+    const T* end() const { return values + count; }
+
+private:
+    const T* values;
+    size_t count;
+};
+
+/**
+ * @brief Column-oriented track metadata (structure of arrays)
+ *
+ * Holds everything the config says about each library track in contiguous
+ * per-field columns, so scans and aggregations (BPM ranges, durations,
+ * quality) read plain arrays instead of chasing AudioTrack pointers through
+ * virtual calls. Row r describes library ID r + 1.
+ *
+ * The heavy AudioTrack objects (with their waveform buffers) are not stored
+ * here; materialize() creates one from a row when it is actually needed.
+ *
+ * A table is either filled with append() or attached to a memory-mapped
+ * LibrarySnapshot, in which case the columns point straight into the mapping.
+ *
+ * Rows are never renumbered: remove() only marks a row as removed (its values
+ * stay readable), so library IDs held by playlists keep pointing at the same
+ * track. Scans skip removed rows.
+ */
+class TrackMetadataTable {
+public:
+    enum Format : uint8_t { FORMAT_MP3 = 0, FORMAT_WAV = 1 };
+
+    TrackMetadataTable();
+
+    /**
+     * @brief Append a row for a parsed library track
+     * @return Row index of the new track
+     * @note On a snapshot-backed table this first copies the snapshot rows into memory
+     */
+    size_t append(const SessionConfig::TrackInfo& track_info);
+
+    /**
+     * @brief Overwrite a row with new track data (the row keeps its index)
+     * @note On a snapshot-backed table this first copies the snapshot rows into memory
+     */
+    void update(size_t row, const SessionConfig::TrackInfo& track_info);
+
+    /**
+     * @brief Mark a row as removed
+     * @note On a snapshot-backed table this first copies the snapshot rows into memory
+     */
+    void remove(size_t row);
+
+    bool is_removed(size_t row) const { return removed_count != 0 && removed_column[row] != 0; }
+
+    /**
+     * @brief Whether a live row holds exactly this track (as append() would store it)
+     */
+    bool matches(size_t row, const SessionConfig::TrackInfo& track_info) const;
+
+    /**
+     * @brief Replace the contents with the rows of a mapped snapshot (no copying)
+     */
+    void attach(const std::shared_ptr<const LibrarySnapshot>& source);
+
+    /**
+     * @brief Whether the columns point into a mapped snapshot (no row was changed since attach)
+     */
+    bool is_snapshot_backed() const { return snapshot != nullptr; }
+
+    void reserve(size_t rows);
+    void clear();
+
+    /**
+     * @brief Number of rows, removed ones included (the largest library ID)
+     */
+    size_t size() const;
+
+    /**
+     * @brief Number of rows that are not removed
+     */
+    size_t live_size() const { return size() - removed_count; }
+
+    /**
+     * @brief Create the track object described by a row
+     * @return Newly allocated MP3Track or WAVTrack (caller owns)
+     * @note Only reads the table, so rows may be materialized concurrently.
+     * Snapshot rows reuse the stored waveform instead of generating one.
+     */
+    AudioTrack* materialize(size_t row) const;
+
+    // ========== COLUMNS ==========
+    ColumnView<int> bpms() const;
+    ColumnView<int> durations() const;
+    ColumnView<uint8_t> formats() const;
+    ColumnView<int> rates() const;         // bitrate (MP3) or sample rate (WAV)
+    ColumnView<int> depths() const;        // has_tags (MP3) or bit depth (WAV)
+    ColumnView<double> quality_scores() const;
+
+    // Cold fields, read one row at a time
+    std::string title(size_t row) const;
+    std::vector<std::string> artists_of(size_t row) const;
+
+    // ========== SCANS ==========
+
+    /**
+     * @brief Sum of all track durations in seconds
+     */
+    long long total_duration() const;
+
+    /**
+     * @brief Mean BPM over all tracks (0 for an empty table)
+     */
+    double average_bpm() const;
+
+    /**
+     * @brief Number of tracks with min_bpm <= bpm <= max_bpm
+     */
+    size_t count_in_bpm_range(int min_bpm, int max_bpm) const;
+
+    /**
+     * @brief Number of tracks with quality score >= min_quality
+     */
+    size_t count_with_quality(double min_quality) const;
+
+private:
+    std::vector<int> bpm_column;
+    std::vector<int> duration_column;
+    std::vector<uint8_t> format_column;
+    std::vector<int> rate_column;
+    std::vector<int> depth_column;
+    std::vector<double> quality_column;
+    // Cold columns, only read when a track is materialized or looked up by title
+    std::vector<std::string> title_column;
+    std::vector<std::vector<std::string>> artist_column;
+    std::vector<uint8_t> removed_column;
+    size_t removed_count;
+
+    std::shared_ptr<const LibrarySnapshot> snapshot;   // Set while backed by a mapped snapshot
+
+    /**
+     * @brief Copy the snapshot rows into the owned columns and drop the snapshot
+     */
+    void detach();
+
+    /**
+     * @brief Write a parsed track into an existing owned row
+     */
+    void assign(size_t row, const SessionConfig::TrackInfo& track_info);
+
+    /**
+     * @brief Removed flag of every row, or nullptr when no row is removed
+     */
+    const uint8_t* removed_rows() const { return removed_count != 0 ? removed_column.data() : nullptr; }
+};
@@ -0,0 +1,136 @@
+#pragma once
+
+#include "TrackMetadataTable.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Conjunctive library query: every set field must match
+ *
+ * Unset ranges use their defaults (-1 for "no bound"). Results are library
+ * IDs (1-based, as in playlist indices), ordered by order_by and cut to
+ * limit entries when limit > 0.
+ */
+struct TrackQuery {
+    enum Order { BY_ID, BY_BPM, BY_DURATION, BY_QUALITY_DESC };
+    enum FormatFilter { ANY_FORMAT, MP3_ONLY, WAV_ONLY };
+
+    int min_bpm = -1;
+    int max_bpm = -1;
+    int min_duration = -1;
+    int max_duration = -1;
+    FormatFilter format = ANY_FORMAT;
+    double min_quality = -1.0;
+    std::string artist = std::string();     // Empty matches every artist
+
+    Order order_by = BY_ID;     // Ties always break by ascending ID
+    size_t limit = 0;           // Top-k; 0 returns every match
+};
+
+/**
+ * @brief Secondary indexes over a TrackMetadataTable
+ *
+ * - BPM and duration: rows sorted by value, so a range is two binary searches
+ * - Format and quality bucket (10 points wide): bitmaps, one bit per row
+ * - Artist: posting list of rows per artist name
+ *
+ * run() drives the query from the most selective index it can use and checks
+ * the remaining predicates against the table's columns, so no AudioTrack
+ * object is ever touched.
+ *
+ * Single rows can be added, changed or removed without a rebuild: bitmaps and
+ * posting lists are updated in place, while the sorted indexes only lose the
+ * row's entry (it is skipped from then on) and the row goes to a small
+ * unsorted delta that run() checks as well. The delta is merged into the
+ * sorted indexes once it grows past a fraction of the table, so each change
+ * costs O(log n) amortized.
+ */
+class TrackQueryIndex {
+public:
+    TrackQueryIndex();
+
+    /**
+     * @brief Index every row of the table (removed rows are skipped)
+     */
+    void build(const TrackMetadataTable& table);
+
+    /**
+     * @brief Index a row that was appended to the table or just overwritten
+     * @note A row that is already indexed must be erased first
+     */
+    void insert(const TrackMetadataTable& table, size_t row);
+
+    /**
+     * @brief Drop a row from the index
+     * @note Call while the table still holds the row's indexed values, i.e. before
+     * removing or overwriting it
+     */
+    void erase(const TrackMetadataTable& table, size_t row);
+
+    /**
+     * @brief Evaluate a query against the indexed table
+     * @return Matching library IDs in the requested order
+     */
+    std::vector<int> run(const TrackMetadataTable& table, const TrackQuery& query) const;
+
+    size_t size() const { return row_count; }
+
+    /**
+     * @brief Rows (ascending) of every track by an artist, or nullptr if there are none
+     */
+    const std::vector<uint32_t>* artist_rows(const std::string& artist) const;
+
+private:
+    typedef std::vector<uint64_t> Bitmap;
+    static const size_t QUALITY_BUCKETS = 11;   // [0,10), [10,20), ..., [90,100), 100
+
+    // Per-row state for incremental updates
+    enum RowFlag : uint8_t {
+        ROW_SORTED = 1,     // The row's entries in the sorted indexes are current
+        ROW_PENDING = 2     // The row is listed in pending_rows
+    };
+
+    size_t row_count;
+    std::vector<uint32_t> rows_by_bpm;          // Row indices sorted by (bpm, row)
+    std::vector<int> sorted_bpms;               // bpm of rows_by_bpm[i]
+    std::vector<uint32_t> rows_by_duration;
+    std::vector<int> sorted_durations;
+    Bitmap format_bitmaps[2];                   // Indexed by TrackMetadataTable::Format
+    Bitmap quality_bitmaps[QUALITY_BUCKETS];
+    std::unordered_map<std::string, std::vector<uint32_t>> artist_postings;   // Ascending rows
+    Bitmap live_rows;                           // Indexed (not removed) rows
+    std::vector<uint8_t> row_flags;
+    std::vector<uint32_t> pending_rows;         // Rows missing from the sorted indexes (may include erased ones)
+    size_t stale_entries;                       // Sorted index entries no longer ROW_SORTED
+
+    static size_t quality_bucket(double score);
+
+    bool is_live(size_t row) const { return (live_rows[row >> 6] >> (row & 63)) & 1; }
+
+    /**
+     * @brief Merge the pending rows into the sorted indexes once the delta is too large
+     */
+    void compact_if_needed(const TrackMetadataTable& table);
+
+    /**
+     * @brief Drop stale entries from one sorted index and merge rows into it
+     * @param rows Rows to add, sorted by (value, row)
+     */
+    static void merge_sorted(std::vector<uint32_t>& sorted_rows, std::vector<int>& sorted_values,
+                             const std::vector<uint32_t>& rows, const ColumnView<int>& values,
+                             const std::vector<uint8_t>& row_flags);
+
+    /**
+     * @brief Rows with lo <= value <= hi, as a [begin, end) range of a sorted index
+     */
+    static void value_range(const std::vector<int>& sorted_values, int lo, int hi, size_t& begin, size_t& end);
+
+    /**
+     * @brief Whether a row satisfies every predicate of the query
+     */
+    bool matches(const TrackMetadataTable& table, const TrackQuery& query, size_t row,
+                 const std::vector<uint32_t>* artist_rows) const;
+};
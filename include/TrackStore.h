@@ -0,0 +1,80 @@
+#pragma once
+
+#include "MP3Track.h"
+#include "WAVTrack.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Closed-set track storage, partitioned by concrete type
+ *
+ * Keeps MP3Track and WAVTrack objects by value in two contiguous arrays
+ * instead of behind AudioTrack pointers. Batch kernels walk one partition at
+ * a time; both classes are final, so every call inside a partition is bound
+ * statically and can be inlined. They dispatch once per partition rather than
+ * once per track.
+ *
+ * Rows are numbered in insertion order; kernel results are indexed by row.
+ * at() still gives polymorphic access for code that needs it.
+ */
+class TrackStore {
+public:
+    /**
+     * @brief What analyze_beatgrid() reports for a track
+     */
+    struct BeatgridAnalysis {
+        double estimated_beats;
+        double precision_factor;
+    };
+
+    TrackStore();
+
+    /**
+     * @brief Replace the contents with copies of tracks, in order (row k is tracks[k])
+     * @return false if a track is neither an MP3Track nor a WAVTrack (it is skipped)
+     */
+    bool assign(const std::vector<AudioTrack*>& tracks);
+
+    size_t add(MP3Track&& track);
+    size_t add(WAVTrack&& track);
+    void clear();
+
+    size_t size() const { return slots.size(); }
+    size_t mp3_count() const { return mp3_tracks.size(); }
+    size_t wav_count() const { return wav_tracks.size(); }
+
+    const AudioTrack& at(size_t row) const;
+
+    // ========== BATCH KERNELS ==========
+
+    /**
+     * @brief get_quality_score() of every track, indexed by row
+     */
+    std::vector<double> score_all() const;
+
+    /**
+     * @brief Beat estimate and precision factor of every track, indexed by row
+     */
+    std::vector<BeatgridAnalysis> analyze_all() const;
+
+    /**
+     * @brief load() and then analyze_beatgrid() on every track, as a deck load does,
+     * one partition after the other (all MP3 tracks in row order, then all WAV tracks)
+     */
+    void prepare_all();
+
+private:
+    enum Partition : uint8_t { MP3_PARTITION = 0, WAV_PARTITION = 1 };
+
+    struct Slot {
+        uint32_t index;         // Position in its partition
+        Partition partition;
+    };
+
+    std::vector<MP3Track> mp3_tracks;
+    std::vector<uint32_t> mp3_rows;     // Row of each MP3 track
+    std::vector<WAVTrack> wav_tracks;
+    std::vector<uint32_t> wav_rows;     // Row of each WAV track
+    std::vector<Slot> slots;            // Row -> partition and position
+};
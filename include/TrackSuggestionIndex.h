@@ -0,0 +1,142 @@
+#pragma once
+
+#include "TrackMetadataTable.h"
+#include "TrackQueryIndex.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief k-nearest-neighbour index for "what to play next" suggestions
+ *
+ * Every library track is a point (bpm, quality, duration) in a balanced KD-tree stored implicitly in one array (the node of a range
+ * is its midpoint). The distance between two tracks is the Euclidean distance
+ * of their per-feature differences times Weights, minus shared_artist_bonus if
+ * they have an artist in common. Differences are taken before weighting, so
+ * equally distant tracks compare exactly equal.
+ *
+ * The bonus is not a metric, so nearest() runs the KD-tree search over tracks
+ * that share no artist with the query and scores the (usually few) tracks that
+ * do from the artist posting lists; merging both gives the exact top k.
+ * Ties break by ascending library ID.
+ *
+ * insert() and erase() keep the index current as single rows change: an erased
+ * row's point is skipped from then on, and inserted rows wait in a small list
+ * that nearest() scans directly. The tree is rebuilt from the live rows once
+ * that list (plus skipped points) exceeds a fraction of the library, so each
+ * change costs O(log n) amortized.
+ */
+class TrackSuggestionIndex {
+public:
+    struct Weights {
+        double bpm;                   // Per BPM
+        double quality;               // 10 quality points weigh as much as 1 BPM
+        double duration;              // One minute weighs as much as 1 BPM
+        double shared_artist_bonus;   // Subtracted from the distance
+
+        Weights() : bpm(1.0), quality(0.1), duration(1.0 / 60.0), shared_artist_bonus(5.0) {}
+    };
+
+    struct Suggestion {
+        int track_id;       // 1-based library ID
+        double distance;
+    };
+
+    /**
+     * @brief Features of the track to match
+     */
+    struct Query {
+        int bpm;
+        double quality;
+        int duration;
+        std::vector<std::string> artists;
+        size_t exclude_row;     // Row never suggested (the query track itself), or size_t(-1)
+
+        Query() : bpm(0), quality(0.0), duration(0), artists(), exclude_row(static_cast<size_t>(-1)) {}
+    };
+
+    TrackSuggestionIndex();
+
+    /**
+     * @brief Index every row of the table (removed rows are skipped)
+     */
+    void build(const TrackMetadataTable& table, const Weights& weights = Weights());
+
+    /**
+     * @brief Index a row that was appended to the table or just overwritten
+     * @note A row that is already indexed must be erased first
+     */
+    void insert(const TrackMetadataTable& table, size_t row);
+
+    /**
+     * @brief Drop a row from the index
+     */
+    void erase(const TrackMetadataTable& table, size_t row);
+
+    /**
+     * @brief The k tracks closest to the query, closest first
+     * @param artist_index Query index over the same table (for artist posting lists)
+     */
+    std::vector<Suggestion> nearest(const TrackMetadataTable& table, const TrackQueryIndex& artist_index,
+                                    const Query& query, size_t k) const;
+
+    const Weights& get_weights() const { return weights; }
+
+private:
+    static const size_t DIMENSIONS = 3;
+
+    // Per-row state for incremental updates
+    enum RowFlag : uint8_t {
+        ROW_LIVE = 1,       // The row is indexed
+        ROW_IN_TREE = 2,    // The row's point in the tree is current
+        ROW_PENDING = 4     // The row is listed in pending_rows
+    };
+
+    struct Point {
+        double coords[DIMENSIONS];      // Unweighted features
+        uint32_t row;
+    };
+
+    struct Candidate {
+        double squared_distance;
+        uint32_t row;
+        bool operator<(const Candidate& other) const {
+            return squared_distance < other.squared_distance ||
+                   (squared_distance == other.squared_distance && row < other.row);
+        }
+    };
+
+    Weights weights;
+    double scales[DIMENSIONS];          // Weight of each feature
+    std::vector<Point> points;          // Implicit KD-tree
+    std::vector<uint8_t> split_dims;    // Split dimension of the node at each position
+    std::vector<uint8_t> row_flags;
+    std::vector<uint32_t> pending_rows; // Rows missing from the tree (may include erased ones)
+    size_t stale_points;                // Tree points no longer ROW_IN_TREE
+
+    static void features(int bpm, double quality, int duration, double* coords);
+    double squared_distance(const double* a, const double* b) const;
+    void build_range(size_t begin, size_t end);
+
+    /**
+     * @brief Rebuild the tree from every ROW_LIVE row
+     */
+    void rebuild(const TrackMetadataTable& table);
+
+    /**
+     * @brief Rebuild once the pending rows and stale points are too many
+     */
+    void rebuild_if_needed(const TrackMetadataTable& table);
+
+    /**
+     * @brief Offer a candidate to the k-nearest max-heap
+     */
+    static void offer(const Candidate& candidate, size_t k, std::vector<Candidate>& heap);
+
+    /**
+     * @brief Collect the k nearest non-excluded points of [begin, end) into a max-heap
+     */
+    void search(size_t begin, size_t end, const double* target, size_t k,
+                const std::vector<uint32_t>& excluded, std::vector<Candidate>& heap) const;
+};
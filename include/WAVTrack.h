@@ -15,7 +15,7 @@
  * - clone(): return a deep polymorphic copy used by the mixer; source remains unchanged.
  * - get_quality_score(): function of sample_rate and bit_depth (both higher -> better).
  */
-class WAVTrack : public AudioTrack {
+class WAVTrack final : public AudioTrack {
 private:
     int sample_rate;    // Samples per second: 44100 (CD), 48000 (pro), 96000+ (hi-res)
     int bit_depth;      // Bits per sample: 16 (CD), 24 (pro), 32 (float)
@@ -27,6 +27,13 @@ public:
     WAVTrack(const std::string& title, const std::vector<std::string>& artists, 
              int duration, int bpm, int sample_rate, int bit_depth);
 
+    /**
+     * Constructor with a stored waveform (see AudioTrack)
+     */
+    WAVTrack(const std::string& title, const std::vector<std::string>& artists, 
+             int duration, int bpm, int sample_rate, int bit_depth,
+             const double* waveform, size_t waveform_samples);
+
     // ========== TODO: IMPLEMENT VIRTUAL FUNCTIONS ==========
 
     /**
@@ -47,6 +54,19 @@ public:
      */
     double get_quality_score() const override;
 
+    /**
+     * @brief Quality score for WAV metadata, without needing a track object
+     * Defined inline so column scans (TrackMetadataTable) and batch kernels (TrackStore) can inline it
+     */
+    static double compute_quality_score(int sample_rate, int bit_depth) {
+        double score = 70.0;
+        score += (sample_rate >= 44100) ? 10.0 : 0.0;
+        score += (sample_rate >= 96000) ? 5.0 : 0.0;
+        score += (bit_depth >= 16) ? 10.0 : 0.0;
+        score += (bit_depth >= 24) ? 5.0 : 0.0;
+        return (score < 100.0) ? score : 100.0;
+    }
+
     /**
      * TODO: Implement clone function
      * HINT: Return a unique_ptr to a new WAVTrack with same properties
@@ -56,6 +76,7 @@ public:
     // Getters
     int get_sample_rate() const { return sample_rate; }
     int get_bit_depth() const { return bit_depth; }
+    double get_precision_factor() const override { return 1.0; }   // Uncompressed
 };
 
 #endif // WAVTRACK_H
\ No newline at end of file
@@ -12,12 +12,15 @@ AudioTrack::AudioTrack(const std::string& title, const std::vector<std::string>&
     waveform_data = new double[waveform_size];
 
     // Generate some dummy waveform data for testing
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_real_distribution<double> dis(-1.0, 1.0);
+    // One generator per thread, seeded once: tracks may be built concurrently
+    // (DJLibraryService::buildLibrary) and seeding per track is expensive.
+    // Each sample takes the top 53 bits of one 64-bit draw, uniform in [-1, 1),
+    // which is several times cheaper than uniform_real_distribution here
+    static thread_local std::mt19937_64 gen(std::random_device{}());
+    const double scale = 2.0 / 9007199254740992.0;  // 2 / 2^53
 
     for (size_t i = 0; i < waveform_size; ++i) {
-        waveform_data[i] = dis(gen);
+        waveform_data[i] = static_cast<double>(gen() >> 11) * scale - 1.0;
     }
     #ifdef DEBUG
     std::cout << "AudioTrack created: " << title << " by " << std::endl;
@@ -28,6 +31,13 @@ AudioTrack::AudioTrack(const std::string& title, const std::vector<std::string>&
     #endif
 }
 
+AudioTrack::AudioTrack(const std::string& title, const std::vector<std::string>& artists, 
+                      int duration, int bpm, const double* waveform, size_t waveform_samples)
+    : title(title), artists(artists), duration_seconds(duration), bpm(bpm), 
+      waveform_data(new double[waveform_samples]), waveform_size(waveform_samples) {
+    std::memcpy(waveform_data, waveform, waveform_size * sizeof(double));
+}
+
 // ========== TODO: STUDENTS IMPLEMENT RULE OF 5 ==========
 
 AudioTrack::~AudioTrack() {
@@ -0,0 +1,1324 @@
+#include "Benchmarks.h"
+#include "ConfigGenerator.h"
+#include "DJLibraryService.h"
+#include "IntegerParsing.h"
+#include "ParallelFor.h"
+#include "SessionFileParser.h"
+#include "TrackStore.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <numeric>
+#include <sstream>
+#include <streambuf>
+#include <sys/stat.h>
+#include <unordered_map>
+#include <dirent.h>
+#include <unistd.h>
+
+namespace {
+    const size_t DEFAULT_MAX_QUERY_TRACKS = 1000000;
+    const size_t DEFAULT_MAX_SUGGEST_TRACKS = 100000;      // The reference scan dominates beyond
+    const size_t DEFAULT_PARSE_TRACKS = 2000000;
+    const double PARSE_MALFORMED_RATE = 0.0001;     // So chunk merging has warnings to order
+    const size_t DEFAULT_MALFORMED_TRACKS = 1000000;
+    const size_t DEFAULT_PLAYLIST_FILES = 10000;
+    const size_t DEFAULT_PLAYLIST_TRACKS = 100000;
+    const size_t DEFAULT_MAX_STORE_TRACKS = 100000;
+    const char* const EXPECT_PREFIX = "#expect ";
+    const size_t MIN_LIBRARY_TRACKS = 1000;
+
+    /**
+     * @brief Stream buffer that drops everything written to it
+     */
+    class NullBuffer : public std::streambuf {
+    protected:
+        int overflow(int c) override { return traits_type::not_eof(c); }
+        std::streamsize xsputn(const char*, std::streamsize count) override { return count; }
+    };
+
+    /**
+     * @brief Discards std::cout while in scope, so the services' logging is not timed
+     */
+    class QuietOutput {
+    public:
+        QuietOutput() : sink(), saved(std::cout.rdbuf(&sink)) {}
+        ~QuietOutput() { std::cout.rdbuf(saved); }
+        QuietOutput(const QuietOutput&) = delete;
+        QuietOutput& operator=(const QuietOutput&) = delete;
+
+    private:
+        NullBuffer sink;
+        std::streambuf* saved;
+    };
+
+    /**
+     * @brief Collects what is written to std::cout while in scope
+     */
+    class CapturedOutput {
+    public:
+        CapturedOutput() : buffer(), saved(std::cout.rdbuf(&buffer)) {}
+        ~CapturedOutput() { std::cout.rdbuf(saved); }
+        CapturedOutput(const CapturedOutput&) = delete;
+        CapturedOutput& operator=(const CapturedOutput&) = delete;
+
+        std::string text() const { return buffer.str(); }
+
+    private:
+        std::stringbuf buffer;
+        std::streambuf* saved;
+    };
+
+    // Like rm -r
+    void remove_tree(const std::string& path) {
+        DIR* dir = opendir(path.c_str());
+        if (dir == nullptr) {
+            ::unlink(path.c_str());
+            return;
+        }
+        while (dirent* entry = readdir(dir)) {
+            if (std::strcmp(entry->d_name, ".") != 0 && std::strcmp(entry->d_name, "..") != 0) {
+                remove_tree(path + "/" + entry->d_name);
+            }
+        }
+        closedir(dir);
+        ::rmdir(path.c_str());
+    }
+
+    /**
+     * @brief Temporary workload directory, removed with everything in it when destroyed
+     */
+    class ScratchWorkload {
+    public:
+        ScratchWorkload() : directory() {
+            const char* temp = std::getenv("TMPDIR");
+            std::string pattern = std::string(temp != nullptr && *temp != '\0' ? temp : "/tmp") + "/dj_benchmark_XXXXXX";
+            std::vector<char> path(pattern.begin(), pattern.end());
+            path.push_back('\0');
+            if (::mkdtemp(path.data()) != nullptr) {
+                directory = path.data();
+            } else {
+                std::cerr << "[ERROR] Cannot create a scratch directory from " << pattern << std::endl;
+            }
+        }
+        ~ScratchWorkload() {
+            if (!directory.empty()) {
+                remove_tree(directory);
+            }
+        }
+        ScratchWorkload(const ScratchWorkload&) = delete;
+        ScratchWorkload& operator=(const ScratchWorkload&) = delete;
+
+        /**
+         * @brief (Re)write the workload; false after an error message
+         */
+        bool generate(const ConfigGenerator::Options& options) {
+            if (directory.empty()) {
+                return false;
+            }
+            QuietOutput quiet;
+            return ConfigGenerator(options).generate(directory);
+        }
+
+        std::string config_path() const { return directory + "/bin/dj_config.txt"; }
+        std::string playlist_directory() const { return directory + "/playlists"; }
+
+    private:
+        std::string directory;
+    };
+
+    /**
+     * @brief Library sizes of a sweep: 10^3, 10^4, ... up to and including max_tracks
+     */
+    std::vector<size_t> library_sizes(size_t max_tracks) {
+        std::vector<size_t> sizes;
+        for (size_t tracks = MIN_LIBRARY_TRACKS; tracks < max_tracks; tracks *= 10) {
+            sizes.push_back(tracks);
+        }
+        sizes.push_back(max_tracks);
+        return sizes;
+    }
+
+    double seconds_since(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // xorshift64: query parameters only need to be varied and repeatable
+    uint64_t next_random(uint64_t& state) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    }
+
+    size_t next_below(uint64_t& state, size_t bound) {
+        return static_cast<size_t>(next_random(state) % bound);
+    }
+
+    /**
+     * @brief A query of one of five shapes, with parameters drawn from the library
+     */
+    TrackQuery random_query(const TrackMetadataTable& table, uint64_t& state) {
+        TrackQuery query;
+        size_t row = next_below(state, table.size());
+        switch (next_below(state, 5)) {
+            case 0:     // Tracks mixable with a given one
+                query.min_bpm = table.bpms()[row] - static_cast<int>(next_below(state, 4));
+                query.max_bpm = table.bpms()[row] + static_cast<int>(next_below(state, 4));
+                query.limit = 100;
+                break;
+            case 1:     // Best lossless tracks in a BPM band
+                query.min_bpm = table.bpms()[row];
+                query.max_bpm = query.min_bpm + 10;
+                query.format = TrackQuery::WAV_ONLY;
+                query.min_quality = 85.0;
+                query.order_by = TrackQuery::BY_QUALITY_DESC;
+                query.limit = 10;
+                break;
+            case 2:     // Shortest tracks around a length
+                query.min_duration = table.durations()[row];
+                query.max_duration = query.min_duration + 30;
+                query.order_by = TrackQuery::BY_DURATION;
+                query.limit = 20;
+                break;
+            case 3: {   // An artist's tracks by BPM
+                std::vector<std::string> artists = table.artists_of(row);
+                query.artist = artists.empty() ? std::string() : artists.front();
+                query.order_by = TrackQuery::BY_BPM;
+                break;
+            }
+            default:    // Good MP3s
+                query.format = TrackQuery::MP3_ONLY;
+                query.min_quality = static_cast<double>(50 + next_below(state, 51));
+                query.limit = 50;
+                break;
+        }
+        return query;
+    }
+
+    /**
+     * @brief Reference for DJLibraryService::queryTracks: test every row, then sort
+     */
+    std::vector<int> scan_query(const TrackMetadataTable& table, const TrackQuery& query) {
+        ColumnView<int> bpms = table.bpms();
+        ColumnView<int> durations = table.durations();
+        ColumnView<uint8_t> formats = table.formats();
+        ColumnView<double> qualities = table.quality_scores();
+        std::vector<size_t> rows;
+        for (size_t row = 0; row < table.size(); ++row) {
+            if (table.is_removed(row)) continue;
+            if (query.min_bpm >= 0 && bpms[row] < query.min_bpm) continue;
+            if (query.max_bpm >= 0 && bpms[row] > query.max_bpm) continue;
+            if (query.min_duration >= 0 && durations[row] < query.min_duration) continue;
+            if (query.max_duration >= 0 && durations[row] > query.max_duration) continue;
+            if (query.format == TrackQuery::MP3_ONLY && formats[row] != TrackMetadataTable::FORMAT_MP3) continue;
+            if (query.format == TrackQuery::WAV_ONLY && formats[row] != TrackMetadataTable::FORMAT_WAV) continue;
+            if (query.min_quality >= 0.0 && qualities[row] < query.min_quality) continue;
+            if (!query.artist.empty()) {
+                std::vector<std::string> artists = table.artists_of(row);
+                if (std::find(artists.begin(), artists.end(), query.artist) == artists.end()) continue;
+            }
+            rows.push_back(row);
+        }
+        std::stable_sort(rows.begin(), rows.end(), [&](size_t a, size_t b) {
+            switch (query.order_by) {
+                case TrackQuery::BY_BPM:
+                    return bpms[a] < bpms[b];
+                case TrackQuery::BY_DURATION:
+                    return durations[a] < durations[b];
+                case TrackQuery::BY_QUALITY_DESC:
+                    return qualities[a] > qualities[b];
+                case TrackQuery::BY_ID:
+                    break;
+            }
+            return false;
+        });
+        if (query.limit > 0 && rows.size() > query.limit) {
+            rows.resize(query.limit);
+        }
+        std::vector<int> ids;
+        for (size_t row : rows) {
+            ids.push_back(static_cast<int>(row) + 1);
+        }
+        return ids;
+    }
+
+    /**
+     * @brief Artist names of every row as small integers, so the reference scan
+     * compares artists without building strings
+     */
+    class ArtistIds {
+    public:
+        explicit ArtistIds(const TrackMetadataTable& table) : ids(), rows() {
+            for (size_t row = 0; row < table.size(); ++row) {
+                set(row, table.artists_of(row));
+            }
+        }
+
+        void set(size_t row, const std::vector<std::string>& artists) {
+            if (row >= rows.size()) {
+                rows.resize(row + 1);
+            }
+            rows[row].clear();
+            for (const std::string& artist : artists) {
+                rows[row].push_back(ids.emplace(artist, static_cast<uint32_t>(ids.size())).first->second);
+            }
+        }
+
+        bool share(size_t a, size_t b) const {
+            for (uint32_t id : rows[a]) {
+                if (std::find(rows[b].begin(), rows[b].end(), id) != rows[b].end()) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+    private:
+        std::unordered_map<std::string, uint32_t> ids;
+        std::vector<std::vector<uint32_t>> rows;
+    };
+
+    /**
+     * @brief Reference for DJLibraryService::suggestNextTracks(id, k): score every live row
+     */
+    std::vector<TrackSuggestionIndex::Suggestion> scan_suggestions(const TrackMetadataTable& table,
+                                                                   const ArtistIds& artists, size_t query_row, size_t k) {
+        TrackSuggestionIndex::Weights weights;
+        const double scales[] = { weights.bpm, weights.quality, weights.duration };
+        ColumnView<int> bpms = table.bpms();
+        ColumnView<double> qualities = table.quality_scores();
+        ColumnView<int> durations = table.durations();
+        const double target[] = { static_cast<double>(bpms[query_row]), qualities[query_row],
+                                  static_cast<double>(durations[query_row]) };
+
+        std::vector<TrackSuggestionIndex::Suggestion> all;
+        all.reserve(table.size());
+        for (size_t row = 0; row < table.size(); ++row) {
+            if (row == query_row || table.is_removed(row)) continue;
+            const double coords[] = { static_cast<double>(bpms[row]), qualities[row], static_cast<double>(durations[row]) };
+            double total = 0.0;
+            for (size_t d = 0; d < 3; ++d) {
+                double diff = (coords[d] - target[d]) * scales[d];
+                total += diff * diff;
+            }
+            TrackSuggestionIndex::Suggestion suggestion = { static_cast<int>(row) + 1, std::sqrt(total) };
+            if (artists.share(row, query_row)) {
+                suggestion.distance -= weights.shared_artist_bonus;
+            }
+            all.push_back(suggestion);
+        }
+        size_t count = std::min(k, all.size());
+        std::partial_sort(all.begin(), all.begin() + count, all.end(),
+                          [](const TrackSuggestionIndex::Suggestion& a, const TrackSuggestionIndex::Suggestion& b) {
+                              return a.distance < b.distance || (a.distance == b.distance && a.track_id < b.track_id);
+                          });
+        all.resize(count);
+        return all;
+    }
+
+    bool same_suggestions(const std::vector<TrackSuggestionIndex::Suggestion>& a,
+                          const std::vector<TrackSuggestionIndex::Suggestion>& b) {
+        if (a.size() != b.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < a.size(); ++i) {
+            if (a[i].track_id != b[i].track_id || a[i].distance != b[i].distance) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief A live row picked at random (the table must have one)
+     */
+    size_t random_live_row(const TrackMetadataTable& table, uint64_t& state) {
+        size_t row;
+        do {
+            row = next_below(state, table.size());
+        } while (table.is_removed(row));
+        return row;
+    }
+
+    /**
+     * @brief Track data for an edit: a copy of a row with a shifted BPM and a new title
+     */
+    SessionConfig::TrackInfo edited_track(const TrackMetadataTable& table, size_t row, size_t edit, uint64_t& state) {
+        SessionConfig::TrackInfo track_info;
+        track_info.type = table.formats()[row] == TrackMetadataTable::FORMAT_MP3 ? "MP3" : "WAV";
+        track_info.title = "Benchmark Edit " + std::to_string(edit);
+        track_info.artists = table.artists_of(row);
+        track_info.duration_seconds = table.durations()[row];
+        track_info.bpm = table.bpms()[row] + static_cast<int>(next_below(state, 21)) - 10;
+        track_info.extra_param1 = table.rates()[row];
+        track_info.extra_param2 = table.depths()[row];
+        return track_info;
+    }
+
+    struct SuggestTimings {
+        double index_build_seconds;
+        double index_seconds;
+        double scan_seconds;
+        size_t mismatches;          // Before any edit
+        size_t edit_mismatches;     // While tracks are added, updated and removed
+    };
+
+    /**
+     * @brief Load a generated library, time suggestions through the index and the scan,
+     * then check them again after each of a series of edits
+     * @return false if the library cannot be loaded
+     * @note Run with std::cout discarded, like time_queries
+     */
+    bool time_suggestions(const std::string& config_path, size_t query_count, size_t k, uint64_t seed,
+                          SuggestTimings& timings) {
+        DJLibraryService library;
+        SessionConfig config;
+        if (!library.buildLibraryFromFile(config_path, config) || library.getMetadata().live_size() < 2) {
+            return false;
+        }
+        const TrackMetadataTable& table = library.getMetadata();
+        ArtistIds artists(table);
+
+        // The first suggestion builds the indexes
+        auto start = std::chrono::steady_clock::now();
+        library.suggestNextTracks(1, k);
+        timings.index_build_seconds = seconds_since(start);
+
+        uint64_t state = seed * 0x9E3779B97F4A7C15ULL + 1;
+        std::vector<size_t> rows;
+        for (size_t q = 0; q < query_count; ++q) {
+            rows.push_back(random_live_row(table, state));
+        }
+
+        std::vector<std::vector<TrackSuggestionIndex::Suggestion>> indexed(rows.size());
+        start = std::chrono::steady_clock::now();
+        for (size_t q = 0; q < rows.size(); ++q) {
+            indexed[q] = library.suggestNextTracks(static_cast<int>(rows[q]) + 1, k);
+        }
+        timings.index_seconds = seconds_since(start);
+
+        timings.mismatches = 0;
+        start = std::chrono::steady_clock::now();
+        for (size_t q = 0; q < rows.size(); ++q) {
+            timings.mismatches += same_suggestions(scan_suggestions(table, artists, rows[q], k), indexed[q]) ? 0 : 1;
+        }
+        timings.scan_seconds = seconds_since(start);
+
+        // Edits go through the indexes' incremental paths; each is followed by a check
+        timings.edit_mismatches = 0;
+        size_t edits = std::max<size_t>(1, query_count / 10);
+        for (size_t edit = 0; edit < edits; ++edit) {
+            size_t row = random_live_row(table, state);
+            switch (edit % 3) {
+                case 0: {
+                    SessionConfig::TrackInfo track_info = edited_track(table, row, edit, state);
+                    artists.set(static_cast<size_t>(library.addTrack(track_info) - 1), track_info.artists);
+                    break;
+                }
+                case 1: {
+                    SessionConfig::TrackInfo track_info = edited_track(table, random_live_row(table, state), edit, state);
+                    library.updateTrack(static_cast<int>(row) + 1, track_info);
+                    artists.set(row, track_info.artists);
+                    break;
+                }
+                default:
+                    if (table.live_size() > 2) {
+                        library.removeTrack(static_cast<int>(row) + 1);
+                    }
+                    break;
+            }
+            size_t query_row = random_live_row(table, state);
+            timings.edit_mismatches += same_suggestions(scan_suggestions(table, artists, query_row, k),
+                                                        library.suggestNextTracks(static_cast<int>(query_row) + 1, k))
+                                       ? 0 : 1;
+        }
+        return true;
+    }
+
+    struct ParseRun {
+        double seconds;
+        size_t track_count;
+        size_t playlist_count;
+    };
+
+    /**
+     * @brief Parse a config from its text (never its cache) with a handler that only counts
+     * @note Run with std::cout discarded: the parser reports what it found
+     */
+    bool time_parse(const std::string& config_path, unsigned threads, ParseRun& run) {
+        SessionConfig config;
+        size_t track_count = 0;
+        auto start = std::chrono::steady_clock::now();
+        bool parsed = SessionFileParser::parse_config_file(config_path, config,
+            [&track_count](std::vector<SessionConfig::TrackInfo>& batch) { track_count += batch.size(); },
+            1024, threads, false);
+        run.seconds = seconds_since(start);
+        run.track_count = track_count;
+        run.playlist_count = config.playlists.size();
+        return parsed;
+    }
+
+    /**
+     * @brief Fastest of several time_parse runs
+     */
+    bool best_parse(const std::string& config_path, unsigned threads, size_t repeat, ParseRun& best) {
+        for (size_t r = 0; r < repeat; ++r) {
+            ParseRun run;
+            bool parsed;
+            {
+                QuietOutput quiet;
+                parsed = time_parse(config_path, threads, run);
+            }
+            if (!parsed) {
+                std::cout << "[ERROR] Cannot parse the generated config" << std::endl;
+                return false;
+            }
+            if (r == 0 || run.seconds < best.seconds) {
+                best = run;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Everything a parse produces, for comparing thread counts
+     */
+    struct ParseOutput {
+        std::string log;                                    // Warnings (with line numbers) and summary
+        uint64_t track_hash;                                // Every track field, in handler order
+        std::map<std::string, std::vector<int>> playlists;
+
+        ParseOutput() : log(), track_hash(0), playlists() {}
+
+        bool operator==(const ParseOutput& other) const {
+            return log == other.log && track_hash == other.track_hash && playlists == other.playlists;
+        }
+    };
+
+    bool parse_output(const std::string& config_path, unsigned threads, ParseOutput& output) {
+        SessionConfig config;
+        std::string fields;
+        uint64_t& hash = output.track_hash;
+        bool parsed;
+        {
+            CapturedOutput captured;
+            parsed = SessionFileParser::parse_config_file(config_path, config,
+                [&fields, &hash](std::vector<SessionConfig::TrackInfo>& batch) {
+                    for (const SessionConfig::TrackInfo& track_info : batch) {
+                        fields = track_info.type + '\n' + track_info.title;
+                        for (const std::string& artist : track_info.artists) {
+                            fields += '\n' + artist;
+                        }
+                        fields += '\n' + std::to_string(track_info.duration_seconds) + ',' + std::to_string(track_info.bpm) +
+                                  ',' + std::to_string(track_info.extra_param1) + ',' + std::to_string(track_info.extra_param2);
+                        hash = hash * 1099511628211ULL ^ std::hash<std::string>()(fields);
+                    }
+                },
+                1024, threads, false);
+            output.log = captured.text();
+        }
+        output.playlists = config.playlists;
+        return parsed;
+    }
+
+    /**
+     * @brief Names of a directory's regular files ending in suffix, sorted
+     * @return false if the directory cannot be opened
+     */
+    bool list_files(const std::string& directory, const std::string& suffix, std::vector<std::string>& names) {
+        DIR* dir = opendir(directory.c_str());
+        if (dir == nullptr) {
+            return false;
+        }
+        while (dirent* entry = readdir(dir)) {
+            std::string name = entry->d_name;
+            if (name.size() > suffix.size() && name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0) {
+                names.push_back(name);
+            }
+        }
+        closedir(dir);
+        std::sort(names.begin(), names.end());
+        return true;
+    }
+
+    std::string join_ints(const std::vector<int>& values) {
+        std::string text;
+        for (size_t i = 0; i < values.size(); ++i) {
+            text += (i == 0 ? "" : ",") + std::to_string(values[i]);
+        }
+        return text;
+    }
+
+    /**
+     * @brief Parse one corpus config and check it against its #expect lines
+     * @return Number of expectations that failed (each reported), or 1 if the file cannot be read
+     */
+    size_t check_corpus_file(const std::string& path) {
+        std::ifstream file(path.c_str());
+        if (!file.is_open()) {
+            std::cout << "[ERROR] Cannot open corpus file: " << path << std::endl;
+            return 1;
+        }
+        std::vector<std::pair<std::string, std::string>> expectations;
+        std::string line;
+        while (std::getline(file, line)) {
+            if (!line.empty() && line[line.size() - 1] == '\r') {
+                line.erase(line.size() - 1);
+            }
+            size_t equals = line.find('=');
+            if (line.compare(0, std::strlen(EXPECT_PREFIX), EXPECT_PREFIX) == 0 && equals != std::string::npos) {
+                size_t name_start = std::strlen(EXPECT_PREFIX);
+                expectations.push_back(std::make_pair(line.substr(name_start, equals - name_start),
+                                                      line.substr(equals + 1)));
+            }
+        }
+
+        SessionConfig config;
+        std::vector<int> bpms;
+        std::vector<std::string> warnings;
+        {
+            CapturedOutput captured;
+            SessionFileParser::parse_config_file(path, config,
+                [&bpms](std::vector<SessionConfig::TrackInfo>& batch) {
+                    for (const SessionConfig::TrackInfo& track_info : batch) {
+                        bpms.push_back(track_info.bpm);
+                    }
+                },
+                1024, 1, false);
+            std::istringstream output(captured.text());
+            while (std::getline(output, line)) {
+                if (line.compare(0, 10, "[WARNING] ") == 0) {
+                    warnings.push_back(line.substr(10));
+                }
+            }
+        }
+
+        size_t failures = 0;
+        size_t next_warning = 0;     // Expected warnings appear in this order
+        for (const std::pair<std::string, std::string>& expectation : expectations) {
+            const std::string& name = expectation.first;
+            const std::string& expected = expectation.second;
+            std::string actual;
+            if (name == "tracks") {
+                actual = std::to_string(bpms.size());
+            } else if (name == "playlists") {
+                actual = std::to_string(config.playlists.size());
+            } else if (name == "warnings") {
+                actual = std::to_string(warnings.size());
+            } else if (name == "bpms") {
+                actual = join_ints(bpms);
+            } else if (name == "controller_cache_size") {
+                actual = std::to_string(config.controller_cache_size);
+            } else if (name == "cache_order_max_bpm_jump") {
+                actual = std::to_string(config.cache_order_max_bpm_jump);
+            } else if (name == "bpm_tolerance") {
+                actual = std::to_string(config.bpm_tolerance);
+            } else if (name == "default_crossfade_time") {
+                actual = std::to_string(config.default_crossfade_time);
+            } else if (name == "warning") {
+                while (next_warning < warnings.size() && warnings[next_warning] != expected) {
+                    next_warning++;
+                }
+                if (next_warning < warnings.size()) {
+                    next_warning++;
+                    continue;
+                }
+                actual = "(not printed after the previous expected warning)";
+            } else if (name.compare(0, 9, "playlist.") == 0) {
+                auto it = config.playlists.find(name.substr(9));
+                actual = it != config.playlists.end() ? join_ints(it->second) : "(no such playlist)";
+            } else {
+                actual = "(unknown expectation)";
+            }
+            if (actual != expected) {
+                std::cout << "[ERROR] " << path << ": expected " << name << "=" << expected << ", got " << actual
+                          << std::endl;
+                failures++;
+            }
+        }
+        return failures;
+    }
+
+    /**
+     * @brief Fastest of several parse_playlist_directory runs
+     * @param playlists Output of the last run
+     */
+    bool best_playlist_parse(const std::string& directory, unsigned threads, size_t repeat, double& best_seconds,
+                             std::vector<PlaylistData>& playlists) {
+        for (size_t r = 0; r < repeat; ++r) {
+            playlists.clear();
+            bool parsed;
+            auto start = std::chrono::steady_clock::now();
+            {
+                QuietOutput quiet;
+                parsed = SessionFileParser::parse_playlist_directory(directory, playlists, threads);
+            }
+            double seconds = seconds_since(start);
+            if (!parsed) {
+                std::cout << "[ERROR] Cannot open the generated playlists directory: " << directory << std::endl;
+                return false;
+            }
+            if (r == 0 || seconds < best_seconds) {
+                best_seconds = seconds;
+            }
+        }
+        return true;
+    }
+
+    bool same_playlist_tracks(const PlaylistData::PlaylistTrack& a, const PlaylistData::PlaylistTrack& b) {
+        return a.type == b.type && a.title == b.title && a.artist == b.artist &&
+               a.duration_seconds == b.duration_seconds && a.bpm == b.bpm &&
+               a.extra_param1 == b.extra_param1 && a.extra_param2 == b.extra_param2;
+    }
+
+    bool same_playlists(const std::vector<PlaylistData>& a, const std::vector<PlaylistData>& b) {
+        if (a.size() != b.size()) {
+            return false;
+        }
+        for (size_t p = 0; p < a.size(); ++p) {
+            if (a[p].name != b[p].name || a[p].comment != b[p].comment || a[p].tracks.size() != b[p].tracks.size()) {
+                return false;
+            }
+            for (size_t t = 0; t < a[p].tracks.size(); ++t) {
+                if (!same_playlist_tracks(a[p].tracks[t], b[p].tracks[t])) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    struct ResolveRun {
+        double seconds;
+        size_t added;           // Tracks appended to the library
+        size_t mismatches;      // Resolved IDs whose library title differs from the playlist line
+    };
+
+    /**
+     * @brief Time resolvePlaylistTracks, then check every resolved ID against its line's title
+     * @note Run with std::cout discarded
+     */
+    void time_resolve(DJLibraryService& library, const std::vector<PlaylistData>& playlists, ResolveRun& run) {
+        std::map<std::string, std::vector<int>> resolved;
+        auto start = std::chrono::steady_clock::now();
+        run.added = library.resolvePlaylistTracks(playlists, resolved);
+        run.seconds = seconds_since(start);
+
+        const TrackMetadataTable& table = library.getMetadata();
+        run.mismatches = 0;
+        for (const PlaylistData& playlist : playlists) {
+            const std::vector<int>& ids = resolved[playlist.name];
+            if (ids.size() != playlist.tracks.size()) {
+                run.mismatches += playlist.tracks.size();
+                continue;
+            }
+            for (size_t i = 0; i < ids.size(); ++i) {
+                size_t row = static_cast<size_t>(ids[i] - 1);
+                bool same = ids[i] >= 1 && row < table.size() && table.title(row) == playlist.tracks[i].title;
+                run.mismatches += same ? 0 : 1;
+            }
+        }
+    }
+
+    struct QueryTimings {
+        double index_build_seconds;
+        double index_seconds;
+        double scan_seconds;
+        size_t mismatches;
+    };
+
+    /**
+     * @brief Load a generated library and time a query batch through the index and the scan
+     * @return false if the library cannot be loaded
+     * @note Run with std::cout discarded: the services log while loading and shutting down
+     */
+    bool time_queries(const std::string& config_path, size_t query_count, uint64_t seed, QueryTimings& timings) {
+        DJLibraryService library;
+        SessionConfig config;
+        if (!library.buildLibraryFromFile(config_path, config)) {
+            return false;
+        }
+        const TrackMetadataTable& table = library.getMetadata();
+
+        // The first query builds the indexes
+        auto start = std::chrono::steady_clock::now();
+        library.queryTracks(TrackQuery());
+        timings.index_build_seconds = seconds_since(start);
+
+        uint64_t state = seed * 0x9E3779B97F4A7C15ULL + 1;
+        std::vector<TrackQuery> queries;
+        for (size_t q = 0; q < query_count; ++q) {
+            queries.push_back(random_query(table, state));
+        }
+
+        std::vector<std::vector<int>> indexed(queries.size());
+        start = std::chrono::steady_clock::now();
+        for (size_t q = 0; q < queries.size(); ++q) {
+            indexed[q] = library.queryTracks(queries[q]);
+        }
+        timings.index_seconds = seconds_since(start);
+
+        timings.mismatches = 0;
+        start = std::chrono::steady_clock::now();
+        for (size_t q = 0; q < queries.size(); ++q) {
+            timings.mismatches += (scan_query(table, queries[q]) != indexed[q]) ? 1 : 0;
+        }
+        timings.scan_seconds = seconds_since(start);
+        return true;
+    }
+
+    /**
+     * @brief Fastest of repeat calls of run, in seconds
+     */
+    template <typename Run>
+    double best_seconds(size_t repeat, Run run) {
+        double best = 0.0;
+        for (size_t r = 0; r < repeat; ++r) {
+            auto start = std::chrono::steady_clock::now();
+            run();
+            double seconds = seconds_since(start);
+            best = (r == 0) ? seconds : std::min(best, seconds);
+        }
+        return best;
+    }
+
+    std::vector<std::string> sorted_lines(const std::string& text) {
+        std::vector<std::string> lines;
+        std::istringstream stream(text);
+        std::string line;
+        while (std::getline(stream, line)) {
+            lines.push_back(line);
+        }
+        std::sort(lines.begin(), lines.end());
+        return lines;
+    }
+
+    struct StoreTimings {
+        double build_seconds;
+        double virtual_seconds[3];      // Score, analyze, prepare
+        double store_seconds[3];
+        bool same[3];
+    };
+
+    /**
+     * @brief Time the virtual loop and TrackStore's kernels over the same tracks and compare them
+     * @param tracks Library-owned tracks, in row order
+     * @note prepare runs print the tracks' log lines; they are captured for the comparison.
+     * The store prepares one partition after the other, so only the sorted lines must match.
+     */
+    void time_store(const std::vector<AudioTrack*>& tracks, size_t repeat, StoreTimings& timings) {
+        TrackStore store;
+        auto start = std::chrono::steady_clock::now();
+        store.assign(tracks);
+        timings.build_seconds = seconds_since(start);
+
+        std::vector<double> virtual_scores(tracks.size());
+        std::vector<double> store_scores;
+        timings.virtual_seconds[0] = best_seconds(repeat, [&]() {
+            for (size_t row = 0; row < tracks.size(); ++row) {
+                virtual_scores[row] = tracks[row]->get_quality_score();
+            }
+        });
+        timings.store_seconds[0] = best_seconds(repeat, [&]() { store_scores = store.score_all(); });
+        timings.same[0] = virtual_scores == store_scores;
+
+        std::vector<TrackStore::BeatgridAnalysis> virtual_analyses(tracks.size());
+        std::vector<TrackStore::BeatgridAnalysis> store_analyses;
+        timings.virtual_seconds[1] = best_seconds(repeat, [&]() {
+            for (size_t row = 0; row < tracks.size(); ++row) {
+                TrackStore::BeatgridAnalysis analysis = { tracks[row]->get_estimated_beats(),
+                                                          tracks[row]->get_precision_factor() };
+                virtual_analyses[row] = analysis;
+            }
+        });
+        timings.store_seconds[1] = best_seconds(repeat, [&]() { store_analyses = store.analyze_all(); });
+        timings.same[1] = store_analyses.size() == virtual_analyses.size();
+        for (size_t row = 0; timings.same[1] && row < store_analyses.size(); ++row) {
+            timings.same[1] = store_analyses[row].estimated_beats == virtual_analyses[row].estimated_beats &&
+                              store_analyses[row].precision_factor == virtual_analyses[row].precision_factor;
+        }
+
+        std::string virtual_log;
+        std::string store_log;
+        timings.virtual_seconds[2] = best_seconds(repeat, [&]() {
+            CapturedOutput captured;
+            for (AudioTrack* track : tracks) {
+                track->load();
+                track->analyze_beatgrid();
+            }
+            virtual_log = captured.text();
+        });
+        timings.store_seconds[2] = best_seconds(repeat, [&]() {
+            CapturedOutput captured;
+            store.prepare_all();
+            store_log = captured.text();
+        });
+        timings.same[2] = sorted_lines(virtual_log) == sorted_lines(store_log);
+    }
+}
+
+bool Benchmarks::run(const std::string& name, const std::vector<std::string>& options) {
+    Options parsed;
+    for (const std::string& option : options) {
+        if (!parse_option(option, parsed)) {
+            return false;
+        }
+    }
+    if (name == "query") {
+        return run_query_benchmark(parsed);
+    }
+    if (name == "suggest") {
+        return run_suggest_benchmark(parsed);
+    }
+    if (name == "parse") {
+        return run_parse_benchmark(parsed);
+    }
+    if (name == "malformed") {
+        return run_malformed_benchmark(parsed);
+    }
+    if (name == "playlists") {
+        return run_playlists_benchmark(parsed);
+    }
+    if (name == "store") {
+        return run_store_benchmark(parsed);
+    }
+    std::cerr << "[ERROR] Unknown benchmark: " << name
+              << " (expected query, suggest, parse, malformed, playlists or store)"
+              << std::endl;
+    return false;
+}
+
+bool Benchmarks::parse_option(const std::string& option, Options& options) {
+    size_t equals = option.find('=');
+    if (equals == std::string::npos) {
+        std::cerr << "[ERROR] Benchmark options are name=value: " << option << std::endl;
+        return false;
+    }
+    std::string name = option.substr(0, equals);
+    std::string value = option.substr(equals + 1);
+
+    bool valid = true;
+    size_t seed = 0;
+    if (name == "tracks") {
+        valid = parse_size(value, options.tracks);
+    } else if (name == "queries") {
+        valid = parse_size(value, options.queries) && options.queries > 0;
+    } else if (name == "k") {
+        valid = parse_size(value, options.k) && options.k > 0;
+    } else if (name == "threads") {
+        valid = parse_size(value, options.threads);
+    } else if (name == "malformed") {
+        // Same syntax as the generator's option
+        ConfigGenerator::Options generated;
+        if (!ConfigGenerator::parse_option(option, generated)) {
+            return false;
+        }
+        options.malformed_rate = generated.malformed_rate;
+    } else if (name == "files") {
+        valid = parse_size(value, options.files);
+    } else if (name == "corpus") {
+        options.corpus = value;
+    } else if (name == "repeat") {
+        valid = parse_size(value, options.repeat) && options.repeat > 0;
+    } else if (name == "seed") {
+        valid = parse_size(value, seed);
+        options.seed = seed;
+    } else {
+        std::cerr << "[ERROR] Unknown benchmark option: " << name << std::endl;
+        return false;
+    }
+
+    if (!valid) {
+        std::cerr << "[ERROR] Invalid benchmark option: " << option << std::endl;
+    }
+    return valid;
+}
+
+// ========== QUERY ==========
+
+bool Benchmarks::run_query_benchmark(const Options& options) {
+    size_t max_tracks = options.tracks != 0 ? options.tracks : DEFAULT_MAX_QUERY_TRACKS;
+    std::cout << "=== Query Benchmark: " << options.queries << " queries per library, up to "
+              << max_tracks << " tracks ===" << std::endl;
+    std::cout << std::setw(10) << "tracks" << std::setw(12) << "index ms" << std::setw(14) << "index us/q"
+              << std::setw(14) << "scan us/q" << std::setw(10) << "speedup" << std::endl;
+
+    ScratchWorkload workload;
+    bool agree = true;
+    for (size_t tracks : library_sizes(max_tracks)) {
+        ConfigGenerator::Options generated;
+        generated.track_count = tracks;
+        generated.playlist_count = 0;
+        generated.seed = options.seed;
+        if (!workload.generate(generated)) {
+            return false;
+        }
+
+        QueryTimings timings;
+        bool loaded;
+        {
+            QuietOutput quiet;
+            loaded = time_queries(workload.config_path(), options.queries, options.seed, timings);
+        }
+        if (!loaded) {
+            std::cout << "[ERROR] Cannot load the generated library of " << tracks << " tracks" << std::endl;
+            return false;
+        }
+
+        double per_query = 1e6 / static_cast<double>(options.queries);
+        std::cout << std::fixed << std::setw(10) << tracks << std::setprecision(1) << std::setw(12)
+                  << timings.index_build_seconds * 1e3 << std::setprecision(2) << std::setw(14)
+                  << timings.index_seconds * per_query << std::setw(14) << timings.scan_seconds * per_query
+                  << std::setprecision(1) << std::setw(9)
+                  << timings.scan_seconds / std::max(timings.index_seconds, 1e-9) << "x" << std::defaultfloat << std::endl;
+        if (timings.mismatches > 0) {
+            std::cout << "[ERROR] " << timings.mismatches << " of " << options.queries
+                      << " indexed queries differ from the scan" << std::endl;
+            agree = false;
+        }
+    }
+    return agree;
+}
+
+// ========== SUGGEST ==========
+
+bool Benchmarks::run_suggest_benchmark(const Options& options) {
+    size_t max_tracks = options.tracks != 0 ? options.tracks : DEFAULT_MAX_SUGGEST_TRACKS;
+    std::cout << "=== Suggestion Benchmark: " << options.queries << " queries of " << options.k
+              << " per library, up to " << max_tracks << " tracks ===" << std::endl;
+    std::cout << std::setw(10) << "tracks" << std::setw(12) << "index ms" << std::setw(14) << "index us/q"
+              << std::setw(14) << "scan us/q" << std::setw(10) << "speedup" << std::endl;
+
+    ScratchWorkload workload;
+    bool agree = true;
+    for (size_t tracks : library_sizes(max_tracks)) {
+        ConfigGenerator::Options generated;
+        generated.track_count = tracks;
+        generated.playlist_count = 0;
+        generated.seed = options.seed;
+        if (!workload.generate(generated)) {
+            return false;
+        }
+
+        SuggestTimings timings;
+        bool loaded;
+        {
+            QuietOutput quiet;
+            loaded = time_suggestions(workload.config_path(), options.queries, options.k, options.seed, timings);
+        }
+        if (!loaded) {
+            std::cout << "[ERROR] Cannot load the generated library of " << tracks << " tracks" << std::endl;
+            return false;
+        }
+
+        double per_query = 1e6 / static_cast<double>(options.queries);
+        std::cout << std::fixed << std::setw(10) << tracks << std::setprecision(1) << std::setw(12)
+                  << timings.index_build_seconds * 1e3 << std::setprecision(2) << std::setw(14)
+                  << timings.index_seconds * per_query << std::setw(14) << timings.scan_seconds * per_query
+                  << std::setprecision(1) << std::setw(9)
+                  << timings.scan_seconds / std::max(timings.index_seconds, 1e-9) << "x" << std::defaultfloat << std::endl;
+        if (timings.mismatches > 0 || timings.edit_mismatches > 0) {
+            std::cout << "[ERROR] " << timings.mismatches << " of " << options.queries << " suggestions and "
+                      << timings.edit_mismatches << " after edits differ from the scan" << std::endl;
+            agree = false;
+        }
+    }
+    return agree;
+}
+
+// ========== PARSE ==========
+
+bool Benchmarks::run_parse_benchmark(const Options& options) {
+    size_t tracks = options.tracks != 0 ? options.tracks : DEFAULT_PARSE_TRACKS;
+    unsigned max_threads = resolve_thread_count(static_cast<unsigned>(options.threads));
+    ScratchWorkload workload;
+    ConfigGenerator::Options generated;
+    generated.track_count = tracks;
+    generated.malformed_rate = PARSE_MALFORMED_RATE;
+    generated.seed = options.seed;
+    if (!workload.generate(generated)) {
+        return false;
+    }
+    struct stat info;
+    if (::stat(workload.config_path().c_str(), &info) != 0) {
+        std::cout << "[ERROR] Generated config is missing: " << workload.config_path() << std::endl;
+        return false;
+    }
+    double megabytes = static_cast<double>(info.st_size) / (1 << 20);
+    std::cout << "=== Parse Benchmark: " << tracks << " tracks, " << std::fixed << std::setprecision(1)
+              << megabytes << " MB, best of " << options.repeat << " ===" << std::defaultfloat << std::endl;
+
+    ParseRun sequential;
+    if (!best_parse(workload.config_path(), 1, options.repeat, sequential)) {
+        return false;
+    }
+    std::cout << std::fixed << std::setprecision(1) << "1 thread: " << sequential.seconds * 1e3 << " ms, "
+              << megabytes / sequential.seconds << " MB/s, " << std::setprecision(2)
+              << static_cast<double>(sequential.track_count) / sequential.seconds / 1e6 << "M tracks/s"
+              << std::defaultfloat << std::endl;
+    if (sequential.track_count != tracks || sequential.playlist_count != generated.playlist_count) {
+        std::cout << "[ERROR] Parsed " << sequential.track_count << " tracks and " << sequential.playlist_count
+                  << " playlists; generated " << tracks << " and " << generated.playlist_count << std::endl;
+        return false;
+    }
+
+    // Scaling: each thread count must reproduce the sequential parse exactly
+    ParseOutput reference;
+    if (!parse_output(workload.config_path(), 1, reference)) {
+        return false;
+    }
+    std::cout << std::setw(10) << "threads" << std::setw(12) << "ms" << std::setw(12) << "MB/s"
+              << std::setw(10) << "speedup" << std::setw(12) << "efficiency" << std::endl;
+    bool agree = true;
+    for (unsigned threads = 1; ; threads = std::min(threads * 2, max_threads)) {
+        ParseRun run = sequential;
+        if (threads > 1 && !best_parse(workload.config_path(), threads, options.repeat, run)) {
+            return false;
+        }
+        double speedup = sequential.seconds / run.seconds;
+        std::cout << std::fixed << std::setw(10) << threads << std::setprecision(1) << std::setw(12)
+                  << run.seconds * 1e3 << std::setw(12) << megabytes / run.seconds << std::setprecision(2)
+                  << std::setw(9) << speedup << "x" << std::setprecision(0) << std::setw(11)
+                  << 100.0 * speedup / threads << "%" << std::defaultfloat << std::endl;
+        if (threads > 1) {
+            ParseOutput output;
+            if (!parse_output(workload.config_path(), threads, output)) {
+                return false;
+            }
+            if (!(output == reference)) {
+                std::cout << "[ERROR] " << threads << " threads parse differently from 1 (tracks, playlists"
+                          << " or warnings)" << std::endl;
+                agree = false;
+            }
+        }
+        if (threads == max_threads) {
+            break;
+        }
+    }
+    return agree;
+}
+
+// ========== MALFORMED ==========
+
+bool Benchmarks::run_malformed_benchmark(const Options& options) {
+    std::vector<std::string> names;
+    if (!list_files(options.corpus, ".txt", names) || names.empty()) {
+        std::cout << "[ERROR] No corpus configs (*.txt) in " << options.corpus << std::endl;
+        return false;
+    }
+    std::cout << "=== Malformed Config Corpus: " << options.corpus << " ===" << std::endl;
+    size_t failures = 0;
+    for (const std::string& name : names) {
+        size_t file_failures = check_corpus_file(options.corpus + "/" + name);
+        std::cout << name << ": " << (file_failures == 0 ? "ok" : "FAILED") << std::endl;
+        failures += file_failures;
+    }
+
+    size_t tracks = options.tracks != 0 ? options.tracks : DEFAULT_MALFORMED_TRACKS;
+    std::cout << "=== Malformed Config Benchmark: " << tracks << " tracks, best of " << options.repeat
+              << " ===" << std::endl;
+    std::cout << std::setw(12) << "malformed" << std::setw(10) << "MB" << std::setw(12) << "ms"
+              << std::setw(12) << "MB/s" << std::endl;
+    ScratchWorkload workload;
+    const double rates[] = { 0.0, options.malformed_rate };
+    for (double rate : rates) {
+        ConfigGenerator::Options generated;
+        generated.track_count = tracks;
+        generated.malformed_rate = rate;
+        generated.seed = options.seed;
+        if (!workload.generate(generated)) {
+            return false;
+        }
+        struct stat info;
+        if (::stat(workload.config_path().c_str(), &info) != 0) {
+            std::cout << "[ERROR] Generated config is missing: " << workload.config_path() << std::endl;
+            return false;
+        }
+        double megabytes = static_cast<double>(info.st_size) / (1 << 20);
+
+        ParseRun best;
+        if (!best_parse(workload.config_path(), 1, options.repeat, best)) {
+            return false;
+        }
+        std::cout << std::fixed << std::setprecision(2) << std::setw(12) << rate << std::setprecision(1)
+                  << std::setw(10) << megabytes << std::setw(12) << best.seconds * 1e3 << std::setw(12)
+                  << megabytes / best.seconds << std::defaultfloat << std::endl;
+        // Every invalid line is rejected and every valid one kept
+        if (best.track_count != tracks) {
+            std::cout << "[ERROR] Parsed " << best.track_count << " of " << tracks << " valid tracks" << std::endl;
+            failures++;
+        }
+    }
+    return failures == 0;
+}
+
+// ========== PLAYLISTS ==========
+
+bool Benchmarks::run_playlists_benchmark(const Options& options) {
+    size_t files = options.files != 0 ? options.files : DEFAULT_PLAYLIST_FILES;
+    size_t tracks = options.tracks != 0 ? options.tracks : DEFAULT_PLAYLIST_TRACKS;
+    unsigned max_threads = resolve_thread_count(static_cast<unsigned>(options.threads));
+    ScratchWorkload workload;
+    ConfigGenerator::Options generated;
+    generated.track_count = tracks;
+    generated.playlist_count = 0;
+    generated.playlist_file_count = files;
+    generated.seed = options.seed;
+    if (!workload.generate(generated)) {
+        return false;
+    }
+    std::vector<std::string> names;
+    list_files(workload.playlist_directory(), ".playlist", names);
+    off_t bytes = 0;
+    for (const std::string& name : names) {
+        struct stat info;
+        if (::stat((workload.playlist_directory() + "/" + name).c_str(), &info) == 0) {
+            bytes += info.st_size;
+        }
+    }
+    double megabytes = static_cast<double>(bytes) / (1 << 20);
+    std::cout << "=== Playlist Directory Benchmark: " << files << " files of " << tracks << " tracks, " << std::fixed
+              << std::setprecision(1) << megabytes << " MB, best of " << options.repeat << " ===" << std::defaultfloat
+              << std::endl;
+
+    // Scaling: each thread count must reproduce the sequential parse exactly
+    double sequential = 0.0;
+    std::vector<PlaylistData> reference;
+    if (!best_playlist_parse(workload.playlist_directory(), 1, options.repeat, sequential, reference)) {
+        return false;
+    }
+    size_t line_count = 0;
+    for (const PlaylistData& playlist : reference) {
+        line_count += playlist.tracks.size();
+    }
+    if (reference.size() != files) {
+        std::cout << "[ERROR] Parsed " << reference.size() << " playlists; generated " << files << std::endl;
+        return false;
+    }
+    std::cout << std::setw(10) << "threads" << std::setw(12) << "ms" << std::setw(12) << "files/s"
+              << std::setw(12) << "MB/s" << std::setw(10) << "speedup" << std::setw(12) << "efficiency" << std::endl;
+    bool agree = true;
+    for (unsigned threads = 1; ; threads = std::min(threads * 2, max_threads)) {
+        double seconds = sequential;
+        if (threads > 1) {
+            std::vector<PlaylistData> playlists;
+            if (!best_playlist_parse(workload.playlist_directory(), threads, options.repeat, seconds, playlists)) {
+                return false;
+            }
+            if (!same_playlists(playlists, reference)) {
+                std::cout << "[ERROR] " << threads << " threads parse the playlists differently from 1" << std::endl;
+                agree = false;
+            }
+        }
+        double speedup = sequential / seconds;
+        std::cout << std::fixed << std::setw(10) << threads << std::setprecision(1) << std::setw(12)
+                  << seconds * 1e3 << std::setprecision(0) << std::setw(12) << static_cast<double>(files) / seconds
+                  << std::setprecision(1) << std::setw(12) << megabytes / seconds << std::setprecision(2)
+                  << std::setw(9) << speedup << "x" << std::setprecision(0) << std::setw(11)
+                  << 100.0 * speedup / threads << "%" << std::defaultfloat << std::endl;
+        if (threads == max_threads) {
+            break;
+        }
+    }
+
+    // Resolving titles: into the generated library (every title known) and into an empty one (every title new)
+    std::cout << std::setw(10) << "library" << std::setw(12) << "ms" << std::setw(12) << "lines"
+              << std::setw(12) << "added" << std::endl;
+    for (int empty = 0; empty <= 1; ++empty) {
+        ResolveRun run;
+        bool loaded = true;
+        {
+            QuietOutput quiet;
+            DJLibraryService library;
+            SessionConfig config;
+            if (!empty) {
+                loaded = library.buildLibraryFromFile(workload.config_path(), config);
+            }
+            if (loaded) {
+                time_resolve(library, reference, run);
+            }
+        }
+        if (!loaded) {
+            std::cout << "[ERROR] Cannot load the generated library of " << tracks << " tracks" << std::endl;
+            return false;
+        }
+        std::cout << std::fixed << std::setw(10) << (empty ? "empty" : "generated") << std::setprecision(1)
+                  << std::setw(12) << run.seconds * 1e3 << std::setw(12) << line_count << std::setw(12)
+                  << run.added << std::defaultfloat << std::endl;
+        if (run.mismatches > 0) {
+            std::cout << "[ERROR] " << run.mismatches << " of " << line_count
+                      << " resolved IDs name a different title" << std::endl;
+            agree = false;
+        }
+    }
+    return agree;
+}
+
+// ========== STORE ==========
+
+bool Benchmarks::run_store_benchmark(const Options& options) {
+    size_t max_tracks = options.tracks != 0 ? options.tracks : DEFAULT_MAX_STORE_TRACKS;
+    std::cout << "=== Track Store Benchmark: every library track, up to " << max_tracks << " tracks, best of "
+              << options.repeat << " ===" << std::endl;
+    std::cout << std::setw(10) << "tracks" << std::setw(10) << "kernel" << std::setw(12) << "build ms"
+              << std::setw(12) << "virtual ms" << std::setw(12) << "store ms" << std::setw(10) << "speedup" << std::endl;
+    const char* const kernels[] = { "score", "analyze", "prepare" };
+
+    ScratchWorkload workload;
+    bool agree = true;
+    for (size_t tracks : library_sizes(max_tracks)) {
+        ConfigGenerator::Options generated;
+        generated.track_count = tracks;
+        generated.playlist_count = 0;
+        generated.seed = options.seed;
+        if (!workload.generate(generated)) {
+            return false;
+        }
+
+        // The tracks a session would hold after loading a playlist of the whole library
+        StoreTimings timings;
+        bool loaded;
+        {
+            QuietOutput quiet;
+            DJLibraryService library;
+            SessionConfig config;
+            loaded = library.buildLibraryFromFile(workload.config_path(), config);
+            if (loaded) {
+                std::vector<int> ids(tracks);
+                std::iota(ids.begin(), ids.end(), 1);
+                library.loadPlaylistFromIndices("store", ids);
+                std::vector<AudioTrack*> playlist_tracks = library.getPlaylist().getTracks();
+                loaded = playlist_tracks.size() == tracks;
+                if (loaded) {
+                    time_store(playlist_tracks, options.repeat, timings);
+                }
+            }
+        }
+        if (!loaded) {
+            std::cout << "[ERROR] Cannot load the generated library of " << tracks << " tracks" << std::endl;
+            return false;
+        }
+
+        for (size_t kernel = 0; kernel < 3; ++kernel) {
+            std::cout << std::fixed << std::setw(10) << tracks << std::setw(10) << kernels[kernel]
+                      << std::setprecision(2) << std::setw(12) << timings.build_seconds * 1e3 << std::setw(12)
+                      << timings.virtual_seconds[kernel] * 1e3 << std::setw(12) << timings.store_seconds[kernel] * 1e3
+                      << std::setprecision(1) << std::setw(9)
+                      << timings.virtual_seconds[kernel] / std::max(timings.store_seconds[kernel], 1e-9) << "x"
+                      << std::defaultfloat << std::endl;
+            if (!timings.same[kernel]) {
+                std::cout << "[ERROR] " << kernels[kernel] << " differs between TrackStore and the virtual loop for "
+                          << tracks << " tracks" << std::endl;
+                agree = false;
+            }
+        }
+    }
+    return agree;
+}
@@ -0,0 +1,373 @@
+#include "ConfigCache.h"
+#include "MappedFile.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+static_assert(sizeof(int) == sizeof(int32_t), "cached integers are stored as int32");
+
+namespace {
+    const char MAGIC[8] = { 'D', 'J', 'C', 'F', 'G', 'C', 'A', 'C' };
+    const uint64_t HASH_SEED = 14695981039346656037ULL;
+    const uint64_t HASH_MULTIPLIER = 0x9E3779B97F4A7C15ULL;
+
+    // Record tags
+    const uint8_t TRACK_RECORD = 0;
+    const uint8_t WARNING_RECORD = 1;
+
+    template<typename T>
+    void put(std::string& out, T value) {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void put_string(std::string& out, const std::string& str) {
+        put(out, static_cast<uint32_t>(str.size()));
+        out.append(str);
+    }
+
+    /**
+     * @brief Bounds-checked cursor over a cache payload
+     */
+    class PayloadReader {
+    public:
+        PayloadReader(const char* data, size_t size) : cursor(data), end(data + size) {}
+        PayloadReader(const PayloadReader&) = delete;
+        PayloadReader& operator=(const PayloadReader&) = delete;
+
+        template<typename T>
+        bool read(T& value) {
+            if (remaining() < sizeof(value)) {
+                return false;
+            }
+            std::memcpy(&value, cursor, sizeof(value));
+            cursor += sizeof(value);
+            return true;
+        }
+
+        bool read_string(std::string& str) {
+            uint32_t length;
+            if (!read(length) || remaining() < length) {
+                return false;
+            }
+            str.assign(cursor, length);
+            cursor += length;
+            return true;
+        }
+
+        /**
+         * @brief Read a count, rejecting one that cannot fit in what is left
+         * (so a corrupt count never triggers a huge allocation)
+         */
+        bool read_count(uint32_t& count, size_t min_element_size) {
+            return read(count) && count <= remaining() / min_element_size;
+        }
+
+        size_t remaining() const { return static_cast<size_t>(end - cursor); }
+
+    private:
+        const char* cursor;
+        const char* end;
+    };
+
+    bool read_track(PayloadReader& reader, SessionConfig::TrackInfo& track_info) {
+        uint32_t artist_count;
+        if (!reader.read_string(track_info.type) || !reader.read_string(track_info.title) ||
+            !reader.read_count(artist_count, sizeof(uint32_t))) {
+            return false;
+        }
+        track_info.artists.resize(artist_count);
+        for (std::string& artist : track_info.artists) {
+            if (!reader.read_string(artist)) {
+                return false;
+            }
+        }
+        return reader.read(track_info.duration_seconds) && reader.read(track_info.bpm) &&
+               reader.read(track_info.extra_param1) && reader.read(track_info.extra_param2);
+    }
+
+    /**
+     * @brief Decode the settings section; false if it does not decode exactly to its end
+     */
+    bool read_settings(PayloadReader& reader, uint64_t playlist_count, SessionConfig& settings) {
+        int32_t auto_sync = 0;
+        int32_t crossfade_curve = 0;
+        if (!reader.read_string(settings.app_name) || !reader.read_string(settings.version) ||
+            !reader.read_string(settings.playlists_directory) || !reader.read(settings.controller_cache_size) ||
+            !reader.read(settings.cache_order_max_bpm_jump) || !reader.read(settings.default_crossfade_time) ||
+            !reader.read(crossfade_curve) || !reader.read(settings.bpm_tolerance) || !reader.read(auto_sync)) {
+            return false;
+        }
+        settings.crossfade_curve = crossfade_curve == static_cast<int32_t>(CrossfadeCurve::LINEAR)
+                                       ? CrossfadeCurve::LINEAR : CrossfadeCurve::EQUAL_POWER;
+        settings.auto_sync = auto_sync != 0;
+
+        uint32_t tuning_count;
+        if (!reader.read_count(tuning_count, 2 * sizeof(uint32_t))) {
+            return false;
+        }
+        std::string name, value;
+        for (uint32_t t = 0; t < tuning_count; ++t) {
+            if (!reader.read_string(name) || !reader.read_string(value)) {
+                return false;
+            }
+            settings.tuning[name] = value;
+        }
+
+        for (uint64_t p = 0; p < playlist_count; ++p) {
+            uint32_t id_count;
+            if (!reader.read_string(name) || !reader.read_count(id_count, sizeof(int32_t))) {
+                return false;
+            }
+            std::vector<int>& ids = settings.playlists[name];
+            ids.resize(id_count);
+            for (int& id : ids) {
+                reader.read(id);    // Fits: checked by read_count
+            }
+        }
+        return reader.remaining() == 0;
+    }
+}
+
+ConfigCache::WordHasher::WordHasher() : hash(HASH_SEED), total(0), pending(), pending_size(0) {}
+
+void ConfigCache::WordHasher::update(const char* data, size_t size) {
+    total += size;
+    if (pending_size > 0) {
+        size_t take = std::min(size, sizeof(pending) - pending_size);
+        std::memcpy(pending + pending_size, data, take);
+        pending_size += take;
+        data += take;
+        size -= take;
+        if (pending_size < sizeof(pending)) {
+            return;
+        }
+        mix(pending);
+        pending_size = 0;
+    }
+    size_t i = 0;
+    for (; i + sizeof(pending) <= size; i += sizeof(pending)) {
+        mix(data + i);
+    }
+    if (i < size) {
+        std::memcpy(pending, data + i, size - i);
+        pending_size = size - i;
+    }
+}
+
+uint64_t ConfigCache::WordHasher::finish() {
+    char last[sizeof(pending)] = { 0 };
+    std::memcpy(last, pending, pending_size);
+    mix(last);
+    hash = (hash ^ total) * HASH_MULTIPLIER;
+    return hash ^ (hash >> 32);
+}
+
+void ConfigCache::WordHasher::mix(const char* bytes) {
+    uint64_t word;
+    std::memcpy(&word, bytes, sizeof(word));
+    hash = (hash ^ word) * HASH_MULTIPLIER;
+    hash ^= hash >> 29;
+}
+
+uint64_t ConfigCache::hash_contents(const char* data, size_t size) {
+    WordHasher hasher;
+    hasher.update(data, size);
+    return hasher.finish();
+}
+
+ConfigCache::LoadResult ConfigCache::replay(const std::string& cache_path, uint64_t content_hash, uint64_t content_size,
+                                            size_t batch_size, const SessionFileParser::TrackBatchHandler& on_tracks,
+                                            SessionConfig& settings, unsigned& assigned_settings, size_t& track_count) {
+    MappedFile file;
+    if (!file.open(cache_path) || file.size() < sizeof(Header)) {
+        return LoadResult::MISSING;
+    }
+    Header header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != FORMAT_VERSION ||
+        header.header_size != sizeof(Header) || header.content_hash != content_hash ||
+        header.content_size != content_size || header.payload_size != file.size() - sizeof(Header)) {
+        return LoadResult::MISSING;
+    }
+    const char* payload = file.data() + sizeof(Header);
+    size_t payload_size = file.size() - sizeof(Header);
+    if (hash_contents(payload, payload_size) != header.payload_checksum) {
+        std::cout << "[WARNING] Config cache failed its checksum; parsing instead: " << cache_path << std::endl;
+        return LoadResult::MISSING;
+    }
+    if (header.settings_offset > payload_size) {
+        return LoadResult::CORRUPT;
+    }
+    size_t records_size = static_cast<size_t>(header.settings_offset);
+    PayloadReader settings_reader(payload + records_size, payload_size - records_size);
+    if (!read_settings(settings_reader, header.playlist_count, settings)) {
+        return LoadResult::CORRUPT;
+    }
+
+    // Check every record before handing any over; the scratch strings only grow to the longest one
+    uint64_t tracks_seen = 0;
+    uint64_t warnings_seen = 0;
+    {
+        PayloadReader reader(payload, records_size);
+        SessionConfig::TrackInfo scratch_track;
+        std::string scratch_text;
+        uint8_t tag;
+        while (reader.read(tag)) {
+            if (tag == TRACK_RECORD && read_track(reader, scratch_track)) {
+                tracks_seen++;
+            } else if (tag == WARNING_RECORD && reader.read_string(scratch_text)) {
+                warnings_seen++;
+            } else {
+                return LoadResult::CORRUPT;
+            }
+        }
+    }
+    if (tracks_seen != header.track_count || warnings_seen != header.warning_count) {
+        return LoadResult::CORRUPT;
+    }
+
+    // Decode one batch at a time, refilling the entries the handler was given
+    file.advise_sequential();
+    PayloadReader reader(payload, records_size);
+    std::vector<SessionConfig::TrackInfo> batch;
+    std::string text;
+    size_t filled = 0;
+    uint8_t tag;
+    while (reader.read(tag)) {
+        if (tag == WARNING_RECORD) {
+            reader.read_string(text);
+            std::cout << text << std::endl;
+            continue;
+        }
+        if (filled == batch.size()) {
+            batch.emplace_back();
+        }
+        read_track(reader, batch[filled++]);
+        if (filled == batch_size) {
+            batch.resize(filled);
+            on_tracks(batch);
+            filled = 0;
+        }
+    }
+    if (filled > 0) {
+        batch.resize(filled);
+        on_tracks(batch);
+    }
+
+    track_count = static_cast<size_t>(tracks_seen);
+    assigned_settings = header.assigned_settings;
+    return LoadResult::LOADED;
+}
+
+ConfigCache::ConfigCache(const std::string& cache_path, uint64_t content_hash, uint64_t content_size)
+    : cache_path(cache_path), temp_path(cache_path + ".tmp"), out(), checksum(), record(),
+      content_hash(content_hash), content_size(content_size), payload_size(0), track_count(0), warning_count(0) {
+    // Written next to the target and renamed, so a reader never maps a half-written file;
+    // the header is filled in once the counts and checksum are known
+    out.open(temp_path.c_str(), std::ios::binary | std::ios::trunc);
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+ConfigCache::~ConfigCache() {
+    if (out.is_open()) {
+        out.close();
+        std::remove(temp_path.c_str());
+    }
+}
+
+void ConfigCache::append(const std::string& bytes) {
+    out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    checksum.update(bytes.data(), bytes.size());
+    payload_size += bytes.size();
+}
+
+void ConfigCache::add_tracks(const std::vector<SessionConfig::TrackInfo>& batch) {
+    if (!out.is_open()) {
+        return;
+    }
+    for (const SessionConfig::TrackInfo& track_info : batch) {
+        record.clear();
+        put(record, TRACK_RECORD);
+        put_string(record, track_info.type);
+        put_string(record, track_info.title);
+        put(record, static_cast<uint32_t>(track_info.artists.size()));
+        for (const std::string& artist : track_info.artists) {
+            put_string(record, artist);
+        }
+        put(record, static_cast<int32_t>(track_info.duration_seconds));
+        put(record, static_cast<int32_t>(track_info.bpm));
+        put(record, static_cast<int32_t>(track_info.extra_param1));
+        put(record, static_cast<int32_t>(track_info.extra_param2));
+        append(record);
+    }
+    track_count += batch.size();
+}
+
+void ConfigCache::add_warning(const std::string& text) {
+    if (!out.is_open()) {
+        return;
+    }
+    record.clear();
+    put(record, WARNING_RECORD);
+    put_string(record, text);
+    append(record);
+    warning_count++;
+}
+
+bool ConfigCache::write(const SessionConfig& settings, unsigned assigned_settings) {
+    if (!out.is_open()) {
+        std::cout << "[WARNING] Cannot create config cache: " << temp_path << std::endl;
+        return false;
+    }
+    uint64_t settings_offset = payload_size;
+    record.clear();
+    put_string(record, settings.app_name);
+    put_string(record, settings.version);
+    put_string(record, settings.playlists_directory);
+    put(record, static_cast<int32_t>(settings.controller_cache_size));
+    put(record, static_cast<int32_t>(settings.cache_order_max_bpm_jump));
+    put(record, static_cast<int32_t>(settings.default_crossfade_time));
+    put(record, static_cast<int32_t>(settings.crossfade_curve));
+    put(record, static_cast<int32_t>(settings.bpm_tolerance));
+    put(record, static_cast<int32_t>(settings.auto_sync ? 1 : 0));
+    put(record, static_cast<uint32_t>(settings.tuning.size()));
+    for (const auto& entry : settings.tuning) {
+        put_string(record, entry.first);
+        put_string(record, entry.second);
+    }
+    for (const auto& pair : settings.playlists) {
+        put_string(record, pair.first);
+        put(record, static_cast<uint32_t>(pair.second.size()));
+        for (int id : pair.second) {
+            put(record, static_cast<int32_t>(id));
+        }
+    }
+    append(record);
+
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = FORMAT_VERSION;
+    header.header_size = sizeof(Header);
+    header.content_hash = content_hash;
+    header.content_size = content_size;
+    header.payload_size = payload_size;
+    header.payload_checksum = checksum.finish();
+    header.settings_offset = settings_offset;
+    header.track_count = track_count;
+    header.warning_count = warning_count;
+    header.playlist_count = settings.playlists.size();
+    header.assigned_settings = assigned_settings;
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.close();
+    if (!out || std::rename(temp_path.c_str(), cache_path.c_str()) != 0) {
+        std::cout << "[WARNING] Failed to write config cache: " << cache_path << std::endl;
+        std::remove(temp_path.c_str());
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,433 @@
+#include "ConfigGenerator.h"
+#include "IntegerParsing.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <sys/stat.h>
+
+namespace {
+    const uint64_t GOLDEN_GAMMA = 0x9E3779B97F4A7C15ULL;
+    const double PI = 3.14159265358979323846;
+    // Output is handed to the file in blocks of about this size
+    const size_t WRITE_BLOCK_BYTES = 1 << 20;
+    // Artist names are shared: about this many tracks per artist
+    const size_t TRACKS_PER_ARTIST = 8;
+    const char* const TITLE_WORDS[] = {
+        "Night", "Drive", "Echo", "Sunrise", "Pulse", "Horizon", "Velvet", "Static",
+        "Ocean", "Neon", "Shadow", "Gravity", "Signal", "Drift", "Ember", "Mirage"
+    };
+
+    // SplitMix64: small, fast and good enough for synthetic data
+    uint64_t next_random(uint64_t& state) {
+        uint64_t z = (state += GOLDEN_GAMMA);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    // Uniform in [0, 1)
+    double next_unit(uint64_t& state) {
+        return static_cast<double>(next_random(state) >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    // Uniform in [min, max]
+    size_t next_in(uint64_t& state, size_t min, size_t max) {
+        return min + static_cast<size_t>(next_random(state) % (max - min + 1));
+    }
+
+    // Standard normal (Box-Muller)
+    double next_normal(uint64_t& state) {
+        double u1 = 1.0 - next_unit(state);     // In (0, 1], so the log is finite
+        double u2 = next_unit(state);
+        return std::sqrt(-2.0 * std::log(u1)) * std::cos(2.0 * PI * u2);
+    }
+
+    bool parse_rate(const std::string& text, double& value) {
+        if (text.empty()) {
+            return false;
+        }
+        char* end = nullptr;
+        errno = 0;
+        double parsed = std::strtod(text.c_str(), &end);
+        if (errno != 0 || *end != '\0' || !(parsed >= 0.0) || std::isinf(parsed)) {
+            return false;
+        }
+        value = parsed;
+        return true;
+    }
+
+    // "<min>:<max>" with min <= max
+    bool parse_range(const std::string& text, size_t& min, size_t& max) {
+        size_t colon = text.find(':');
+        return colon != std::string::npos && parse_size(text.substr(0, colon), min) &&
+               parse_size(text.substr(colon + 1), max) && min <= max;
+    }
+
+    // Like mkdir -p
+    bool make_directories(const std::string& path) {
+        for (size_t slash = path.find('/', 1); ; slash = path.find('/', slash + 1)) {
+            std::string prefix = path.substr(0, slash);
+            if (::mkdir(prefix.c_str(), 0755) != 0 && errno != EEXIST) {
+                return false;
+            }
+            if (slash == std::string::npos) {
+                return true;
+            }
+        }
+    }
+
+    ConfigGenerator::Options normalized(ConfigGenerator::Options options) {
+        options.min_playlist_length = std::max<size_t>(options.min_playlist_length, 1);
+        options.max_playlist_length = std::max(options.max_playlist_length, options.min_playlist_length);
+        options.max_title_length = std::max(options.max_title_length, options.min_title_length);
+        options.max_artists = std::max<size_t>(options.max_artists, 1);
+        if (options.track_count == 0) {
+            options.playlist_count = 0;
+            options.playlist_file_count = 0;
+        }
+        return options;
+    }
+
+    /**
+     * @brief Buffers output and hands it to a file a block at a time
+     */
+    class BlockWriter {
+    public:
+        explicit BlockWriter(const std::string& path) : out(path.c_str(), std::ios::binary | std::ios::trunc), buffer() {
+            buffer.reserve(WRITE_BLOCK_BYTES + 4096);
+        }
+
+        bool is_open() const { return out.is_open(); }
+        std::string& line_buffer() { return buffer; }
+
+        void flush_if_full() {
+            if (buffer.size() >= WRITE_BLOCK_BYTES) {
+                flush();
+            }
+        }
+
+        bool finish() {
+            flush();
+            out.close();
+            return !out.fail();
+        }
+
+    private:
+        std::ofstream out;
+        std::string buffer;
+
+        void flush() {
+            out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            buffer.clear();
+        }
+    };
+
+    // log1p(x) / x, accurate near 0
+    double log1p_over_x(double x) {
+        return std::fabs(x) > 1e-8 ? std::log1p(x) / x : 1.0 - x * (0.5 - x * (1.0 / 3.0 - 0.25 * x));
+    }
+
+    // expm1(x) / x, accurate near 0
+    double expm1_over_x(double x) {
+        return std::fabs(x) > 1e-8 ? std::expm1(x) / x : 1.0 + x * 0.5 * (1.0 + x / 3.0 * (1.0 + 0.25 * x));
+    }
+}
+
+// ========== ZIPF SAMPLER ==========
+
+ConfigGenerator::ZipfSampler::ZipfSampler(size_t n, double exponent)
+    : exponent(exponent), n(static_cast<double>(std::max<size_t>(n, 1))), h_integral_x1(0.0), h_integral_n(0.0),
+      squeeze(0.0) {
+    h_integral_x1 = h_integral(1.5) - 1.0;
+    h_integral_n = h_integral(this->n + 0.5);
+    squeeze = 2.0 - h_integral_inverse(h_integral(2.5) - h(2.0));
+}
+
+size_t ConfigGenerator::ZipfSampler::draw(uint64_t& random_state) const {
+    // Invert the integral of the hat function 1/x^s, then accept the rounded
+    // rank if it falls under the real (step) weight; most draws are accepted
+    for (;;) {
+        double u = h_integral_n + next_unit(random_state) * (h_integral_x1 - h_integral_n);
+        double x = h_integral_inverse(u);
+        double k = std::min(std::max(std::floor(x + 0.5), 1.0), n);
+        if (k - x <= squeeze || u >= h_integral(k + 0.5) - h(k)) {
+            return static_cast<size_t>(k);
+        }
+    }
+}
+
+double ConfigGenerator::ZipfSampler::h(double x) const {
+    return std::exp(-exponent * std::log(x));
+}
+
+double ConfigGenerator::ZipfSampler::h_integral(double x) const {
+    // (x^(1-s) - 1) / (1-s), continuous at s = 1 (log x)
+    double log_x = std::log(x);
+    return expm1_over_x((1.0 - exponent) * log_x) * log_x;
+}
+
+double ConfigGenerator::ZipfSampler::h_integral_inverse(double x) const {
+    double t = std::max(x * (1.0 - exponent), -1.0);
+    return std::exp(log1p_over_x(t) * x);
+}
+
+// ========== GENERATOR ==========
+
+bool ConfigGenerator::parse_option(const std::string& option, Options& options) {
+    size_t equals = option.find('=');
+    if (equals == std::string::npos) {
+        std::cerr << "[ERROR] Generator options are name=value: " << option << std::endl;
+        return false;
+    }
+    std::string name = option.substr(0, equals);
+    std::string value = option.substr(equals + 1);
+
+    bool valid = true;
+    size_t seed = 0;
+    if (name == "tracks") {
+        valid = parse_size(value, options.track_count);
+    } else if (name == "playlists") {
+        valid = parse_size(value, options.playlist_count);
+    } else if (name == "playlist_files") {
+        valid = parse_size(value, options.playlist_file_count);
+    } else if (name == "playlist_length") {
+        valid = parse_range(value, options.min_playlist_length, options.max_playlist_length);
+    } else if (name == "length_distribution") {
+        if (value == "uniform") {
+            options.length_distribution = LengthDistribution::UNIFORM;
+        } else if (value == "normal") {
+            options.length_distribution = LengthDistribution::NORMAL;
+        } else if (value == "zipf") {
+            options.length_distribution = LengthDistribution::ZIPF;
+        } else {
+            valid = false;
+        }
+    } else if (name == "zipf") {
+        valid = parse_rate(value, options.zipf_exponent);
+    } else if (name == "title_length") {
+        valid = parse_range(value, options.min_title_length, options.max_title_length);
+    } else if (name == "max_artists") {
+        valid = parse_size(value, options.max_artists);
+    } else if (name == "malformed") {
+        valid = parse_rate(value, options.malformed_rate);
+    } else if (name == "seed") {
+        valid = parse_size(value, seed);
+        options.seed = seed;
+    } else {
+        std::cerr << "[ERROR] Unknown generator option: " << name << std::endl;
+        return false;
+    }
+
+    if (!valid) {
+        std::cerr << "[ERROR] Invalid generator option: " << option << std::endl;
+    }
+    return valid;
+}
+
+ConfigGenerator::ConfigGenerator(const Options& requested)
+    : options(normalized(requested)),
+      random_state(options.seed),
+      popularity(options.track_count),
+      track_ranks(options.track_count, options.zipf_exponent),
+      length_ranks(options.max_playlist_length - options.min_playlist_length + 1, 1.0) {
+    // Popularity ranks are shuffled, so the most reused tracks are spread through the library
+    std::iota(popularity.begin(), popularity.end(), 0u);
+    for (size_t i = popularity.size(); i > 1; --i) {
+        std::swap(popularity[i - 1], popularity[static_cast<size_t>(next_random(random_state) % i)]);
+    }
+}
+
+bool ConfigGenerator::generate(const std::string& directory) {
+    const std::string config_directory = directory + "/bin";
+    if (!make_directories(config_directory)) {
+        std::cerr << "[ERROR] Cannot create directory: " << config_directory << std::endl;
+        return false;
+    }
+    const std::string config_path = config_directory + "/dj_config.txt";
+    if (!write_config(config_path)) {
+        return false;
+    }
+    std::cout << "Generated " << config_path << ": " << options.track_count << " tracks, "
+              << options.playlist_count << " playlists" << std::endl;
+
+    if (options.playlist_file_count > 0) {
+        const std::string playlist_directory = directory + "/playlists";
+        if (!make_directories(playlist_directory)) {
+            std::cerr << "[ERROR] Cannot create directory: " << playlist_directory << std::endl;
+            return false;
+        }
+        char file_name[64];
+        for (size_t number = 1; number <= options.playlist_file_count; ++number) {
+            std::snprintf(file_name, sizeof(file_name), "/generated_mix_%05zu.playlist", number);
+            if (!write_playlist_file(playlist_directory + file_name, number)) {
+                return false;
+            }
+        }
+        std::cout << "Generated " << options.playlist_file_count << " playlist files in "
+                  << playlist_directory << std::endl;
+    }
+    return true;
+}
+
+bool ConfigGenerator::write_config(const std::string& path) {
+    BlockWriter writer(path);
+    if (!writer.is_open()) {
+        std::cerr << "[ERROR] Cannot create config file: " << path << std::endl;
+        return false;
+    }
+    std::string& out = writer.line_buffer();
+    out += "# Synthetic DJ session config\n";
+    out += "# tracks=" + std::to_string(options.track_count) + " playlists=" + std::to_string(options.playlist_count) +
+           " seed=" + std::to_string(options.seed) + "\n";
+    out += "app_name=Synthetic DJ Library\n";
+    out += "version=2.0\n";
+    out += "controller_cache_size=8\n";
+    out += "bpm_tolerance=10\n";
+    out += "auto_sync=true\n\n";
+
+    for (size_t track = 0; track < options.track_count; ++track) {
+        out += "library_track_" + std::to_string(track + 1) + "=";
+        append_track_fields(out, track, true);
+        out += '\n';
+
+        // Invalid lines sit between valid ones, so playlist indices are not shifted
+        double malformed = options.malformed_rate;
+        while (malformed > 0.0 && next_unit(random_state) < malformed) {
+            out += "library_track_" + std::to_string(track + 1) + "_bad=MP3,Broken Track,{Nobody;},abc,120,320,1\n";
+            malformed -= 1.0;
+        }
+        writer.flush_if_full();
+    }
+
+    out += '\n';
+    for (size_t playlist = 1; playlist <= options.playlist_count; ++playlist) {
+        out += "synthetic_set_" + std::to_string(playlist) + "=";
+        size_t length = draw_playlist_length();
+        for (size_t i = 0; i < length; ++i) {
+            if (i > 0) {
+                out += ',';
+            }
+            out += std::to_string(draw_track() + 1);
+        }
+        out += '\n';
+        writer.flush_if_full();
+    }
+
+    if (!writer.finish()) {
+        std::cerr << "[ERROR] Failed to write config file: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool ConfigGenerator::write_playlist_file(const std::string& path, size_t number) {
+    BlockWriter writer(path);
+    if (!writer.is_open()) {
+        std::cerr << "[ERROR] Cannot create playlist file: " << path << std::endl;
+        return false;
+    }
+    std::string& out = writer.line_buffer();
+    out += "# Synthetic mix " + std::to_string(number) + "\n";
+    size_t length = draw_playlist_length();
+    for (size_t i = 0; i < length; ++i) {
+        append_track_fields(out, draw_track(), false);
+        out += '\n';
+        writer.flush_if_full();
+    }
+    if (!writer.finish()) {
+        std::cerr << "[ERROR] Failed to write playlist file: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+size_t ConfigGenerator::draw_playlist_length() {
+    size_t min = options.min_playlist_length;
+    size_t max = options.max_playlist_length;
+    switch (options.length_distribution) {
+        case LengthDistribution::NORMAL: {
+            double mean = (static_cast<double>(min) + static_cast<double>(max)) / 2.0;
+            double deviation = (static_cast<double>(max) - static_cast<double>(min)) / 6.0;
+            double length = std::floor(mean + deviation * next_normal(random_state) + 0.5);
+            return static_cast<size_t>(std::min(std::max(length, static_cast<double>(min)), static_cast<double>(max)));
+        }
+        case LengthDistribution::ZIPF:
+            return min + length_ranks.draw(random_state) - 1;
+        case LengthDistribution::UNIFORM:
+            break;
+    }
+    return next_in(random_state, min, max);
+}
+
+size_t ConfigGenerator::draw_track() {
+    return popularity[track_ranks.draw(random_state) - 1];
+}
+
+void ConfigGenerator::append_track_fields(std::string& line, size_t track, bool artist_list) const {
+    // Each track has its own stream, so its fields do not depend on what was drawn
+    // before. The start is hashed: SplitMix64 streams started a multiple of the
+    // gamma apart would just be shifted copies of each other
+    uint64_t key = options.seed + (track + 1) * GOLDEN_GAMMA;
+    uint64_t state = next_random(key);
+    bool mp3 = next_random(state) % 2 == 0;
+    line += mp3 ? "MP3," : "WAV,";
+
+    // Titles are unique ("Track <n>") and padded with words to the drawn length
+    size_t title_start = line.size();
+    size_t title_length = next_in(state, options.min_title_length, options.max_title_length);
+    line += "Track " + std::to_string(track + 1);
+    const size_t word_count = sizeof(TITLE_WORDS) / sizeof(TITLE_WORDS[0]);
+    while (line.size() - title_start < title_length) {
+        line += ' ';
+        line += TITLE_WORDS[next_random(state) % word_count];
+    }
+    size_t prefix_end = title_start + 6 + std::to_string(track + 1).size();
+    line.resize(std::max(title_start + title_length, prefix_end));
+    while (line.back() == ' ') {
+        line.pop_back();
+    }
+    line += ',';
+
+    // Distinct artists; every one is drawn either way, so the later fields come out the same
+    size_t artist_pool = std::max<size_t>(options.track_count / TRACKS_PER_ARTIST, 1);
+    size_t artist_count = std::min(next_in(state, 1, options.max_artists), artist_pool);
+    std::vector<size_t> artists;
+    while (artists.size() < artist_count) {
+        size_t artist = next_random(state) % artist_pool + 1;
+        if (std::find(artists.begin(), artists.end(), artist) == artists.end()) {
+            artists.push_back(artist);
+        }
+    }
+    if (artist_list) {
+        line += '{';
+        for (size_t artist : artists) {
+            line += "Artist " + std::to_string(artist) + ";";
+        }
+        line += '}';
+    } else {
+        line += "Artist " + std::to_string(artists[0]);     // A .playlist line names one artist
+    }
+
+    int duration = static_cast<int>(next_in(state, 120, 600));
+    double bpm = std::floor(124.0 + 12.0 * next_normal(state) + 0.5);
+    bpm = std::min(std::max(bpm, 70.0), 180.0);
+    line += ',' + std::to_string(duration) + ',' + std::to_string(static_cast<int>(bpm)) + ',';
+    // One draw per statement: the order of draws within an expression is unspecified
+    if (mp3) {
+        static const int BITRATES[] = { 128, 192, 256, 320 };
+        int bitrate = BITRATES[next_random(state) % 4];
+        bool has_tags = next_random(state) % 10 != 0;
+        line += std::to_string(bitrate) + (has_tags ? ",1" : ",0");
+    } else {
+        static const int SAMPLE_RATES[] = { 44100, 48000, 96000 };
+        static const int BIT_DEPTHS[] = { 16, 24 };
+        int sample_rate = SAMPLE_RATES[next_random(state) % 3];
+        int bit_depth = BIT_DEPTHS[next_random(state) % 2];
+        line += std::to_string(sample_rate) + ',' + std::to_string(bit_depth);
+    }
+}
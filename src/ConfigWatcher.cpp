@@ -0,0 +1,74 @@
+#include "ConfigWatcher.h"
+#include <cerrno>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+ConfigWatcher::ConfigWatcher() : inotify_fd(-1), watch_descriptor(-1), file_name() {}
+
+ConfigWatcher::~ConfigWatcher() {
+    stop();
+}
+
+bool ConfigWatcher::watch(const std::string& path) {
+    stop();
+
+    size_t last_slash = path.find_last_of('/');
+    std::string directory = (last_slash == std::string::npos) ? "." : path.substr(0, last_slash + 1);
+    file_name = (last_slash == std::string::npos) ? path : path.substr(last_slash + 1);
+
+    inotify_fd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_fd < 0) {
+        return false;
+    }
+    // Saves in place end with IN_CLOSE_WRITE; saves by rename end with IN_MOVED_TO.
+    // IN_MODIFY is not watched: the file may still be half written
+    watch_descriptor = ::inotify_add_watch(inotify_fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+    if (watch_descriptor < 0) {
+        stop();
+        return false;
+    }
+    return true;
+}
+
+void ConfigWatcher::stop() {
+    if (inotify_fd >= 0) {
+        ::close(inotify_fd);
+    }
+    inotify_fd = -1;
+    watch_descriptor = -1;
+}
+
+bool ConfigWatcher::poll() {
+    if (inotify_fd < 0) {
+        return false;
+    }
+
+    bool changed = false;
+    // Aligned for struct inotify_event; large enough for many events per read
+    alignas(struct inotify_event) char events[4096];
+    for (;;) {
+        ssize_t length = ::read(inotify_fd, events, sizeof(events));
+        if (length < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;      // EAGAIN: no more events
+        }
+        if (length == 0) {
+            break;
+        }
+        for (ssize_t offset = 0; offset < length; ) {
+            const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>(events + offset);
+            if (event->mask & IN_Q_OVERFLOW) {
+                changed = true;     // Events were lost; assume the worst
+            } else if (event->mask & IN_IGNORED) {
+                stop();             // The directory itself went away
+                return changed;
+            } else if (event->len > 0 && file_name == event->name) {
+                changed = true;
+            }
+            offset += static_cast<ssize_t>(sizeof(struct inotify_event) + event->len);
+        }
+    }
+    return changed;
+}
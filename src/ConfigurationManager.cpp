@@ -1,12 +1,73 @@
 #include "ConfigurationManager.h"
+#include "IntegerParsing.h"
+#include <cctype>
 #include <fstream>
 #include <sstream>
 #include <iostream>
 
+namespace {
+    enum class TunableType {
+        COUNT,      // Integer in [min_value, max_value]
+        FLAG        // true/false, stored as 1/0
+    };
+
+    struct TunableInfo {
+        const char* name;
+        TunableType type;
+        int default_value;
+        int min_value;
+        int max_value;
+        const char* description;
+    };
+
+    const int MAX_THREADS = 1024;
+
+    // One row per ConfigurationManager::Tunable, in the same order
+    const TunableInfo TUNABLES[] = {
+        { "parse_threads", TunableType::COUNT, 0, 0, MAX_THREADS,
+          "threads parsing the config and .playlist files (0 = one per hardware thread)" },
+        { "parse_batch_size", TunableType::COUNT, 1024, 1, 1 << 20,
+          "library tracks the parser hands over at a time" },
+        { "build_threads", TunableType::COUNT, 0, 0, MAX_THREADS,
+          "threads materializing a loaded playlist's tracks (0 = one per hardware thread)" },
+        { "optimizer_threads", TunableType::COUNT, 0, 0, MAX_THREADS,
+          "threads searching for a BPM-optimized order (0 = one per hardware thread)" },
+        { "print_settings", TunableType::FLAG, 0, 0, 1,
+          "print the effective settings after each (re)load" },
+        { "suggest_next", TunableType::COUNT, 0, 0, 100,
+          "library tracks suggested to follow each newly loaded deck (0 = off)" },
+        { "playlist_analysis", TunableType::FLAG, 0, 0, 1,
+          "print quality and beat-grid totals of each loaded playlist" }
+    };
+    static_assert(sizeof(TUNABLES) / sizeof(TUNABLES[0]) ==
+                  static_cast<size_t>(ConfigurationManager::Tunable::COUNT),
+                  "every Tunable needs a TUNABLES row");
+
+    const TunableInfo& info_of(ConfigurationManager::Tunable knob) {
+        return TUNABLES[static_cast<size_t>(knob)];
+    }
+
+    bool equals_ignore_case(const std::string& text, const char* word) {
+        size_t i = 0;
+        for (; i < text.size() && word[i] != '\0'; ++i) {
+            if (std::tolower(static_cast<unsigned char>(text[i])) != word[i]) {
+                return false;
+            }
+        }
+        return i == text.size() && word[i] == '\0';
+    }
+}
+
+const char* const ConfigurationManager::TUNING_PREFIX = "tuning.";
+
 ConfigurationManager::ConfigurationManager() :
     cache_size(8),
     bpm_tolerance(10),
-    auto_sync(true), additional_settings() {
+    auto_sync(true), additional_settings(),
+    tuning_values(), tuning_hooks(static_cast<size_t>(Tunable::COUNT)) {
+    for (const TunableInfo& info : TUNABLES) {
+        tuning_values.push_back(info.default_value);
+    }
 }
 
 bool ConfigurationManager::loadFromFile(const std::string& config_path) {
@@ -15,39 +76,52 @@ bool ConfigurationManager::loadFromFile(const std::string& config_path) {
         std::cerr << "[ERROR] Could not open config file: " << config_path << std::endl;
         return false;
     }
-    
+
+    const std::string prefix = TUNING_PREFIX;
+    std::map<std::string, std::string> tuning;
     std::string line;
     while (std::getline(file, line)) {
         // Skip comments and empty lines
         if (line.empty() || line[0] == '#') {
             continue;
         }
-        
+
         // Parse key=value pairs
         size_t pos = line.find('=');
         if (pos == std::string::npos) {
             continue;
         }
-        
+
         std::string key = line.substr(0, pos);
         std::string value = line.substr(pos + 1);
-        
-        // Parse known configuration keys
+
+        // Parse known configuration keys (a bad number keeps the current value)
         if (key == "cache_size") {
-            cache_size = std::stoi(value);
+            parseIntSetting(key, value, cache_size);
         } else if (key == "bpm_tolerance") {
-            bpm_tolerance = std::stoi(value);
+            parseIntSetting(key, value, bpm_tolerance);
         } else if (key == "auto_sync") {
             auto_sync = (value == "true");
+        } else if (key.compare(0, prefix.size(), prefix) == 0) {
+            tuning[key.substr(prefix.size())] = value;
         } else {
             // Store unknown settings for extensibility
             additional_settings[key] = value;
         }
     }
-    
+
+    applyTuning(tuning);
     return true;
 }
 
+void ConfigurationManager::parseIntSetting(const std::string& key, const std::string& value, int& setting) {
+    IntegerParseError error = parse_leading_integer(value.data(), value.data() + value.size(), setting);
+    if (error != IntegerParseError::NONE) {
+        std::cerr << "[WARNING] Invalid " << key << " '" << value << "' (" << integer_parse_error_text(error)
+                  << "), keeping " << setting << std::endl;
+    }
+}
+
 std::string ConfigurationManager::getSetting(const std::string& key) const {
     auto it = additional_settings.find(key);
     return (it != additional_settings.end()) ? it->second : "";
@@ -58,12 +132,113 @@ void ConfigurationManager::displayConfiguration() const {
     std::cout << "Cache Size: " << cache_size << " slots" << std::endl;
     std::cout << "BPM Tolerance: " << bpm_tolerance << " BPM" << std::endl;
     std::cout << "Auto Sync: " << (auto_sync ? "enabled" : "disabled") << std::endl;
-    
+
     if (!additional_settings.empty()) {
         std::cout << "Additional Settings:" << std::endl;
         for (const auto& setting : additional_settings) {
             std::cout << "  " << setting.first << ": " << setting.second << std::endl;
         }
     }
+    std::cout << "Tuning:" << std::endl;
+    printTuning(std::cout);
     std::cout << std::endl;
-}
\ No newline at end of file
+}
+
+// ========== TUNING REGISTRY ==========
+
+bool ConfigurationManager::applyTuning(const std::map<std::string, std::string>& entries) {
+    std::vector<int> values;
+    for (const TunableInfo& info : TUNABLES) {
+        values.push_back(info.default_value);
+    }
+
+    bool all_valid = true;
+    for (const auto& entry : entries) {
+        size_t index = 0;
+        while (index < values.size() && entry.first != TUNABLES[index].name) {
+            ++index;
+        }
+        if (index == values.size()) {
+            std::cout << "[WARNING] Unknown tuning key '" << TUNING_PREFIX << entry.first << "'" << std::endl;
+            all_valid = false;
+            continue;
+        }
+        values[index] = tuning_values[index];
+        if (!parseTuningValue(static_cast<Tunable>(index), entry.second, values[index])) {
+            all_valid = false;
+        }
+    }
+
+    // Hooks see the whole new state, whichever knob they watch
+    std::vector<int> previous = tuning_values;
+    tuning_values = values;
+    for (size_t index = 0; index < values.size(); ++index) {
+        if (values[index] == previous[index]) {
+            continue;
+        }
+        for (const TuningHook& hook : tuning_hooks[index]) {
+            hook(static_cast<Tunable>(index), values[index]);
+        }
+    }
+    return all_valid;
+}
+
+bool ConfigurationManager::parseTuningValue(Tunable knob, const std::string& text, int& value) {
+    const TunableInfo& info = info_of(knob);
+    if (info.type == TunableType::FLAG) {
+        if (equals_ignore_case(text, "true") || text == "1" || equals_ignore_case(text, "yes")) {
+            value = 1;
+            return true;
+        }
+        if (equals_ignore_case(text, "false") || text == "0" || equals_ignore_case(text, "no")) {
+            value = 0;
+            return true;
+        }
+        std::cout << "[WARNING] Invalid " << TUNING_PREFIX << info.name << " '" << text
+                  << "' (expected true or false), keeping " << (value ? "true" : "false") << std::endl;
+        return false;
+    }
+
+    int parsed = 0;
+    IntegerParseResult result = parse_integer(text.data(), text.data() + text.size(), parsed);
+    IntegerParseError error = result.error;
+    if (error == IntegerParseError::NONE && result.ptr != text.data() + text.size()) {
+        error = IntegerParseError::INVALID_ARGUMENT;
+    }
+    if (error != IntegerParseError::NONE) {
+        std::cout << "[WARNING] Invalid " << TUNING_PREFIX << info.name << " '" << text << "' ("
+                  << integer_parse_error_text(error) << "), keeping " << value << std::endl;
+        return false;
+    }
+    if (parsed < info.min_value || parsed > info.max_value) {
+        std::cout << "[WARNING] " << TUNING_PREFIX << info.name << "=" << parsed << " is outside "
+                  << info.min_value << ".." << info.max_value << ", keeping " << value << std::endl;
+        return false;
+    }
+    value = parsed;
+    return true;
+}
+
+void ConfigurationManager::onTuningChange(Tunable knob, const TuningHook& hook) {
+    tuning_hooks[static_cast<size_t>(knob)].push_back(hook);
+}
+
+const char* ConfigurationManager::tuningName(Tunable knob) {
+    return info_of(knob).name;
+}
+
+std::string ConfigurationManager::tuningText(Tunable knob, int value) {
+    if (info_of(knob).type == TunableType::FLAG) {
+        return value ? "true" : "false";
+    }
+    return std::to_string(value);
+}
+
+void ConfigurationManager::printTuning(std::ostream& out) const {
+    for (size_t index = 0; index < tuning_values.size(); ++index) {
+        const TunableInfo& info = TUNABLES[index];
+        Tunable knob = static_cast<Tunable>(index);
+        out << "# " << info.description << "; default " << tuningText(knob, info.default_value) << "\n"
+            << TUNING_PREFIX << info.name << "=" << tuningText(knob, tuning_values[index]) << "\n";
+    }
+}
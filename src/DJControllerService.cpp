@@ -52,4 +52,8 @@ void DJControllerService::displayCacheStatus() const {
 AudioTrack* DJControllerService::getTrackFromCache(const std::string& track_title) {
     AudioTrack* ptr = cache.get(track_title);
     return ptr;
+}
+
+bool DJControllerService::removeTrackFromCache(const std::string& track_title) {
+    return cache.remove(track_title);
 }
\ No newline at end of file
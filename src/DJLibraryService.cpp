@@ -1,40 +1,52 @@
 #include "DJLibraryService.h"
 #include "SessionFileParser.h"
-#include "MP3Track.h"
-#include "WAVTrack.h"
+#include "ParallelFor.h"
+#include "LibrarySnapshot.h"
 #include <iostream>
 #include <memory>
+#include <unordered_map>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
 #include <filesystem>
 
+namespace {
+    const size_t NO_ITEM = static_cast<size_t>(-1);
+}
+
 
 DJLibraryService::DJLibraryService(const Playlist& playlist) 
-    : playlist(playlist) , library() {}
+    : playlist(playlist) , metadata(), library(), title_index(), query_index(), suggestion_index(),
+      title_index_ready(false), query_index_ready(false), suggestion_index_ready(false), build_threads(0) {}
+
+DJLibraryService::DJLibraryService()
+    : playlist(), metadata(), library(), title_index(), query_index(), suggestion_index(),
+      title_index_ready(false), query_index_ready(false), suggestion_index_ready(false), build_threads(0) {}
 
 // =========================================================
 // Rule of 3 Implementation for Playlist
 // =========================================================
 // Destructor
 DJLibraryService::~DJLibraryService() {
-    // Iterate over the vector and delete each track to prevent memory leaks
-    for (AudioTrack* track : library) {
-        delete track;
-    }
-    library.clear();
+    clear_library();
+    title_index.clear();
 }
 
 // Copy Constructor
 DJLibraryService::DJLibraryService(const DJLibraryService& other) 
-    : playlist(other.playlist) // Copy the playlist object
+    : playlist(other.playlist), // Copy the playlist object
+      metadata(),
+      library(),
+      title_index(),
+      query_index(),
+      suggestion_index(),
+      title_index_ready(false),
+      query_index_ready(false),
+      suggestion_index_ready(false),
+      build_threads(other.build_threads)
 {
-    // Deep copy the track library
-    for (const AudioTrack* source_track : other.library) {
-        if (source_track != nullptr) {
-            // 1. Clone the track (polymorphic copy) - returns PointerWrapper
-            // 2. Release ownership from wrapper to get the raw pointer
-            // 3. Add to our new library vector
-            library.push_back(source_track->clone().release());
-        }
-    }
+    copy_library_from(other);
 }
 
 // Copy Assignment Operator
@@ -45,53 +57,442 @@ DJLibraryService& DJLibraryService::operator=(const DJLibraryService& other) {
     }
 
     // 2. Clean up existing resources (same logic as destructor)
-    for (AudioTrack* track : library) {
-        delete track;
-    }
-    library.clear();
+    clear_library();
 
     // 3. Copy the playlist
     playlist = other.playlist;
+    build_threads = other.build_threads;
 
     // 4. Deep copy the library (same logic as Copy Constructor)
-    for (const AudioTrack* source_track : other.library) {
+    copy_library_from(other);
+
+    return *this;
+}
+
+void DJLibraryService::copy_library_from(const DJLibraryService& other) {
+    metadata = other.metadata;
+    title_index = other.title_index;
+    query_index = other.query_index;
+    suggestion_index = other.suggestion_index;
+    title_index_ready = other.title_index_ready;
+    query_index_ready = other.query_index_ready;
+    suggestion_index_ready = other.suggestion_index_ready;
+
+    // Deep copy the tracks that exist; the rest stay lazy in the copy too
+    library.assign(other.library.size(), nullptr);
+    std::unordered_map<const AudioTrack*, AudioTrack*> copies;
+    for (size_t row = 0; row < other.library.size(); ++row) {
+        const AudioTrack* source_track = other.library[row];
         if (source_track != nullptr) {
-            // Clone and extract raw pointer
-            library.push_back(source_track->clone().release());
+            // 1. Clone the track (polymorphic copy) - returns PointerWrapper
+            // 2. Release ownership from wrapper to get the raw pointer
+            library[row] = source_track->clone().release();
+            copies[source_track] = library[row];
         }
     }
+    // The playlist borrows library tracks: point it at our copies, not other's
+    playlist.remap_tracks(copies);
+}
 
-    return *this;
+void DJLibraryService::clear_library() {
+    // Iterate over the vector and delete each track to prevent memory leaks
+    for (AudioTrack* track : library) {
+        delete track;
+    }
+    library.clear();
 }
 
 /**
- * @brief Load a playlist from track indices referencing the library
+ * @brief Build the track library from parsed config data
  * @param library_tracks Vector of track info from config
  */
 void DJLibraryService::buildLibrary(const std::vector<SessionConfig::TrackInfo>& library_tracks) {
-    //Todo: Implement buildLibrary method
-    std::cout << "TODO: Implement DJLibraryService::buildLibrary method\n"<< library_tracks.size() << " tracks to be loaded into library.\n";
-    // Check the format field (“MP3” or “WAV”)
-    for (size_t i = 0; i < library_tracks.size(); ++i) { //MP3
-        if (library_tracks[i].type == "MP3" || library_tracks[i].type == "mp3") {
-            // Create appropriate track type using the provided metadata
-            AudioTrack* track = new MP3Track (library_tracks[i].title, library_tracks[i].artists, library_tracks[i].duration_seconds, library_tracks[i].bpm, library_tracks[i].extra_param1, library_tracks[i].extra_param2);
-            // Store the raw pointer in the library vector
-            library.push_back(track);
-            // Log creation message
-            std::cout << "[MP3Track created:] " << library_tracks[i].extra_param1 << " kbps" << std::endl;
+    std::cout << "[INFO] Building track library from config..." << std::endl;
+
+    metadata.reserve(metadata.size() + library_tracks.size());
+    appendTracks(library_tracks);
+
+    // Log summary
+    std::cout << "[INFO] Track library built: " << metadata.size() << " tracks loaded" << std::endl;
+}
+
+bool DJLibraryService::buildLibraryFromFile(const std::string& config_path, SessionConfig& config,
+                                            size_t batch_size, unsigned thread_count) {
+    std::cout << "[INFO] Building track library from config..." << std::endl;
+
+    bool parsed = SessionFileParser::parse_config_file(config_path, config,
+        [this](std::vector<SessionConfig::TrackInfo>& batch) { appendTracks(batch); }, batch_size, thread_count);
+    if (!parsed) {
+        return false;
+    }
+
+    // Log summary
+    std::cout << "[INFO] Track library built: " << metadata.size() << " tracks loaded" << std::endl;
+    return true;
+}
+
+void DJLibraryService::appendTracks(const std::vector<SessionConfig::TrackInfo>& tracks) {
+    for (const SessionConfig::TrackInfo& track_info : tracks) {
+        metadata.append(track_info);
+    }
+    // No track objects yet; each row is materialized on first use
+    library.resize(metadata.size(), nullptr);
+    invalidate_indexes();
+}
+
+void DJLibraryService::attachSnapshot(const std::shared_ptr<const LibrarySnapshot>& snapshot) {
+    clear_library();
+    metadata.attach(snapshot);
+    library.assign(metadata.size(), nullptr);
+    invalidate_indexes();
+    std::cout << "[INFO] Track library mapped from snapshot: " << metadata.size() << " tracks" << std::endl;
+}
+
+void DJLibraryService::invalidate_indexes() {
+    title_index_ready = false;
+    query_index_ready = false;
+    suggestion_index_ready = false;
+}
+
+void DJLibraryService::ensure_query_index() const {
+    if (!query_index_ready) {
+        query_index.build(metadata);
+        query_index_ready = true;
+    }
+}
+
+void DJLibraryService::ensure_suggestion_index() const {
+    if (!suggestion_index_ready) {
+        suggestion_index.build(metadata);
+        suggestion_index_ready = true;
+    }
+}
+
+void DJLibraryService::ensure_title_index() const {
+    if (title_index_ready) {
+        return;
+    }
+    title_index.clear();
+    title_index.reserve(metadata.live_size());
+    for (size_t row = 0; row < metadata.size(); ++row) {
+        if (!metadata.is_removed(row)) {
+            title_index.emplace(metadata.title(row), row);
         }
-        else { //WAV
-            // Create appropriate track type using the provided metadata
-            AudioTrack* track = new WAVTrack (library_tracks[i].title, library_tracks[i].artists, library_tracks[i].duration_seconds, library_tracks[i].bpm, library_tracks[i].extra_param1, library_tracks[i].extra_param2);
-            // Store the raw pointer in the library vector
-            library.push_back(track);
-            // Log creation message
-            std::cout << "[WAVTrack created:] " << library_tracks[i].extra_param1 << "Hz/" << library_tracks[i].extra_param2 << "bit" << std::endl;
+    }
+    title_index_ready = true;
+}
+
+size_t DJLibraryService::first_row_with_title(const std::string& title) const {
+    ensure_title_index();
+    // With repeated titles the first library entry wins
+    size_t first = NO_ITEM;
+    auto range = title_index.equal_range(title);
+    for (auto it = range.first; it != range.second; ++it) {
+        first = std::min(first, it->second);
+    }
+    return first;
+}
+
+bool DJLibraryService::is_track_id(int track_id) const {
+    return track_id >= 1 && static_cast<size_t>(track_id) <= metadata.size() &&
+           !metadata.is_removed(static_cast<size_t>(track_id - 1));
+}
+
+void DJLibraryService::index_row(size_t row) {
+    if (title_index_ready) {
+        title_index.emplace(metadata.title(row), row);
+    }
+    if (query_index_ready) {
+        query_index.insert(metadata, row);
+    }
+    if (suggestion_index_ready) {
+        suggestion_index.insert(metadata, row);
+    }
+}
+
+void DJLibraryService::unindex_row(size_t row) {
+    if (title_index_ready) {
+        auto range = title_index.equal_range(metadata.title(row));
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second == row) {
+                title_index.erase(it);
+                break;
+            }
         }
     }
-    // Log summary
-    std::cout << "[INFO] Track library built: " << library.size() << " tracks loaded" << std::endl;
+    if (query_index_ready) {
+        query_index.erase(metadata, row);
+    }
+    if (suggestion_index_ready) {
+        suggestion_index.erase(metadata, row);
+    }
+}
+
+int DJLibraryService::addTrack(const SessionConfig::TrackInfo& track_info) {
+    size_t row = metadata.append(track_info);
+    library.push_back(nullptr);
+    index_row(row);
+    std::cout << "[INFO] Track added to library: " << track_info.title << " (ID " << row + 1 << ")" << std::endl;
+    return static_cast<int>(row) + 1;
+}
+
+size_t DJLibraryService::resolvePlaylistTracks(const std::vector<PlaylistData>& playlists,
+                                              std::map<std::string, std::vector<int>>& resolved) {
+    // Unknown titles get the rows they will be appended at, so IDs are final as
+    // soon as they are assigned; nothing is appended until every title is looked up
+    std::unordered_map<std::string, size_t> new_rows;
+    std::vector<const PlaylistData::PlaylistTrack*> new_tracks;
+    for (const PlaylistData& playlist : playlists) {
+        std::vector<int>& track_ids = resolved[playlist.name];
+        track_ids.clear();
+        track_ids.reserve(playlist.tracks.size());
+        for (const PlaylistData::PlaylistTrack& track : playlist.tracks) {
+            size_t row = first_row_with_title(track.title);
+            if (row == NO_ITEM) {
+                auto inserted = new_rows.emplace(track.title, metadata.size() + new_tracks.size());
+                if (inserted.second) {
+                    new_tracks.push_back(&track);
+                }
+                row = inserted.first->second;
+            }
+            track_ids.push_back(static_cast<int>(row) + 1);
+        }
+    }
+    if (new_tracks.empty()) {
+        return 0;
+    }
+
+    metadata.reserve(metadata.size() + new_tracks.size());
+    library.reserve(library.size() + new_tracks.size());
+    SessionConfig::TrackInfo track_info;
+    for (const PlaylistData::PlaylistTrack* track : new_tracks) {
+        track_info.type = track->type;
+        track_info.title = track->title;
+        track_info.artists.assign(1, track->artist);
+        track_info.duration_seconds = track->duration_seconds;
+        track_info.bpm = track->bpm;
+        track_info.extra_param1 = track->extra_param1;
+        track_info.extra_param2 = track->extra_param2;
+        size_t row = metadata.append(track_info);
+        library.push_back(nullptr);
+        index_row(row);
+    }
+    return new_tracks.size();
+}
+
+bool DJLibraryService::removeTrack(int track_id) {
+    if (!is_track_id(track_id)) {
+        std::cout << "[WARNING] Cannot remove track: no track with ID " << track_id << std::endl;
+        return false;
+    }
+    size_t row = static_cast<size_t>(track_id - 1);
+    unindex_row(row);
+    metadata.remove(row);
+
+    AudioTrack* track = library[row];
+    if (track != nullptr) {
+        // The playlist borrows the object; unlink it before it is deleted
+        playlist.remove_track_object(track);
+        delete track;
+        library[row] = nullptr;
+    }
+    std::cout << "[INFO] Track removed from library: " << metadata.title(row) << " (ID " << track_id << ")" << std::endl;
+    return true;
+}
+
+bool DJLibraryService::updateTrack(int track_id, const SessionConfig::TrackInfo& track_info) {
+    if (!is_track_id(track_id)) {
+        std::cout << "[WARNING] Cannot update track: no track with ID " << track_id << std::endl;
+        return false;
+    }
+    size_t row = static_cast<size_t>(track_id - 1);
+    unindex_row(row);
+    metadata.update(row, track_info);
+    index_row(row);
+
+    AudioTrack* old_track = library[row];
+    if (old_track != nullptr) {
+        // Recreate the object from the new data and point the playlist at it
+        library[row] = nullptr;
+        try {
+            track_at(row);
+        } catch (...) {
+            library[row] = old_track;
+            throw;
+        }
+        std::unordered_map<const AudioTrack*, AudioTrack*> mapping;
+        mapping[old_track] = library[row];
+        playlist.remap_tracks(mapping);
+        delete old_track;
+    }
+    std::cout << "[INFO] Track updated in library: " << track_info.title << " (ID " << track_id << ")" << std::endl;
+    return true;
+}
+
+void DJLibraryService::materialize_rows(const std::vector<size_t>& rows, const TrackReadyHandler& on_ready) {
+    // One work item per row that still needs a track object; position_item maps each
+    // requested position to the item it waits for (NO_ITEM if the track already exists)
+    std::vector<size_t> missing;
+    std::vector<size_t> position_item(rows.size(), NO_ITEM);
+    std::unordered_map<size_t, size_t> item_of_row;
+    for (size_t k = 0; k < rows.size(); ++k) {
+        size_t row = rows[k];
+        if (library[row] == nullptr) {
+            auto inserted = item_of_row.emplace(row, missing.size());
+            if (inserted.second) {
+                missing.push_back(row);
+            }
+            position_item[k] = inserted.first->second;
+        }
+    }
+
+    std::vector<AudioTrack*> built(missing.size(), nullptr);
+    std::vector<char> done(missing.size(), 0);
+    std::mutex done_mutex;
+    std::condition_variable done_changed;
+    std::atomic<size_t> next_item(0);
+    size_t emitted = 0;
+    bool failed = false;
+
+    // Store, log and report every position whose track exists, in order; with
+    // wait == true block for the remaining items instead of returning early
+    ColumnView<uint8_t> formats = metadata.formats();
+    auto emit_ready = [&](bool wait) {
+        while (emitted < rows.size() && !failed) {
+            size_t item = position_item[emitted];
+            if (item != NO_ITEM) {
+                std::unique_lock<std::mutex> lock(done_mutex);
+                if (!done[item]) {
+                    if (!wait) {
+                        return;
+                    }
+                    done_changed.wait(lock, [&]() { return done[item] != 0; });
+                }
+                AudioTrack* track = built[item];
+                lock.unlock();
+
+                size_t row = missing[item];
+                if (track == nullptr) {
+                    failed = true;   // The worker's exception is rethrown by parallel_for
+                    return;
+                }
+                if (library[row] == nullptr) {
+                    library[row] = track;
+                    // Log creation message
+                    if (formats[row] == TrackMetadataTable::FORMAT_MP3) {
+                        std::cout << "[MP3Track created:] " << metadata.rates()[row] << " kbps" << std::endl;
+                    }
+                    else {
+                        std::cout << "[WAVTrack created:] " << metadata.rates()[row] << "Hz/" << metadata.depths()[row] << "bit" << std::endl;
+                    }
+                }
+            }
+            if (on_ready) {
+                on_ready(emitted, library[rows[emitted]]);
+            }
+            emitted++;
+        }
+    };
+
+    // Each worker pulls the next item in order; worker 0 is this thread and also emits
+    auto work = [&](bool emitter) {
+        for (;;) {
+            size_t item = next_item.fetch_add(1);
+            if (item >= missing.size()) {
+                break;
+            }
+            AudioTrack* track = nullptr;
+            try {
+                track = metadata.materialize(missing[item]);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(done_mutex);
+                done[item] = 1;
+                done_changed.notify_all();
+                throw;
+            }
+            {
+                std::lock_guard<std::mutex> lock(done_mutex);
+                built[item] = track;
+                done[item] = 1;
+            }
+            done_changed.notify_all();
+            if (emitter) {
+                emit_ready(false);
+            }
+        }
+        if (emitter) {
+            emit_ready(true);
+        }
+    };
+
+    try {
+        unsigned workers = resolve_thread_count(build_threads);
+        parallel_for(std::max<size_t>(1, std::min<size_t>(workers, missing.size())), workers,
+                     [&](size_t begin, size_t end) {
+            for (size_t w = begin; w < end; ++w) {
+                work(w == 0);
+            }
+        });
+    } catch (...) {
+        // Delete whatever was built but never handed to the library
+        for (size_t i = 0; i < missing.size(); ++i) {
+            if (built[i] != nullptr && library[missing[i]] != built[i]) {
+                delete built[i];
+            }
+        }
+        throw;
+    }
+}
+
+AudioTrack* DJLibraryService::track_at(size_t row) {
+    if (library[row] == nullptr) {
+        materialize_rows(std::vector<size_t>(1, row));
+    }
+    return library[row];
+}
+
+std::vector<int> DJLibraryService::queryTracks(const TrackQuery& query) const {
+    ensure_query_index();
+    return query_index.run(metadata, query);
+}
+
+std::vector<TrackSuggestionIndex::Suggestion> DJLibraryService::suggestNextTracks(const AudioTrack& current,
+                                                                                   size_t k) const {
+    ensure_query_index();
+    ensure_suggestion_index();
+
+    TrackSuggestionIndex::Query query;
+    query.bpm = current.get_bpm();
+    query.quality = current.get_quality_score();
+    query.duration = current.get_duration();
+    query.artists = current.get_artists();
+    query.exclude_row = first_row_with_title(current.get_title());
+    return suggestion_index.nearest(metadata, query_index, query, k);
+}
+
+std::vector<TrackSuggestionIndex::Suggestion> DJLibraryService::suggestNextTracks(int track_id, size_t k) const {
+    if (!is_track_id(track_id)) {
+        return std::vector<TrackSuggestionIndex::Suggestion>();
+    }
+    size_t row = static_cast<size_t>(track_id - 1);
+    ensure_query_index();
+    ensure_suggestion_index();
+
+    TrackSuggestionIndex::Query query;
+    query.bpm = metadata.bpms()[row];
+    query.quality = metadata.quality_scores()[row];
+    query.duration = metadata.durations()[row];
+    query.artists = metadata.artists_of(row);
+    query.exclude_row = row;
+    return suggestion_index.nearest(metadata, query_index, query, k);
+}
+
+size_t DJLibraryService::getMaterializedCount() const {
+    size_t count = 0;
+    for (const AudioTrack* track : library) {
+        if (track != nullptr) count++;
+    }
+    return count;
 }
 
 /**
@@ -124,48 +525,57 @@ Playlist& DJLibraryService::getPlaylist() {
 }
 
 /**
- * TODO: Implement findTrack method
- * 
- * HINT: Leverage Playlist's find_track method
+ * @brief Find a library track by title through the title index
  */
 AudioTrack* DJLibraryService::findTrack(const std::string& track_title) {
-    // Your implementation here
-    return playlist.find_track(track_title);
+    size_t row = first_row_with_title(track_title);
+    return (row != NO_ITEM) ? track_at(row) : nullptr;
+}
+
+/**
+ * @brief Find a library track by its 1-based ID (ID N is row N - 1)
+ */
+AudioTrack* DJLibraryService::findTrackById(int track_id) {
+    if (!is_track_id(track_id)) {
+        return nullptr;
+    }
+    return track_at(static_cast<size_t>(track_id - 1));
 }
 
 void DJLibraryService::loadPlaylistFromIndices(const std::string& playlist_name, 
-                                               const std::vector<int>& track_indices) {
+                                               const std::vector<int>& track_indices,
+                                               const TrackReadyHandler& on_ready) {
     // Your implementation here
     // Log message
     std::cout << "[INFO] Loading playlist: " << playlist_name << std::endl;
     // Create new Playlist with the given name
     Playlist new_playlist(playlist_name);
+    // Create all tracks this playlist needs in one parallel pipeline
+    std::vector<size_t> rows;
+    for (int raw_index : track_indices) {
+        if (is_track_id(raw_index)) {
+            rows.push_back(static_cast<size_t>(raw_index - 1));
+        }
+    }
+    materialize_rows(rows, on_ready);
     // For each index in the indices vector
     for (int raw_index : track_indices) {
-        int real_index = raw_index - 1;
-        // Validate index is within library bounds
-        if (real_index < 0 || static_cast<size_t>(real_index) >= library.size()) {
+        // Indices are 1-based library IDs; unknown IDs are out of bounds
+        AudioTrack* track = findTrackById(raw_index);
+        if (track == nullptr) {
             std::cout << "[WARNING] Invalid track index: " << raw_index << std::endl;
         }
         else {
-            AudioTrack* track = library[real_index];
-            if (track == nullptr) { //  If clone is nullptr, log error and skip
-                std::cout << "[ERROR] Track is null" << std::endl;
-            }
-            else {
-                // Clone the track polymorphically and unwrap the PointerWrapper
-                AudioTrack* cloned_track = (track->clone()).release();
-                // Call load() and analyze_beatgrid() on cloned track
-                cloned_track->load();
-                cloned_track->analyze_beatgrid();
-                // Add cloned track to playlist
-                new_playlist.add_track(cloned_track);
-            }
+            // The playlist borrows the library's track; no clone, no waveform copy.
+            // load() and analyze_beatgrid() run on the controller's and mixer's
+            // own clones when the track is actually played
+            new_playlist.add_track(track);
         }
     }
-    this->playlist = new_playlist;
+    // Hand the new nodes over without copying them; the old playlist is released here
+    this->playlist = std::move(new_playlist);
     // Log message
-    std::cout << "[INFO] Playlist loaded: " << playlist_name << " (" << new_playlist.get_track_count() << " tracks)" << std::endl;
+    std::cout << "[INFO] Playlist loaded: " << playlist_name << " (" << playlist.get_track_count() << " tracks)" << std::endl;
 }
 /**
  * TODO: Implement getTrackTitles method
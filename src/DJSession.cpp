@@ -1,30 +1,67 @@
 
 #include "DJSession.h"
+#include "LibrarySnapshot.h"
+#include "ParallelFor.h"
+#include "TrackStore.h"
 #include <iostream>
 #include <algorithm>
 #include <sstream>
+#include <iomanip>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <numeric>
+#include <unordered_map>
+#include <unordered_set>
 #include <dirent.h>
 
+namespace {
+    const char* const CONFIG_PATH = "bin/dj_config.txt";
+    const char* const SNAPSHOT_PATH = "bin/dj_config.djlib";
+    const char* const DEFAULT_PLAYLISTS_DIRECTORY = "playlists";
+    const double HIGH_QUALITY_SCORE = 80.0;     // Quality score (0-100) reported as high in the summary
+}
+
 // ========== CONSTRUCTORS & RULE OF 5 ==========
 
 
-DJSession::DJSession(const std::string& name, bool play_all)
+DJSession::DJSession(const std::string& name, bool play_all, OrderMode order_mode)
     : session_name(name),
     library_service(),
     controller_service(),
     mixing_service(),
     config_manager(),
     session_config(),
+    config_watcher(),
+    config_track_ids(),
+    directory_playlists(),
     track_titles(),
     play_all(play_all),
+    order_mode(order_mode),
     stats()
       {
+    // Tuning knobs apply as soon as a (re)load changes them; the rest are read where they are used
+    config_manager.onTuningChange(ConfigurationManager::Tunable::BUILD_THREADS,
+        [this](ConfigurationManager::Tunable, int value) {
+            library_service.set_build_threads(static_cast<unsigned>(value));
+        });
+    for (size_t k = 0; k < static_cast<size_t>(ConfigurationManager::Tunable::COUNT); ++k) {
+        config_manager.onTuningChange(static_cast<ConfigurationManager::Tunable>(k),
+            [](ConfigurationManager::Tunable knob, int value) {
+                std::cout << "[INFO] Tuning: " << ConfigurationManager::TUNING_PREFIX
+                          << ConfigurationManager::tuningName(knob) << "="
+                          << ConfigurationManager::tuningText(knob, value) << std::endl;
+            });
+    }
     std::cout << "DJ Session System initialized: " << session_name << std::endl;
 }
 
 
 DJSession::~DJSession() {
     std::cout << "Shutting down DJ Session System: " << session_name << std::endl;
+    #ifdef DEBUG
+    Playlist::node_pool().displayStats("PlaylistNode");
+    #endif
 }
 
 // ========== CORE FUNCTIONALITY ==========
@@ -46,9 +83,39 @@ bool DJSession::load_playlist(const std::string& playlist_name)  {
     }
     
     track_titles = library_service.getTrackTitles();
+    print_playlist_analysis();
     return true;
 }
 
+void DJSession::print_playlist_analysis() {
+    if (config_manager.getTuning(ConfigurationManager::Tunable::PLAYLIST_ANALYSIS) == 0) {
+        return;
+    }
+    TrackStore store;
+    store.assign(library_service.getPlaylist().getTracks());
+    if (store.size() == 0) {
+        return;
+    }
+    std::vector<double> scores = store.score_all();
+    std::vector<TrackStore::BeatgridAnalysis> analyses = store.analyze_all();
+    double total_score = 0.0;
+    double total_beats = 0.0;
+    double total_precision = 0.0;
+    for (size_t row = 0; row < store.size(); ++row) {
+        total_score += scores[row];
+        total_beats += analyses[row].estimated_beats;
+        total_precision += analyses[row].precision_factor;
+    }
+    double count = static_cast<double>(store.size());
+    // Formatted apart so the fixed precision does not stick to std::cout
+    std::ostringstream line;
+    line << "[INFO] Playlist analysis: " << store.size() << " tracks (" << store.mp3_count() << " MP3, "
+         << store.wav_count() << " WAV), average quality " << std::fixed << std::setprecision(1)
+         << total_score / count << ", " << static_cast<long long>(total_beats) << " estimated beats, average precision "
+         << std::setprecision(2) << total_precision / count;
+    std::cout << line.str() << std::endl;
+}
+
 /**
  * TODO: Implement load_track_to_controller method
  * 
@@ -119,12 +186,14 @@ bool DJSession::load_track_to_mixer_deck(const std::string& track_title) {
     if(loadtrackresult == 0) {
         stats.deck_loads_a++;
         stats.transitions++;
+        print_next_suggestions();
         return true;
     }
 
     else if (loadtrackresult == 1){
         stats.deck_loads_b++;
         stats.transitions++;
+        print_next_suggestions();
         return true;
     }
 
@@ -136,6 +205,384 @@ bool DJSession::load_track_to_mixer_deck(const std::string& track_title) {
     }
 }
 
+void DJSession::print_next_suggestions() const {
+    size_t k = static_cast<size_t>(config_manager.getTuning(ConfigurationManager::Tunable::SUGGEST_NEXT));
+    const AudioTrack* active = mixing_service.get_active_track();
+    if (k == 0 || active == nullptr) {
+        return;
+    }
+    const TrackMetadataTable& metadata = library_service.getMetadata();
+    std::vector<TrackSuggestionIndex::Suggestion> suggestions = library_service.suggestNextTracks(*active, k);
+    std::cout << "[INFO] Suggested next:";
+    for (size_t i = 0; i < suggestions.size(); ++i) {
+        size_t row = static_cast<size_t>(suggestions[i].track_id - 1);
+        std::cout << (i == 0 ? " " : ", ") << "\"" << metadata.title(row) << "\" (" << metadata.bpms()[row] << " BPM)";
+    }
+    std::cout << std::endl;
+}
+
+int DJSession::add_library_track(const SessionConfig::TrackInfo& track_info) {
+    int track_id = library_service.addTrack(track_info);
+    // A cached track with the same title would shadow the new one
+    controller_service.removeTrackFromCache(track_info.title);
+    return track_id;
+}
+
+bool DJSession::remove_library_track(int track_id) {
+    const TrackMetadataTable& metadata = library_service.getMetadata();
+    std::string title = (track_id >= 1 && static_cast<size_t>(track_id) <= metadata.size())
+        ? metadata.title(static_cast<size_t>(track_id - 1)) : std::string();
+    if (!library_service.removeTrack(track_id)) {
+        return false;
+    }
+    controller_service.removeTrackFromCache(title);
+    track_titles = library_service.getTrackTitles();
+    return true;
+}
+
+bool DJSession::update_library_track(int track_id, const SessionConfig::TrackInfo& track_info) {
+    const TrackMetadataTable& metadata = library_service.getMetadata();
+    std::string old_title = (track_id >= 1 && static_cast<size_t>(track_id) <= metadata.size())
+        ? metadata.title(static_cast<size_t>(track_id - 1)) : std::string();
+    if (!library_service.updateTrack(track_id, track_info)) {
+        return false;
+    }
+    controller_service.removeTrackFromCache(old_title);
+    controller_service.removeTrackFromCache(track_info.title);
+    track_titles = library_service.getTrackTitles();
+    return true;
+}
+
+bool DJSession::reload_configuration() {
+    auto start = std::chrono::steady_clock::now();
+
+    SessionConfig fresh;
+    bool parsed = SessionFileParser::parse_config_file(CONFIG_PATH, fresh,
+        [&fresh](std::vector<SessionConfig::TrackInfo>& batch) {
+            for (SessionConfig::TrackInfo& track_info : batch) {
+                fresh.library_tracks.push_back(std::move(track_info));
+            }
+        },
+        static_cast<size_t>(config_manager.getTuning(ConfigurationManager::Tunable::PARSE_BATCH_SIZE)),
+        static_cast<unsigned>(config_manager.getTuning(ConfigurationManager::Tunable::PARSE_THREADS)));
+    if (!parsed) {
+        std::cout << "[WARNING] Config reload failed; keeping the current configuration" << std::endl;
+        return false;
+    }
+    
+    // Knobs first, so the rest of the reload already runs with them
+    config_manager.applyTuning(fresh.tuning);
+
+    // ========== TRACKS ==========
+    const TrackMetadataTable& metadata = library_service.getMetadata();
+    const std::vector<SessionConfig::TrackInfo>& tracks = fresh.library_tracks;
+    std::vector<int> fresh_ids(tracks.size(), 0);                 // Library ID of each new config track
+    std::vector<bool> claimed(config_track_ids.size(), false);    // Old config tracks that are kept
+
+    // Unchanged tracks usually keep their position in the file
+    size_t common = std::min(tracks.size(), config_track_ids.size());
+    for (size_t i = 0; i < common; ++i) {
+        if (metadata.matches(static_cast<size_t>(config_track_ids[i] - 1), tracks[i])) {
+            fresh_ids[i] = config_track_ids[i];
+            claimed[i] = true;
+        }
+    }
+
+    // The rest are looked up by title: the same track moved, else an edited one
+    std::unordered_multimap<std::string, size_t> unclaimed;      // Title -> old position
+    for (size_t pos = 0; pos < config_track_ids.size(); ++pos) {
+        size_t row = static_cast<size_t>(config_track_ids[pos] - 1);
+        if (!claimed[pos] && !metadata.is_removed(row)) {
+            unclaimed.emplace(metadata.title(row), pos);
+        }
+    }
+    for (size_t i = 0; i < tracks.size() && !unclaimed.empty(); ++i) {
+        if (fresh_ids[i] != 0) {
+            continue;
+        }
+        auto range = unclaimed.equal_range(tracks[i].title);
+        for (auto it = range.first; it != range.second; ++it) {
+            int track_id = config_track_ids[it->second];
+            if (metadata.matches(static_cast<size_t>(track_id - 1), tracks[i])) {
+                fresh_ids[i] = track_id;
+                claimed[it->second] = true;
+                unclaimed.erase(it);
+                break;
+            }
+        }
+    }
+    size_t updated = 0;
+    for (size_t i = 0; i < tracks.size() && !unclaimed.empty(); ++i) {
+        if (fresh_ids[i] != 0) {
+            continue;
+        }
+        auto it = unclaimed.find(tracks[i].title);
+        if (it != unclaimed.end()) {
+            int track_id = config_track_ids[it->second];
+            if (update_library_track(track_id, tracks[i])) {
+                fresh_ids[i] = track_id;
+                claimed[it->second] = true;
+                ++updated;
+            }
+            unclaimed.erase(it);
+        }
+    }
+
+    // Remove before adding, so a new track never shares a title with one on its way out
+    std::unordered_set<int> removed_ids;
+    for (size_t pos = 0; pos < config_track_ids.size(); ++pos) {
+        if (!claimed[pos] && remove_library_track(config_track_ids[pos])) {
+            removed_ids.insert(config_track_ids[pos]);
+        }
+    }
+    size_t removed = removed_ids.size();
+    size_t added = 0;
+    for (size_t i = 0; i < tracks.size(); ++i) {
+        if (fresh_ids[i] == 0) {
+            fresh_ids[i] = add_library_track(tracks[i]);
+            ++added;
+        }
+    }
+
+    // ========== PLAYLISTS ==========
+    // Config indices are positions in the file's track list; the library knows
+    // tracks by ID. An index past the list would name some unrelated ID, so it is dropped
+    std::map<std::string, std::vector<int>> playlists;
+    for (const auto& entry : fresh.playlists) {
+        std::vector<int>& ids = playlists[entry.first];
+        ids.reserve(entry.second.size());
+        for (int index : entry.second) {
+            if (index >= 1 && static_cast<size_t>(index) <= fresh_ids.size()) {
+                ids.push_back(fresh_ids[static_cast<size_t>(index - 1)]);
+            } else {
+                std::cout << "[WARNING] Invalid track index in playlist '" << entry.first << "': " << index << std::endl;
+            }
+        }
+    }
+    // Playlist files name tracks by title: re-resolve them if the directory changed or one
+    // of their tracks was removed (or renamed), rather than keep a dead ID
+    bool directory_stale = fresh.playlists_directory != session_config.playlists_directory;
+    for (auto entry = directory_playlists.begin(); entry != directory_playlists.end() && !directory_stale; ++entry) {
+        for (int track_id : entry->second) {
+            if (removed_ids.count(track_id) > 0) {
+                directory_stale = true;
+                break;
+            }
+        }
+    }
+    if (directory_stale) {
+        load_playlist_directory(fresh.playlists_directory);
+    }
+    merge_directory_playlists(playlists);
+    size_t playlists_changed = 0;
+    for (const auto& entry : playlists) {
+        auto old = session_config.playlists.find(entry.first);
+        if (old == session_config.playlists.end() || old->second != entry.second) {
+            ++playlists_changed;
+        }
+    }
+    for (const auto& entry : session_config.playlists) {
+        if (playlists.find(entry.first) == playlists.end()) {
+            ++playlists_changed;
+        }
+    }
+
+    // ========== SETTINGS ==========
+    if (fresh.bpm_tolerance != session_config.bpm_tolerance) {
+        std::cout << "[INFO] BPM Tolerance: " << session_config.bpm_tolerance << " -> " << fresh.bpm_tolerance
+                  << " BPM" << std::endl;
+        mixing_service.set_bpm_tolerance(fresh.bpm_tolerance);
+    }
+    if (fresh.auto_sync != session_config.auto_sync) {
+        std::cout << "[INFO] Auto Sync: " << (fresh.auto_sync ? "enabled" : "disabled") << std::endl;
+        mixing_service.set_auto_sync(fresh.auto_sync);
+    }
+    if (fresh.default_crossfade_time != session_config.default_crossfade_time ||
+        fresh.crossfade_curve != session_config.crossfade_curve) {
+        std::cout << "[INFO] Crossfade: " << fresh.default_crossfade_time << " s, "
+                  << crossfade_curve_name(fresh.crossfade_curve) << std::endl;
+        mixing_service.set_crossfade(fresh.default_crossfade_time, fresh.crossfade_curve);
+    }
+    if (fresh.controller_cache_size != session_config.controller_cache_size) {
+        std::cout << "[INFO] Cache Size: " << session_config.controller_cache_size << " -> "
+                  << fresh.controller_cache_size << " slots" << std::endl;
+        controller_service.set_cache_size(fresh.controller_cache_size);
+    }
+
+    fresh.library_tracks.clear();
+    fresh.playlists = std::move(playlists);
+    session_config = std::move(fresh);
+    config_track_ids = std::move(fresh_ids);
+
+    double elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "[INFO] Config reloaded in " << std::fixed << std::setprecision(2) << elapsed_ms
+              << std::defaultfloat << " ms: " << added << " tracks added, " << removed << " removed, "
+              << updated << " updated, " << playlists_changed << " playlists changed" << std::endl;
+    if (config_manager.getTuning(ConfigurationManager::Tunable::PRINT_SETTINGS)) {
+        print_effective_settings();
+    }
+    return true;
+}
+
+void DJSession::load_playlist_directory(const std::string& configured) {
+    directory_playlists.clear();
+    const std::string directory = configured.empty() ? DEFAULT_PLAYLISTS_DIRECTORY : configured;
+    std::vector<PlaylistData> playlists;
+    unsigned threads = static_cast<unsigned>(config_manager.getTuning(ConfigurationManager::Tunable::PARSE_THREADS));
+    if (!SessionFileParser::parse_playlist_directory(directory, playlists, threads)) {
+        if (!configured.empty()) {
+            std::cout << "[WARNING] Cannot open playlists directory: " << directory << std::endl;
+        }
+        return;
+    }
+
+    bool mapped = library_service.getMetadata().is_snapshot_backed();
+    size_t added = library_service.resolvePlaylistTracks(playlists, directory_playlists);
+    if (added > 0) {
+        std::cout << "[INFO] " << added << " tracks from " << directory << " added to the library" << std::endl;
+        if (mapped) {
+            std::cout << "[WARNING] " << SNAPSHOT_PATH << " lacks " << added << " tracks of " << directory
+                      << "; the library was copied into memory (recompile with -S)" << std::endl;
+        }
+    }
+}
+
+void DJSession::merge_directory_playlists(std::map<std::string, std::vector<int>>& playlists) const {
+    for (const auto& entry : directory_playlists) {
+        if (!playlists.insert(entry).second) {
+            std::cout << "[WARNING] Playlist '" << entry.first
+                      << "' is defined in the config and in the playlists directory; using the config's" << std::endl;
+        }
+    }
+}
+
+void DJSession::print_effective_settings() const {
+    const SessionConfig& config = session_config;
+    std::cout << "# Effective settings (" << resolve_thread_count(0) << " hardware threads)\n"
+              << "app_name=" << config.app_name << "\n"
+              << "version=" << config.version << "\n"
+              << "controller_cache_size=" << config.controller_cache_size << "\n"
+              << "cache_order_max_bpm_jump=" << config.cache_order_max_bpm_jump << "\n"
+              << "default_crossfade_time=" << config.default_crossfade_time << "\n"
+              << "crossfade_curve=" << crossfade_curve_name(config.crossfade_curve) << "\n"
+              << "bpm_tolerance=" << config.bpm_tolerance << "\n"
+              << "auto_sync=" << (config.auto_sync ? "true" : "false") << "\n"
+              << "playlists_directory="
+              << (config.playlists_directory.empty() ? DEFAULT_PLAYLISTS_DIRECTORY : config.playlists_directory)
+              << "\n";
+    config_manager.printTuning(std::cout);
+    std::cout << std::flush;
+}
+
+void DJSession::poll_config_changes() {
+    if (config_watcher.poll()) {
+        std::cout << "[INFO] " << CONFIG_PATH << " changed; reloading" << std::endl;
+        reload_configuration();
+    }
+}
+
+/**
+ * @brief Compute a BPM-optimized order for the loaded playlist and print it
+ * next to the current one. Uses the session's BPM tolerance and auto-sync
+ * settings, so the sync counts match what MixingEngineService would do.
+ * @return Proposed order (indices into the current play order)
+ */
+std::vector<size_t> DJSession::preview_playlist_order() {
+    std::vector<AudioTrack*> tracks = library_service.getPlaylist().getTracks();
+    std::vector<int> bpms;
+    for (AudioTrack* track : tracks) {
+        bpms.push_back(track->get_bpm());
+    }
+
+    PlaylistOptimizer optimizer(session_config.bpm_tolerance, session_config.auto_sync,
+        static_cast<unsigned>(config_manager.getTuning(ConfigurationManager::Tunable::OPTIMIZER_THREADS)));
+    auto start = std::chrono::steady_clock::now();
+    std::vector<size_t> order = optimizer.optimize(bpms);
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+    std::vector<size_t> current_order(tracks.size());
+    for (size_t i = 0; i < current_order.size(); ++i) {
+        current_order[i] = i;
+    }
+    PlaylistOptimizer::OrderStats before = optimizer.evaluate(bpms, current_order);
+    PlaylistOptimizer::OrderStats after = optimizer.evaluate(bpms, order);
+
+    std::cout << "\n=== Playlist Order Preview: " << library_service.getPlaylist().get_name() << " ===" << std::endl;
+    std::cout << "Current order:   " << before.sync_events << " sync events, "
+              << before.total_bpm_jump << " BPM total jump" << std::endl;
+    std::cout << "Optimized order: " << after.sync_events << " sync events, "
+              << after.total_bpm_jump << " BPM total jump ("
+              << elapsed.count() << " us on " << optimizer.get_thread_count() << " threads)" << std::endl;
+    for (size_t k = 0; k < order.size(); ++k) {
+        AudioTrack* track = tracks[order[k]];
+        std::cout << (k + 1) << ". " << track->get_title() << " (" << track->get_bpm() << " BPM)" << std::endl;
+    }
+    std::cout << "========================" << std::endl;
+    return order;
+}
+
+/**
+ * @brief Compute an order that replays repeated tracks within the controller
+ * cache's reuse window and print the predicted hit rate before and after.
+ * Predictions assume the cache starts empty.
+ * @return Proposed order (indices into the current play order)
+ */
+std::vector<size_t> DJSession::preview_cache_order() {
+    std::vector<AudioTrack*> tracks = library_service.getPlaylist().getTracks();
+    std::vector<std::string> keys;
+    std::vector<int> bpms;
+    for (AudioTrack* track : tracks) {
+        keys.push_back(track->get_title());
+        bpms.push_back(track->get_bpm());
+    }
+
+    size_t capacity = static_cast<size_t>(std::max(0, session_config.controller_cache_size));
+    std::vector<size_t> order = PlaylistOptimizer::cache_order(keys, bpms, capacity,
+                                                               session_config.cache_order_max_bpm_jump);
+
+    std::vector<size_t> current_order(tracks.size());
+    for (size_t i = 0; i < current_order.size(); ++i) {
+        current_order[i] = i;
+    }
+    size_t hits_before = PlaylistOptimizer::predict_cache_hits(keys, current_order, capacity);
+    size_t hits_after = PlaylistOptimizer::predict_cache_hits(keys, order, capacity);
+
+    std::cout << "\n=== Cache Order Preview: " << library_service.getPlaylist().get_name() << " ===" << std::endl;
+    std::cout << "Cache capacity: " << capacity << " slots";
+    if (session_config.cache_order_max_bpm_jump > 0) {
+        std::cout << ", max BPM jump: " << session_config.cache_order_max_bpm_jump;
+    }
+    std::cout << std::endl;
+    std::cout << "Current order:   " << hits_before << "/" << tracks.size() << " predicted cache hits" << std::endl;
+    std::cout << "Optimized order: " << hits_after << "/" << tracks.size() << " predicted cache hits" << std::endl;
+    std::cout << "========================" << std::endl;
+
+    stats.has_cache_prediction = true;
+    stats.predicted_cache_hits = hits_after;
+    return order;
+}
+
+void DJSession::apply_order_mode() {
+    if (order_mode == OrderMode::AS_CONFIGURED) {
+        return;
+    }
+
+    if (order_mode == OrderMode::CACHE_OPTIMIZED) {
+        std::vector<size_t> order = preview_cache_order();
+        if (library_service.getPlaylist().reorder(order)) {
+            track_titles = library_service.getTrackTitles();
+            std::cout << "[System] Playing playlist in cache-optimized order" << std::endl;
+        }
+        return;
+    }
+
+    std::vector<size_t> order = preview_playlist_order();
+    if (order_mode == OrderMode::BPM_OPTIMIZED && library_service.getPlaylist().reorder(order)) {
+        track_titles = library_service.getTrackTitles();
+        std::cout << "[System] Playing playlist in BPM-optimized order" << std::endl;
+    }
+}
+
 /**
  * @brief Main simulation loop that orchestrates the DJ performance session.
  * @note Updates session statistics (stats) throughout processing
@@ -150,8 +597,12 @@ void DJSession::simulate_dj_performance() {
         return;
     }
     
-    // 2. Build track library from config
-    library_service.buildLibrary(session_config.library_tracks);
+    // 2. The track library was built (or mapped) by load_configuration
+
+    // Edits to the config file are picked up between playlists
+    if (!config_watcher.watch(CONFIG_PATH)) {
+        std::cout << "[WARNING] Cannot watch " << CONFIG_PATH << "; config changes need a restart" << std::endl;
+    }
     
     // 3. Get available playlists from config
     if (session_config.playlists.empty()) {
@@ -168,9 +619,14 @@ void DJSession::simulate_dj_performance() {
     // Your implementation here
     if (play_all) {
         // Playlist Selection Loop - when play_all = true
-        // Map is already sorted by key, so iterating it satisfies "Extract and sort"
-        for (const auto& pair : session_config.playlists) { 
-            std::string playlist_name = pair.first;
+        // Map is already sorted by key, so iterating it satisfies "Extract and sort".
+        // The names are copied first: a reload replaces the map
+        std::vector<std::string> playlist_names;
+        for (const auto& pair : session_config.playlists) {
+            playlist_names.push_back(pair.first);
+        }
+        for (const std::string& playlist_name : playlist_names) {
+            poll_config_changes();
             // Call load_playlist
             bool playlist_loaded = load_playlist(playlist_name); 
             // If load fails, log error and continue to next playlist
@@ -178,6 +634,7 @@ void DJSession::simulate_dj_performance() {
                 std::cerr << "[ERROR] playlist loading of \"" << playlist_name << "\" failed." << std::endl;
                 continue; 
             }
+            apply_order_mode();
             // Track Processing Loop - for each track in track_titles
             for (const auto& track_title : track_titles) { 
                 std::cout << "\n-- Processing: " << track_title << " --" << std::endl; // Log message
@@ -192,6 +649,7 @@ void DJSession::simulate_dj_performance() {
                 }
             }
             // After all tracks processed, call print_session_summary()
+            stats.rendered_samples = mixing_service.take_rendered_samples();
             print_session_summary();
             // Reset statistics for next playlist
             stats = {}; // Resets all struct members to 0
@@ -200,11 +658,14 @@ void DJSession::simulate_dj_performance() {
     else {
         // Interactive mode: continue until user selects Cancel
         while (true) {
+            poll_config_changes();
             std::string playlist_name = display_playlist_menu_from_config();
             // if an empty string is returned (cancelled), break the loop
             if (playlist_name.empty()) {
                 break;
             }
+            // The file may have changed while the menu was waiting for input
+            poll_config_changes();
             // Call load_playlist
             bool playlist_loaded = load_playlist(playlist_name); 
             // If load fails, log error and continue to next playlist (prompt again)
@@ -212,6 +673,7 @@ void DJSession::simulate_dj_performance() {
                 std::cerr << "[ERROR] playlist loading of \"" << playlist_name << "\" failed." << std::endl;
                 continue;
             }
+            apply_order_mode();
             // Track Processing Loop - for each track in track_titles
             for (const auto& track_title : track_titles) { 
                 std::cout << "\n-- Processing: " << track_title << " --" << std::endl; // Log message
@@ -226,6 +688,7 @@ void DJSession::simulate_dj_performance() {
                 }
             }
             // After all tracks processed, call print_session_summary()
+            stats.rendered_samples = mixing_service.take_rendered_samples();
             print_session_summary();
             // Reset statistics for next playlist
             stats = {}; // Resets all struct members to 0
@@ -242,14 +705,51 @@ void DJSession::simulate_dj_performance() {
  * @return: true if configuration loaded successfully; false on error
  */
 bool DJSession::load_configuration() {
-    const std::string config_path = "bin/dj_config.txt";
+    const std::string config_path = CONFIG_PATH;
+
+    // An up-to-date compiled snapshot replaces parsing the text config
+    bool library_from_snapshot = false;
+    std::shared_ptr<LibrarySnapshot> snapshot(new LibrarySnapshot());
+    if (snapshot->open(SNAPSHOT_PATH)) {
+        if (snapshot->is_stale_for(config_path)) {
+            std::cout << "[WARNING] " << SNAPSHOT_PATH << " is out of date; using " << config_path
+                      << " (recompile with -S)" << std::endl;
+        }
+        #ifdef DEBUG
+        else if (!snapshot->verify()) {
+            std::cout << "[WARNING] " << SNAPSHOT_PATH << " failed its checksum; using " << config_path << std::endl;
+        }
+        #endif
+        else {
+            std::cout << "Loading configuration from snapshot: " << SNAPSHOT_PATH << std::endl;
+            snapshot->read_settings(session_config);
+            library_service.attachSnapshot(snapshot);
+            library_from_snapshot = true;
+        }
+    }
+
+    if (!library_from_snapshot) {
+        std::cout << "Loading configuration from: " << config_path << std::endl;
+
+        // The config's own parse knobs are only known once it is read; they apply from the next reload
+        size_t batch_size = static_cast<size_t>(config_manager.getTuning(ConfigurationManager::Tunable::PARSE_BATCH_SIZE));
+        unsigned threads = static_cast<unsigned>(config_manager.getTuning(ConfigurationManager::Tunable::PARSE_THREADS));
+        if (!library_service.buildLibraryFromFile(config_path, session_config, batch_size, threads)) {
+            std::cerr << "[ERROR] Failed to parse configuration file: " << config_path << std::endl;
+            return false;
+        }
+    }
     
-    std::cout << "Loading configuration from: " << config_path << std::endl;
+    // Config track k is library ID k until a reload moves things around; a snapshot
+    // also holds the playlist files' tracks after the config's
+    config_track_ids.resize(library_from_snapshot ? snapshot->config_track_count()
+                                                  : library_service.getMetadata().size());
+    std::iota(config_track_ids.begin(), config_track_ids.end(), 1);
+    config_manager.applyTuning(session_config.tuning);
     
-    if (!SessionFileParser::parse_config_file(config_path, session_config)) {
-        std::cerr << "[ERROR] Failed to parse configuration file: " << config_path << std::endl;
-        return false;
-    }
+    // Config tracks come first, so a playlist file naming one of them shares its ID
+    load_playlist_directory(session_config.playlists_directory);
+    merge_directory_playlists(session_config.playlists);
     
     std::cout << "Configuration loaded successfully." << std::endl;
     std::cout << "BPM Tolerance: " << session_config.bpm_tolerance << " BPM" << std::endl;
@@ -257,8 +757,48 @@ bool DJSession::load_configuration() {
     std::cout << "Cache Size: " << session_config.controller_cache_size << " slots" << std::endl;
     mixing_service.set_auto_sync(session_config.auto_sync);
     mixing_service.set_bpm_tolerance(session_config.bpm_tolerance);
+    mixing_service.set_crossfade(session_config.default_crossfade_time, session_config.crossfade_curve);
     //update cache size in LRUCache
     controller_service.set_cache_size(session_config.controller_cache_size);
+    if (config_manager.getTuning(ConfigurationManager::Tunable::PRINT_SETTINGS)) {
+        print_effective_settings();
+    }
+    return true;
+}
+
+bool DJSession::compile_library_snapshot() {
+    std::cout << "Compiling library snapshot from: " << CONFIG_PATH << std::endl;
+
+    // Tracks stream straight into the library's metadata table; no TrackInfo list is kept
+    SessionConfig config;
+    DJLibraryService library;
+    if (!library.buildLibraryFromFile(CONFIG_PATH, config)) {
+        std::cerr << "[ERROR] Failed to parse configuration file: " << CONFIG_PATH << std::endl;
+        return false;
+    }
+
+    // Tracks named only by playlist files follow the config's, as in a session,
+    // so a session on the snapshot resolves every title without copying the mapping
+    size_t config_track_count = library.getMetadata().size();
+    const std::string directory = config.playlists_directory.empty() ? DEFAULT_PLAYLISTS_DIRECTORY
+                                                                     : config.playlists_directory;
+    std::vector<PlaylistData> playlists;
+    if (SessionFileParser::parse_playlist_directory(directory, playlists)) {
+        std::map<std::string, std::vector<int>> resolved;
+        size_t added = library.resolvePlaylistTracks(playlists, resolved);
+        std::cout << "[INFO] " << added << " tracks from " << directory << " included" << std::endl;
+    }
+    if (!LibrarySnapshot::write(SNAPSHOT_PATH, config, library.getMetadata(), config_track_count, CONFIG_PATH)) {
+        return false;
+    }
+
+    LibrarySnapshot written;
+    if (!written.open(SNAPSHOT_PATH) || !written.verify()) {
+        std::cerr << "[ERROR] Library snapshot failed verification: " << SNAPSHOT_PATH << std::endl;
+        return false;
+    }
+    std::cout << "[INFO] Library snapshot written: " << SNAPSHOT_PATH << " (" << written.track_count()
+              << " tracks)" << std::endl;
     return true;
 }
 
@@ -316,9 +856,33 @@ void DJSession::print_session_summary() const {
     std::cout << "Cache hits: " << stats.cache_hits << std::endl;
     std::cout << "Cache misses: " << stats.cache_misses << std::endl;
     std::cout << "Cache evictions: " << stats.cache_evictions << std::endl;
+    if (stats.has_cache_prediction) {
+        size_t lookups = stats.cache_hits + stats.cache_misses;
+        std::ostringstream rates;
+        rates << std::fixed << std::setprecision(1)
+              << (lookups ? 100.0 * stats.cache_hits / lookups : 0.0) << "% (predicted "
+              << (stats.tracks_processed ? 100.0 * stats.predicted_cache_hits / stats.tracks_processed : 0.0)
+              << "% from an empty cache)";
+        std::cout << "Cache hit rate: " << rates.str() << std::endl;
+    }
     std::cout << "Deck A loads: " << stats.deck_loads_a << std::endl;
     std::cout << "Deck B loads: " << stats.deck_loads_b << std::endl;
     std::cout << "Transitions: " << stats.transitions << std::endl;
+    std::cout << "Rendered crossfade samples: " << stats.rendered_samples << std::endl;
     std::cout << "Errors: " << stats.errors << std::endl;
+
+    // Library totals come from column scans, so no track objects are created for them
+    const TrackMetadataTable& metadata = library_service.getMetadata();
+    double average_bpm = metadata.average_bpm();
+    int tolerance = session_config.bpm_tolerance;
+    std::ostringstream library_stats;
+    library_stats << std::fixed << std::setprecision(1) << average_bpm;
+    std::cout << "Library tracks: " << metadata.live_size() << " (" << metadata.total_duration()
+              << " seconds, average BPM " << library_stats.str() << ")" << std::endl;
+    std::cout << "Library tracks within " << tolerance << " BPM of the average: "
+              << metadata.count_in_bpm_range(static_cast<int>(std::ceil(average_bpm - tolerance)),
+                                             static_cast<int>(std::floor(average_bpm + tolerance))) << std::endl;
+    std::cout << "Library tracks with quality >= " << HIGH_QUALITY_SCORE << ": "
+              << metadata.count_with_quality(HIGH_QUALITY_SCORE) << std::endl;
     std::cout << "=== Session Complete ===" << std::endl;
 }
\ No newline at end of file
@@ -57,6 +57,13 @@ bool LRUCache::evictLRU() {
     return true;
 }
 
+bool LRUCache::remove(const std::string& track_id) {
+    size_t idx = findSlot(track_id);
+    if (idx == max_size) return false;
+    slots[idx].clear();
+    return true;
+}
+
 size_t LRUCache::size() const {
     size_t count = 0;
     for (const auto& slot : slots) if (slot.isOccupied()) ++count;
@@ -130,6 +137,22 @@ size_t LRUCache::findEmptySlot() const {
 void LRUCache::set_capacity(size_t capacity){
     if (max_size == capacity)
         return;
+    if (capacity < max_size) {
+        // Shrinking: evict least recently used tracks until the rest fit, then
+        // move the survivors out of the slots that are about to be cut off
+        while (size() > capacity && evictLRU()) {
+        }
+        size_t free_slot = 0;
+        for (size_t i = capacity; i < max_size; ++i) {
+            if (!slots[i].isOccupied()) {
+                continue;
+            }
+            while (slots[free_slot].isOccupied()) {
+                ++free_slot;
+            }
+            slots[free_slot] = std::move(slots[i]);
+        }
+    }
     //udpate max size
     max_size = capacity;
     //update the slots vector
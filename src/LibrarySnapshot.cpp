@@ -0,0 +1,374 @@
+#include "LibrarySnapshot.h"
+#include "ConfigCache.h"
+#include "MappedFile.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static_assert(sizeof(int) == sizeof(int32_t), "snapshot columns are stored as int32");
+
+namespace {
+    const char MAGIC[8] = { 'D', 'J', 'L', 'I', 'B', 'S', 'N', 'P' };
+    const uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+    const uint64_t FNV_PRIME = 1099511628211ULL;
+
+    uint64_t fnv1a(uint64_t hash, const char* bytes, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            hash ^= static_cast<unsigned char>(bytes[i]);
+            hash *= FNV_PRIME;
+        }
+        return hash;
+    }
+
+    bool hash_source(const std::string& path, uint64_t& size, uint64_t& hash) {
+        MappedFile file;
+        if (!file.open(path)) {
+            return false;
+        }
+        file.advise_sequential();
+        size = file.size();
+        hash = ConfigCache::hash_contents(file.data(), file.size());
+        return true;
+    }
+
+    /**
+     * @brief Appends 8-byte aligned sections after the header, checksumming as it goes
+     */
+    class SectionWriter {
+    public:
+        SectionWriter(std::ofstream& out, uint64_t start) : out(out), offset(start), checksum(FNV_OFFSET_BASIS) {}
+
+        void append(const void* bytes, size_t count) {
+            out.write(static_cast<const char*>(bytes), static_cast<std::streamsize>(count));
+            checksum = fnv1a(checksum, static_cast<const char*>(bytes), count);
+            offset += count;
+        }
+
+        uint64_t begin_section() {
+            static const char zeros[8] = { 0 };
+            if (offset % 8 != 0) {
+                append(zeros, 8 - offset % 8);
+            }
+            return offset;
+        }
+
+        template<typename T>
+        uint64_t write_section(const T* values, size_t count) {
+            uint64_t at = begin_section();
+            if (count > 0) {
+                append(values, count * sizeof(T));
+            }
+            return at;
+        }
+
+        uint64_t get_offset() const { return offset; }
+        uint64_t get_checksum() const { return checksum; }
+
+    private:
+        std::ofstream& out;
+        uint64_t offset;
+        uint64_t checksum;
+    };
+}
+
+LibrarySnapshot::LibrarySnapshot() : data(nullptr), size(0), header(nullptr) {}
+
+LibrarySnapshot::~LibrarySnapshot() {
+    close();
+}
+
+bool LibrarySnapshot::write(const std::string& snapshot_path, const SessionConfig& config,
+                            const TrackMetadataTable& table, size_t config_track_count,
+                            const std::string& source_path) {
+    size_t track_count = table.size();
+
+    std::vector<char> pool;
+    auto add_string = [&pool](const std::string& str) {
+        StringRef ref = { pool.size(), str.size() };
+        pool.insert(pool.end(), str.begin(), str.end());
+        return ref;
+    };
+
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = FORMAT_VERSION;
+    header.header_size = sizeof(Header);
+    hash_source(source_path, header.source_size, header.source_hash);
+
+    header.app_name = add_string(config.app_name);
+    header.version_string = add_string(config.version);
+    header.playlists_directory = add_string(config.playlists_directory);
+    header.controller_cache_size = config.controller_cache_size;
+    header.cache_order_max_bpm_jump = config.cache_order_max_bpm_jump;
+    header.default_crossfade_time = config.default_crossfade_time;
+    header.bpm_tolerance = config.bpm_tolerance;
+    header.auto_sync = config.auto_sync ? 1 : 0;
+    header.crossfade_curve = static_cast<int32_t>(config.crossfade_curve);
+
+    // Strings and variable-length lists go through the pool and index arrays
+    std::vector<StringRef> titles(track_count);
+    std::vector<uint64_t> artist_index(track_count + 1);
+    std::vector<StringRef> artist_refs;
+    for (size_t row = 0; row < track_count; ++row) {
+        titles[row] = add_string(table.title(row));
+        artist_index[row] = artist_refs.size();
+        for (const std::string& artist : table.artists_of(row)) {
+            artist_refs.push_back(add_string(artist));
+        }
+    }
+    artist_index[track_count] = artist_refs.size();
+
+    std::vector<PlaylistRef> playlists;
+    std::vector<int32_t> playlist_ids;
+    for (const auto& pair : config.playlists) {
+        PlaylistRef ref = { add_string(pair.first), playlist_ids.size(), pair.second.size() };
+        playlists.push_back(ref);
+        playlist_ids.insert(playlist_ids.end(), pair.second.begin(), pair.second.end());
+    }
+    std::vector<TuningRef> tuning;
+    for (const auto& entry : config.tuning) {
+        TuningRef ref = { add_string(entry.first), add_string(entry.second) };
+        tuning.push_back(ref);
+    }
+
+    header.track_count = track_count;
+    header.config_track_count = config_track_count;
+    header.artist_ref_count = artist_refs.size();
+    header.playlist_count = playlists.size();
+    header.playlist_id_count = playlist_ids.size();
+    header.tuning_count = tuning.size();
+    header.string_pool_size = pool.size();
+
+    // Write next to the target and rename, so a reader never maps a half-written file
+    std::string temp_path = snapshot_path + ".tmp";
+    std::ofstream out(temp_path.c_str(), std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        std::cerr << "[ERROR] Cannot create library snapshot: " << temp_path << std::endl;
+        return false;
+    }
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    SectionWriter writer(out, sizeof(header));
+    header.bpm_offset = writer.write_section(table.bpms().begin(), track_count);
+    header.duration_offset = writer.write_section(table.durations().begin(), track_count);
+    header.rate_offset = writer.write_section(table.rates().begin(), track_count);
+    header.depth_offset = writer.write_section(table.depths().begin(), track_count);
+    header.format_offset = writer.write_section(table.formats().begin(), track_count);
+    header.quality_offset = writer.write_section(table.quality_scores().begin(), track_count);
+    header.title_offset = writer.write_section(titles.data(), titles.size());
+    header.artist_index_offset = writer.write_section(artist_index.data(), artist_index.size());
+    header.artist_ref_offset = writer.write_section(artist_refs.data(), artist_refs.size());
+    header.playlist_offset = writer.write_section(playlists.data(), playlists.size());
+    header.playlist_id_offset = writer.write_section(playlist_ids.data(), playlist_ids.size());
+    header.tuning_offset = writer.write_section(tuning.data(), tuning.size());
+    header.string_pool_offset = writer.write_section(pool.data(), pool.size());
+
+    // Waveforms: create each track once, one at a time, and store its samples
+    header.waveform_offset = writer.begin_section();
+    std::vector<uint64_t> waveform_index(track_count + 1);
+    std::vector<double> samples;
+    uint64_t sample_total = 0;
+    for (size_t row = 0; row < track_count; ++row) {
+        AudioTrack* track = table.materialize(row);
+        samples.resize(track->get_waveform_size());
+        track->get_waveform_copy(samples.data(), samples.size());
+        delete track;
+
+        waveform_index[row] = sample_total;
+        writer.append(samples.data(), samples.size() * sizeof(double));
+        sample_total += samples.size();
+    }
+    waveform_index[track_count] = sample_total;
+    header.waveform_sample_count = sample_total;
+    header.waveform_index_offset = writer.write_section(waveform_index.data(), waveform_index.size());
+
+    header.file_size = writer.get_offset();
+    header.payload_checksum = writer.get_checksum();
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.close();
+    if (!out) {
+        std::cerr << "[ERROR] Failed to write library snapshot: " << temp_path << std::endl;
+        std::remove(temp_path.c_str());
+        return false;
+    }
+    if (std::rename(temp_path.c_str(), snapshot_path.c_str()) != 0) {
+        std::cerr << "[ERROR] Failed to replace library snapshot: " << snapshot_path << std::endl;
+        std::remove(temp_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool LibrarySnapshot::open(const std::string& snapshot_path) {
+    close();
+
+    int fd = ::open(snapshot_path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        if (errno != ENOENT) {
+            std::cout << "[WARNING] Cannot open library snapshot: " << snapshot_path << std::endl;
+        }
+        return false;
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(Header)) {
+        ::close(fd);
+        std::cout << "[WARNING] Not a valid library snapshot: " << snapshot_path << std::endl;
+        return false;
+    }
+    size_t file_size = static_cast<size_t>(st.st_size);
+    void* mapped = ::mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        std::cout << "[WARNING] Cannot map library snapshot: " << snapshot_path << std::endl;
+        return false;
+    }
+
+    data = static_cast<const char*>(mapped);
+    size = file_size;
+    header = reinterpret_cast<const Header*>(data);
+    if (!validate_header()) {
+        close();
+        std::cout << "[WARNING] Not a valid library snapshot: " << snapshot_path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void LibrarySnapshot::close() {
+    if (data != nullptr) {
+        ::munmap(const_cast<char*>(data), size);
+    }
+    data = nullptr;
+    size = 0;
+    header = nullptr;
+}
+
+bool LibrarySnapshot::section_fits(uint64_t offset, uint64_t count, size_t elem_size) const {
+    return offset % 8 == 0 && offset >= sizeof(Header) && offset <= size &&
+           count <= (size - offset) / elem_size;
+}
+
+bool LibrarySnapshot::validate_header() const {
+    if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 || header->version != FORMAT_VERSION ||
+        header->header_size != sizeof(Header) || header->file_size != size) {
+        return false;
+    }
+    // Every section must lie inside the file; n + 1 entries for the two index sections
+    uint64_t n = header->track_count;
+    if (n >= size || header->config_track_count > n) {
+        return false;
+    }
+    return section_fits(header->bpm_offset, n, sizeof(int32_t)) &&
+           section_fits(header->duration_offset, n, sizeof(int32_t)) &&
+           section_fits(header->rate_offset, n, sizeof(int32_t)) &&
+           section_fits(header->depth_offset, n, sizeof(int32_t)) &&
+           section_fits(header->format_offset, n, sizeof(uint8_t)) &&
+           section_fits(header->quality_offset, n, sizeof(double)) &&
+           section_fits(header->title_offset, n, sizeof(StringRef)) &&
+           section_fits(header->artist_index_offset, n + 1, sizeof(uint64_t)) &&
+           section_fits(header->artist_ref_offset, header->artist_ref_count, sizeof(StringRef)) &&
+           section_fits(header->playlist_offset, header->playlist_count, sizeof(PlaylistRef)) &&
+           section_fits(header->playlist_id_offset, header->playlist_id_count, sizeof(int32_t)) &&
+           section_fits(header->tuning_offset, header->tuning_count, sizeof(TuningRef)) &&
+           section_fits(header->string_pool_offset, header->string_pool_size, sizeof(char)) &&
+           section_fits(header->waveform_offset, header->waveform_sample_count, sizeof(double)) &&
+           section_fits(header->waveform_index_offset, n + 1, sizeof(uint64_t));
+}
+
+bool LibrarySnapshot::verify() const {
+    if (!is_open()) {
+        return false;
+    }
+    return fnv1a(FNV_OFFSET_BASIS, data + header->header_size, size - header->header_size) ==
+           header->payload_checksum;
+}
+
+bool LibrarySnapshot::is_stale_for(const std::string& source_path) const {
+    struct stat st;
+    if (::stat(source_path.c_str(), &st) != 0) {
+        return false;
+    }
+    if (static_cast<uint64_t>(st.st_size) != header->source_size) {
+        return true;
+    }
+    uint64_t source_size = 0;
+    uint64_t source_hash = 0;
+    return hash_source(source_path, source_size, source_hash) &&
+           (source_size != header->source_size || source_hash != header->source_hash);
+}
+
+std::string LibrarySnapshot::string_at(const StringRef& ref) const {
+    if (ref.offset > header->string_pool_size || ref.length > header->string_pool_size - ref.offset) {
+        return std::string();
+    }
+    return std::string(data + header->string_pool_offset + ref.offset, static_cast<size_t>(ref.length));
+}
+
+void LibrarySnapshot::read_settings(SessionConfig& config) const {
+    config.app_name = string_at(header->app_name);
+    config.version = string_at(header->version_string);
+    config.playlists_directory = string_at(header->playlists_directory);
+    config.controller_cache_size = header->controller_cache_size;
+    config.cache_order_max_bpm_jump = header->cache_order_max_bpm_jump;
+    config.default_crossfade_time = header->default_crossfade_time;
+    config.bpm_tolerance = header->bpm_tolerance;
+    config.auto_sync = header->auto_sync != 0;
+    config.crossfade_curve = header->crossfade_curve == static_cast<int32_t>(CrossfadeCurve::LINEAR)
+                                 ? CrossfadeCurve::LINEAR : CrossfadeCurve::EQUAL_POWER;
+
+    config.playlists.clear();
+    const PlaylistRef* playlists = section<PlaylistRef>(header->playlist_offset);
+    const int32_t* ids = section<int32_t>(header->playlist_id_offset);
+    for (uint64_t p = 0; p < header->playlist_count; ++p) {
+        const PlaylistRef& ref = playlists[p];
+        if (ref.first_id > header->playlist_id_count || ref.id_count > header->playlist_id_count - ref.first_id) {
+            continue;
+        }
+        config.playlists[string_at(ref.name)] = std::vector<int>(ids + ref.first_id, ids + ref.first_id + ref.id_count);
+    }
+
+    config.tuning.clear();
+    const TuningRef* tuning = section<TuningRef>(header->tuning_offset);
+    for (uint64_t t = 0; t < header->tuning_count; ++t) {
+        config.tuning[string_at(tuning[t].name)] = string_at(tuning[t].value);
+    }
+}
+
+std::string LibrarySnapshot::title(size_t row) const {
+    return string_at(section<StringRef>(header->title_offset)[row]);
+}
+
+std::vector<std::string> LibrarySnapshot::artists(size_t row) const {
+    std::vector<std::string> result;
+    const uint64_t* index = section<uint64_t>(header->artist_index_offset);
+    uint64_t first = index[row];
+    uint64_t last = index[row + 1];
+    if (first > last || last > header->artist_ref_count) {
+        return result;
+    }
+    const StringRef* refs = section<StringRef>(header->artist_ref_offset);
+    for (uint64_t a = first; a < last; ++a) {
+        result.push_back(string_at(refs[a]));
+    }
+    return result;
+}
+
+const double* LibrarySnapshot::waveform(size_t row, size_t& sample_count) const {
+    const uint64_t* index = section<uint64_t>(header->waveform_index_offset);
+    uint64_t first = index[row];
+    uint64_t last = index[row + 1];
+    if (first > last || last > header->waveform_sample_count) {
+        sample_count = 0;
+        return nullptr;
+    }
+    sample_count = static_cast<size_t>(last - first);
+    return section<double>(header->waveform_offset) + first;
+}
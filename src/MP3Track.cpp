@@ -6,10 +6,17 @@
 MP3Track::MP3Track(const std::string& title, const std::vector<std::string>& artists, 
                    int duration, int bpm, int bitrate, bool has_tags)
     : AudioTrack(title, artists, duration, bpm), bitrate(bitrate), has_id3_tags(has_tags) {
-
+    #ifdef DEBUG
     std::cout << "MP3Track created: " << bitrate << " kbps" << std::endl;
+    #endif
 }
 
+MP3Track::MP3Track(const std::string& title, const std::vector<std::string>& artists, 
+                   int duration, int bpm, int bitrate, bool has_tags,
+                   const double* waveform, size_t waveform_samples)
+    : AudioTrack(title, artists, duration, bpm, waveform, waveform_samples),
+      bitrate(bitrate), has_id3_tags(has_tags) {}
+
 // ========== TODO: STUDENTS IMPLEMENT THESE VIRTUAL FUNCTIONS ==========
 
 void MP3Track::load() {
@@ -35,8 +42,8 @@ void MP3Track::analyze_beatgrid() {
      std::cout << "[MP3Track::analyze_beatgrid] Analyzing beat grid for: \"" << title << "\"\n";
     // TODO: Implement MP3-specific beat detection analysis
     // NOTE: Use exactly 2 spaces before each arrow (→) character
-    double beats = ((double)duration_seconds / 60.0) * bpm;
-    double precision_factor = (double)bitrate / 320.0;
+    double beats = get_estimated_beats();
+    double precision_factor = get_precision_factor();
 
     std::cout << " -> Estimated beats: " << beats 
               << " -> Compression precision factor: " << precision_factor 
@@ -48,20 +55,7 @@ void MP3Track::analyze_beatgrid() {
 double MP3Track::get_quality_score() const {
     // TODO: Implement comprehensive quality scoring
     // NOTE: This method does NOT print anything
-
-    double final_score = ((double)bitrate / 320.0) * 100.0;
-    
-    if (has_id3_tags == true) {
-        final_score += 5.0;
-    }
-    
-    if (bitrate < 128) {
-        final_score -= 10.0;
-    }
-    
-    final_score = std::max(0.0, final_score);
-    final_score = std::min(100.0, final_score);
-    return final_score;
+    return compute_quality_score(bitrate, has_id3_tags);
 }
 
 PointerWrapper<AudioTrack> MP3Track::clone() const {
@@ -0,0 +1,95 @@
+#include "MappedFile.h"
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile() : mapped(nullptr), mapped_size(0), buffer() {}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const std::string& path) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (::fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        void* view = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (view != MAP_FAILED) {
+            ::close(fd);
+            mapped = static_cast<const char*>(view);
+            mapped_size = static_cast<size_t>(st.st_size);
+            return true;
+        }
+    }
+
+    // Not mappable: read from the same descriptor (a pipe cannot be reopened)
+    char chunk[65536];
+    for (;;) {
+        ssize_t count = ::read(fd, chunk, sizeof(chunk));
+        if (count > 0) {
+            buffer.append(chunk, static_cast<size_t>(count));
+        } else if (count == 0) {
+            break;
+        } else if (errno != EINTR) {
+            ::close(fd);
+            buffer.clear();
+            return false;
+        }
+    }
+    ::close(fd);
+    return true;
+}
+
+void MappedFile::close() {
+    if (mapped != nullptr) {
+        ::munmap(const_cast<char*>(mapped), mapped_size);
+        mapped = nullptr;
+        mapped_size = 0;
+    }
+    buffer.clear();
+}
+
+bool read_file_at(int directory_fd, const char* name, std::string& buffer) {
+    buffer.clear();
+    int fd = ::openat(directory_fd, name, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        ::close(fd);
+        return false;
+    }
+
+    // Stops short if the file shrank since fstat; growth after it is not read
+    buffer.resize(static_cast<size_t>(st.st_size));
+    size_t filled = 0;
+    while (filled < buffer.size()) {
+        ssize_t count = ::read(fd, &buffer[filled], buffer.size() - filled);
+        if (count > 0) {
+            filled += static_cast<size_t>(count);
+        } else if (count == 0) {
+            break;
+        } else if (errno != EINTR) {
+            ::close(fd);
+            buffer.clear();
+            return false;
+        }
+    }
+    buffer.resize(filled);
+    ::close(fd);
+    return true;
+}
+
+void MappedFile::advise_sequential() const {
+    if (mapped != nullptr) {
+        ::madvise(const_cast<char*>(mapped), mapped_size, MADV_SEQUENTIAL);
+    }
+}
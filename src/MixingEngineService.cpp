@@ -1,18 +1,70 @@
 #include "MixingEngineService.h"
+#include "ParallelFor.h"
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
 #include <iostream>
 #include <memory>
 
+namespace {
+    const size_t BENCHMARK_BLOCK = 4096;       // Samples per kernel call; 3 buffers fit in L2
+    // Render thread wake-up interval while idle, standing in for an audio device's callback period
+    const std::chrono::milliseconds RENDER_PERIOD(1);
+
+    /**
+     * @brief Reference crossfade: per-sample gains straight from libm
+     */
+    void crossfade_reference(const double* outgoing, const double* incoming, double* output, size_t count,
+                             size_t ramp_offset, size_t ramp_length, CrossfadeCurve curve) {
+        const double half_pi = std::acos(0.0);
+        for (size_t i = 0; i < count; ++i) {
+            double t = ramp_length > 1 ? static_cast<double>(ramp_offset + i) / static_cast<double>(ramp_length - 1) : 1.0;
+            double gain_out = curve == CrossfadeCurve::LINEAR ? 1.0 - t : std::cos(t * half_pi);
+            double gain_in = curve == CrossfadeCurve::LINEAR ? t : std::sin(t * half_pi);
+            output[i] = outgoing[i] * gain_out + incoming[i] * gain_in;
+        }
+    }
+
+    typedef void (*CrossfadeFunction)(const double*, const double*, double*, size_t, size_t, size_t, CrossfadeCurve);
+
+    /**
+     * @brief Render a whole fade of sample_count samples in blocks
+     * @return Sum of the output, so the work cannot be optimized away
+     */
+    double render_blocks(CrossfadeFunction fade, const std::vector<double>& outgoing,
+                         const std::vector<double>& incoming, std::vector<double>& output,
+                         size_t sample_count, CrossfadeCurve curve) {
+        double sum = 0.0;
+        for (size_t offset = 0; offset < sample_count; offset += BENCHMARK_BLOCK) {
+            size_t count = std::min(BENCHMARK_BLOCK, sample_count - offset);
+            fade(outgoing.data(), incoming.data(), output.data(), count, offset, sample_count, curve);
+            sum += output[count - 1];
+        }
+        return sum;
+    }
+}
+
 
 /**
  * TODO: Implement MixingEngineService constructor
  */
 MixingEngineService::MixingEngineService()
-    : decks(), active_deck(1), auto_sync(false), bpm_tolerance(0)
+    : decks(), active_deck(1), auto_sync(false), bpm_tolerance(0),
+      commands(), retired(), rendered_samples(0), applied_commands(0), posted_commands(0), reported_samples(0),
+      render_decks(), crossfade_seconds(0), crossfade_curve(CrossfadeCurve::EQUAL_POWER),
+      render_buffer(RENDER_BUFFER_SAMPLES), render_thread()
 {
     decks[0] = nullptr;
     decks[1] = nullptr;
+    render_decks[0] = nullptr;
+    render_decks[1] = nullptr;
     auto_sync = false;
     bpm_tolerance = 0;
+    // Started last: everything it touches is initialized
+    render_thread = std::thread(&MixingEngineService::render_loop, this);
     std::cout << "[MixingEngineService] Initialized with 2 empty decks." << std::endl;
 }
 
@@ -21,11 +73,13 @@ MixingEngineService::MixingEngineService()
  */
 MixingEngineService::~MixingEngineService() {
     std::cout << "[MixingEngineService] Cleaning up decks..." << std::endl;
+    // The render thread owns the decks; it hands them all back before it exits
+    DeckCommand stop = { DeckCommand::STOP, 0, nullptr, 0, CrossfadeCurve::EQUAL_POWER };
+    post(stop);
+    render_thread.join();
+    collect_retired();
     for (int i = 0; i < 2; ++i) {
-        if (decks[i] != nullptr) {
-            delete decks[i];
-            decks[i] = nullptr;
-        }
+        decks[i] = nullptr;
     }
 }
 
@@ -41,6 +95,7 @@ int MixingEngineService::loadTrackToDeck(const AudioTrack& track) {
     bool first_track = false;
 
     std::cout << "\n=== Loading Track to Deck ===" << std::endl;
+    collect_retired();
 
     PointerWrapper<AudioTrack> clonetrack = track.clone();
     if (clonetrack.get() == nullptr) {
@@ -58,10 +113,8 @@ int MixingEngineService::loadTrackToDeck(const AudioTrack& track) {
 
     std::cout << "[Deck Switch] Target deck: " << target_deck << std::endl;
 
-    if (decks[target_deck] != nullptr) {
-        delete decks[target_deck];
-        decks[target_deck] = nullptr;
-    }
+    // A deck still on the target is handed back by the render thread once replaced
+    decks[target_deck] = nullptr;
 
     clonetrack->load();
     clonetrack->analyze_beatgrid();
@@ -72,13 +125,16 @@ int MixingEngineService::loadTrackToDeck(const AudioTrack& track) {
         }
     }
 
+    // From here on the clone is shared with the render thread and only read
     decks[target_deck] = clonetrack.release();
+    DeckCommand load = { DeckCommand::LOAD_DECK, target_deck, decks[target_deck], 0, CrossfadeCurve::EQUAL_POWER };
+    post(load);
     std::cout << "[Load Complete] " << track.get_title() << " is now loaded on deck " << target_deck << std::endl;
 
     if (decks[active_deck] != nullptr && !first_track) {
+        // The render thread fades it out into the new deck, then hands it back
         std::cout << "[Unload] Unloading previous deck " << active_deck 
                   << " (" << decks[active_deck]->get_title() << ")" << std::endl;
-        delete decks[active_deck];
         decks[active_deck] = nullptr;
     }
 
@@ -136,3 +192,185 @@ void MixingEngineService::sync_bpm(const PointerWrapper<AudioTrack>& track) cons
         std::cout << "[Sync BPM] Syncing BPM from  " << new_track_bpm << " to " << bpm_avg << "\n";
     }
 }
+
+// ========== RENDER THREAD ==========
+
+void MixingEngineService::set_crossfade(int seconds, CrossfadeCurve curve) {
+    DeckCommand command = { DeckCommand::SET_CROSSFADE, 0, nullptr, seconds, curve };
+    post(command);
+}
+
+void MixingEngineService::post(const DeckCommand& command) {
+    while (!commands.try_push(command)) {
+        collect_retired();
+        std::this_thread::yield();
+    }
+    posted_commands++;
+}
+
+size_t MixingEngineService::take_rendered_samples() {
+    // The acquire load pairs with the render thread's release increment, so the
+    // samples of every applied command are counted
+    while (applied_commands.load(std::memory_order_acquire) != posted_commands) {
+        collect_retired();
+        std::this_thread::yield();
+    }
+    size_t total = rendered_samples.load(std::memory_order_relaxed);
+    size_t rendered = total - reported_samples;
+    reported_samples = total;
+    return rendered;
+}
+
+void MixingEngineService::collect_retired() {
+    AudioTrack* track = nullptr;
+    while (retired.try_pop(track)) {
+        delete track;
+    }
+}
+
+void MixingEngineService::render_loop() {
+    for (;;) {
+        // Only take a command when whatever it retires is sure to fit, so no hand-back waits
+        DeckCommand command;
+        bool applied = false;
+        while (retired.free_slots() >= 2 && commands.try_pop(command)) {
+            if (!apply_command(command)) {
+                return;
+            }
+            applied_commands.fetch_add(1, std::memory_order_release);
+            applied = true;
+        }
+        if (!applied) {
+            std::this_thread::sleep_for(RENDER_PERIOD);
+        }
+    }
+}
+
+bool MixingEngineService::apply_command(const DeckCommand& command) {
+    switch (command.type) {
+        case DeckCommand::LOAD_DECK: {
+            AudioTrack*& slot = render_decks[command.deck];
+            if (slot != nullptr) {
+                retire(slot);
+            }
+            slot = command.track;
+            AudioTrack*& outgoing = render_decks[1 - command.deck];
+            if (outgoing != nullptr) {
+                if (crossfade_seconds > 0) {
+                    size_t rendered = render_crossfade(*outgoing, *slot, crossfade_seconds, crossfade_curve,
+                                                       render_buffer.data(), render_buffer.size());
+                    rendered_samples.fetch_add(rendered, std::memory_order_relaxed);
+                }
+                retire(outgoing);
+                outgoing = nullptr;
+            }
+            return true;
+        }
+        case DeckCommand::SET_CROSSFADE:
+            crossfade_seconds = command.value;
+            crossfade_curve = command.curve;
+            return true;
+        case DeckCommand::STOP:
+            for (AudioTrack*& deck : render_decks) {
+                if (deck != nullptr) {
+                    retire(deck);
+                    deck = nullptr;
+                }
+            }
+            return false;
+    }
+    return true;
+}
+
+void MixingEngineService::retire(AudioTrack* deck) {
+    bool pushed = retired.try_push(deck);
+    assert(pushed && "render_loop must check retired.free_slots() before taking a command");
+    (void)pushed;
+}
+
+size_t MixingEngineService::render_crossfade(const AudioTrack& outgoing, const AudioTrack& incoming, int seconds,
+                                             CrossfadeCurve curve, std::vector<double>& output) {
+    output.resize(std::min(outgoing.get_waveform_size(), incoming.get_waveform_size()));
+    output.resize(render_crossfade(outgoing, incoming, seconds, curve, output.data(), output.size()));
+    return output.size();
+}
+
+size_t MixingEngineService::render_crossfade(const AudioTrack& outgoing, const AudioTrack& incoming, int seconds,
+                                             CrossfadeCurve curve, double* output, size_t capacity) {
+    size_t outgoing_size = outgoing.get_waveform_size();
+    size_t incoming_size = incoming.get_waveform_size();
+    size_t length = 0;
+    if (seconds > 0 && outgoing.get_duration() > 0) {
+        double samples_per_second = static_cast<double>(outgoing_size) / outgoing.get_duration();
+        length = static_cast<size_t>(std::llround(samples_per_second * seconds));
+    }
+    length = std::min(length, std::min(outgoing_size, incoming_size));
+
+    // The outgoing track's last samples fade into the incoming track's first; a
+    // fade longer than the buffer keeps its start (the ramp is still the full length)
+    size_t count = std::min(length, capacity);
+    if (count > 0) {
+        crossfade(outgoing.get_waveform_data() + (outgoing_size - length), incoming.get_waveform_data(),
+                  output, count, 0, length, curve);
+    }
+    return count;
+}
+
+bool MixingEngineService::run_crossfade_benchmark(size_t sample_count, unsigned thread_count) {
+    unsigned threads = resolve_thread_count(thread_count);
+    sample_count = std::max<size_t>(sample_count, 1);
+    std::cout << "=== Crossfade Benchmark: " << sample_count << " samples per fade, " << threads
+              << (threads == 1 ? " thread" : " threads") << " ===" << std::endl;
+
+    // Fixed pseudo-random signals in [-1, 1), one block each (every block of a fade reads the same input)
+    std::vector<double> outgoing(BENCHMARK_BLOCK), incoming(BENCHMARK_BLOCK);
+    uint64_t state = 88172645463325252ULL;
+    for (size_t i = 0; i < BENCHMARK_BLOCK; ++i) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        outgoing[i] = static_cast<double>(state >> 11) / 4503599627370496.0 - 1.0;
+        incoming[i] = -outgoing[i] * 0.5;
+    }
+
+    bool agree = true;
+    const CrossfadeCurve curves[] = { CrossfadeCurve::EQUAL_POWER, CrossfadeCurve::LINEAR };
+    for (CrossfadeCurve curve : curves) {
+        // Check the kernel against the reference over one whole (short) fade first
+        std::vector<double> expected(BENCHMARK_BLOCK), actual(BENCHMARK_BLOCK);
+        crossfade_reference(outgoing.data(), incoming.data(), expected.data(), BENCHMARK_BLOCK, 0, BENCHMARK_BLOCK, curve);
+        crossfade(outgoing.data(), incoming.data(), actual.data(), BENCHMARK_BLOCK, 0, BENCHMARK_BLOCK, curve);
+        double max_error = 0.0;
+        for (size_t i = 0; i < BENCHMARK_BLOCK; ++i) {
+            max_error = std::max(max_error, std::fabs(expected[i] - actual[i]));
+        }
+        if (max_error > 1e-6) {
+            agree = false;
+        }
+
+        double rates[2];
+        const CrossfadeFunction functions[2] = { crossfade_reference, crossfade };
+        for (size_t f = 0; f < 2; ++f) {
+            std::vector<double> sums(threads, 0.0);
+            auto start = std::chrono::steady_clock::now();
+            parallel_for(threads, threads, [&](size_t begin, size_t end) {
+                std::vector<double> output(BENCHMARK_BLOCK);
+                for (size_t t = begin; t < end; ++t) {
+                    sums[t] = render_blocks(functions[f], outgoing, incoming, output, sample_count, curve);
+                }
+            });
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            rates[f] = static_cast<double>(sample_count) / std::max(seconds, 1e-9);     // Per thread
+        }
+
+        std::cout << std::left << std::setw(12) << crossfade_curve_name(curve) << std::right << std::fixed
+                  << std::setprecision(1) << " libm loop: " << std::setw(8) << rates[0] / 1e6
+                  << " Msamples/s per core, kernel: " << std::setw(8) << rates[1] / 1e6
+                  << " Msamples/s per core (" << std::setprecision(2) << rates[1] / rates[0] << "x), max error "
+                  << std::scientific << std::setprecision(1) << max_error << std::defaultfloat << std::endl;
+    }
+    if (!agree) {
+        std::cout << "[ERROR] Crossfade kernel differs from the reference by more than 1e-6" << std::endl;
+    }
+    return agree;
+}
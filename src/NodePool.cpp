@@ -0,0 +1,62 @@
+#include "NodePool.h"
+#include <algorithm>
+#include <iostream>
+
+NodePool::NodePool(size_t slot_size, size_t slots_per_slab)
+    : slot_size(0), slots_per_slab(std::max<size_t>(1, slots_per_slab)), slabs(),
+      free_list(nullptr), bump(nullptr), bump_end(nullptr), stats() {
+    // Every slot must be able to hold a FreeSlot and stay suitably aligned
+    const size_t alignment = alignof(std::max_align_t);
+    size_t size = std::max(slot_size, sizeof(FreeSlot));
+    this->slot_size = (size + alignment - 1) / alignment * alignment;
+}
+
+NodePool::~NodePool() {
+    for (char* slab : slabs) {
+        delete[] slab;
+    }
+    slabs.clear();
+}
+
+void* NodePool::allocate() {
+    void* slot;
+    if (free_list != nullptr) {
+        slot = free_list;
+        free_list = free_list->next;
+    } else {
+        if (bump == bump_end) {
+            // operator new[] memory is aligned for any fundamental type
+            char* slab = new char[slot_size * slots_per_slab];
+            slabs.push_back(slab);
+            bump = slab;
+            bump_end = slab + slot_size * slots_per_slab;
+            stats.slab_allocations++;
+        }
+        slot = bump;
+        bump += slot_size;
+    }
+
+    stats.slot_allocations++;
+    stats.slots_in_use++;
+    stats.peak_slots_in_use = std::max(stats.peak_slots_in_use, stats.slots_in_use);
+    return slot;
+}
+
+void NodePool::deallocate(void* slot) {
+    if (slot == nullptr) {
+        return;
+    }
+    FreeSlot* freed = static_cast<FreeSlot*>(slot);
+    freed->next = free_list;
+    free_list = freed;
+
+    stats.slot_frees++;
+    stats.slots_in_use--;
+}
+
+void NodePool::displayStats(const std::string& name) const {
+    std::cout << "[NodePool] " << name << ": " << stats.slot_allocations << " allocations, "
+              << stats.slot_frees << " frees, " << stats.slab_allocations << " slab allocations ("
+              << slots_per_slab << " x " << slot_size << " bytes), peak "
+              << stats.peak_slots_in_use << " in use" << std::endl;
+}
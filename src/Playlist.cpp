@@ -2,6 +2,30 @@
 #include "AudioTrack.h"
 #include <iostream>
 #include <algorithm>
+// =========================================================
+// PlaylistNode allocation
+// =========================================================
+
+NodePool& Playlist::node_pool() {
+    static NodePool pool(sizeof(PlaylistNode));
+    return pool;
+}
+
+void* PlaylistNode::operator new(size_t size) {
+    if (size != sizeof(PlaylistNode)) {
+        return ::operator new(size);
+    }
+    return Playlist::node_pool().allocate();
+}
+
+void PlaylistNode::operator delete(void* node, size_t size) noexcept {
+    if (size != sizeof(PlaylistNode)) {
+        ::operator delete(node);
+        return;
+    }
+    Playlist::node_pool().deallocate(node);
+}
+
 Playlist::Playlist(const std::string& name) 
     : head(nullptr), playlist_name(name), track_count(0) {
     std::cout << "Created playlist: " << name << std::endl;
@@ -18,45 +42,17 @@ Playlist::~Playlist() {
     std::cout << "Destroying playlist: " << playlist_name << std::endl;
     #endif
 
-    PlaylistNode* current = head; //start from the head
-    PlaylistNode* next_node = nullptr;
-
-    while (current != nullptr) { //iterating through all the list
-        next_node = current->next; //always keeping the next_node pointer
-        delete current-> track; //in phase 4 we found out that each playlist holds cloned_tracks, therefore their deletion will happen during playlist destruction
-        delete current; //delete the current node we're on
-        current = next_node; //moving to the next node
-    }
-
+    // Nodes still linked from another playlist version survive; the rest are
+    // deleted here. Tracks are borrowed and stay with their owner
+    release(head);
     head = nullptr; //restart the head
 }
 
 // Copy Constructor
 Playlist::Playlist(const Playlist& other) 
-    : head(nullptr), playlist_name(other.playlist_name), track_count(0) {
-    
-    // Start iterating from the source head
-    PlaylistNode* current_source = other.head;
-    
-    // Keep track of the last added node for efficient linking
-    PlaylistNode* last_added = nullptr;
-
-    while (current_source != nullptr) {
-        // Create a new Node (Deep Copy of the structure)
-        // But pass the SAME track pointer (Shallow Copy of the content / Borrowing)
-        PlaylistNode* new_node = new PlaylistNode(current_source->track);
-
-        if (head == nullptr) {
-            head = new_node; // Set the first node
-        } else {
-            last_added->next = new_node; // Link to the previous node
-        }
-
-        // Advance pointers
-        last_added = new_node;
-        current_source = current_source->next;
-        track_count++;
-    }
+    : head(other.head), playlist_name(other.playlist_name), track_count(other.track_count) {
+    // Share the whole chain with the source instead of re-allocating every node
+    retain(head);
 }
 
 // Copy Assignment Operator
@@ -66,40 +62,63 @@ Playlist& Playlist::operator=(const Playlist& other) {
         return *this; 
     }
 
-    // 2. Clean up existing resources (same logic as destructor)
-    PlaylistNode* current = head;
-    while (current != nullptr) {
-        PlaylistNode* next_node = current->next;
-        delete current; // Delete the Node, NOT the Track
-        current = next_node;
-    }
-    head = nullptr;
-    track_count = 0;
+    // 2. Take the new chain before dropping ours (other may be a suffix of it)
+    retain(other.head);
+    release(head);
 
-    // 3. Copy data from other (same logic as Copy Constructor)
+    // 3. Copy data from other
+    head = other.head;
     playlist_name = other.playlist_name;
-    
-    PlaylistNode* current_source = other.head;
-    PlaylistNode* last_added = nullptr;
+    track_count = other.track_count;
 
-    while (current_source != nullptr) {
-        // Create new node referencing the same track
-        PlaylistNode* new_node = new PlaylistNode(current_source->track);
+    return *this;
+}
 
-        if (head == nullptr) {
-            head = new_node;
-        } else {
-            last_added->next = new_node;
-        }
+// Move Constructor
+Playlist::Playlist(Playlist&& other) noexcept
+    : head(other.head), playlist_name(std::move(other.playlist_name)), track_count(other.track_count) {
+    // Leave the source as a valid empty playlist
+    other.head = nullptr;
+    other.track_count = 0;
+}
 
-        last_added = new_node;
-        current_source = current_source->next;
-        track_count++;
-    }
+// Move Assignment Operator
+Playlist& Playlist::operator=(Playlist&& other) noexcept {
+    if (this != &other) {
+        release(head);
+
+        head = other.head;
+        playlist_name = std::move(other.playlist_name);
+        track_count = other.track_count;
 
+        other.head = nullptr;
+        other.track_count = 0;
+    }
     return *this;
 }
 
+void Playlist::swap(Playlist& other) noexcept {
+    std::swap(head, other.head);
+    playlist_name.swap(other.playlist_name);
+    std::swap(track_count, other.track_count);
+}
+
+void Playlist::retain(PlaylistNode* node) {
+    if (node != nullptr) {
+        node->ref_count++;
+    }
+}
+
+void Playlist::release(PlaylistNode* node) {
+    // Each freed node drops its link to the next one, so keep walking
+    // until we reach a node that is still referenced elsewhere
+    while (node != nullptr && --node->ref_count == 0) {
+        PlaylistNode* next_node = node->next;
+        delete node;
+        node = next_node;
+    }
+}
+
 void Playlist::add_track(AudioTrack* track) {
     if (!track) {
         std::cout << "[Error] Cannot add null track to playlist" << std::endl;
@@ -119,26 +138,47 @@ void Playlist::add_track(AudioTrack* track) {
 }
 
 void Playlist::remove_track(const std::string& title) {
+    // Collect the nodes in front of the track to remove
+    std::vector<PlaylistNode*> path;
     PlaylistNode* current = head;
-    PlaylistNode* prev = nullptr;
 
     // Find the track to remove
     while (current && current->track->get_title() != title) {
-        prev = current;
+        path.push_back(current);
         current = current->next;
     }
 
     if (current) {
-        // Remove from linked list
-        if (prev) {
-            prev->next = current->next;
+        // Nodes from the first shared one onwards are visible to other
+        // playlist versions and must not be relinked in place
+        size_t first_shared = path.size();
+        for (size_t i = 0; i < path.size(); ++i) {
+            if (path[i]->ref_count > 1) {
+                first_shared = i;
+                break;
+            }
+        }
+
+        // Rebuild the shared part of the prefix on top of the remaining suffix
+        PlaylistNode* rest = current->next;
+        retain(rest);
+        for (size_t i = path.size(); i > first_shared; --i) {
+            PlaylistNode* copy = new PlaylistNode(path[i - 1]->track);
+            copy->next = rest;
+            rest = copy;
+        }
+
+        // Relink and drop our link to the old chain; this deletes the removed
+        // node only if no other playlist still uses it
+        PlaylistNode* old_chain;
+        if (first_shared == 0) {
+            old_chain = head;
+            head = rest;
         } else {
-            head = current->next;
+            old_chain = path[first_shared - 1]->next;
+            path[first_shared - 1]->next = rest;
         }
-        
-        //delete the node
-        delete current->track; //in phase 4 we found out that each playlist holds cloned_tracks, therefore their deletion will happen during playlist destruction
-        delete current;
+        release(old_chain);
 
         track_count--;
         std::cout << "Removed '" << title << "' from playlist" << std::endl;
@@ -215,4 +255,88 @@ std::vector<AudioTrack*> Playlist::getTracks() const {
         current = current->next;
     }
     return tracks;
+}
+
+bool Playlist::reorder(const std::vector<size_t>& order) {
+    std::vector<PlaylistNode*> nodes;
+    bool shared = false;
+    for (PlaylistNode* current = head; current; current = current->next) {
+        nodes.push_back(current);
+        if (current->ref_count > 1) {
+            shared = true;
+        }
+    }
+
+    // Validate that order is a permutation of the current positions
+    if (order.size() != nodes.size()) {
+        std::cout << "[Error] Cannot reorder playlist '" << playlist_name << "': order has "
+                  << order.size() << " entries, playlist has " << nodes.size() << std::endl;
+        return false;
+    }
+    std::vector<bool> seen(nodes.size(), false);
+    for (size_t position : order) {
+        if (position >= nodes.size() || seen[position]) {
+            std::cout << "[Error] Cannot reorder playlist '" << playlist_name << "': invalid order" << std::endl;
+            return false;
+        }
+        seen[position] = true;
+    }
+    if (nodes.empty()) {
+        return true;
+    }
+
+    if (!shared) {
+        // We own every node: relink in place, each node keeps exactly one incoming link
+        for (size_t k = 0; k + 1 < order.size(); ++k) {
+            nodes[order[k]]->next = nodes[order[k + 1]];
+        }
+        nodes[order.back()]->next = nullptr;
+        head = nodes[order.front()];
+    } else {
+        // Another playlist version still sees these nodes, build our own chain
+        PlaylistNode* rest = nullptr;
+        for (size_t k = order.size(); k > 0; --k) {
+            PlaylistNode* copy = new PlaylistNode(nodes[order[k - 1]]->track);
+            copy->next = rest;
+            rest = copy;
+        }
+        release(head);
+        head = rest;
+    }
+    return true;
+}
+
+void Playlist::remap_tracks(const std::unordered_map<const AudioTrack*, AudioTrack*>& mapping) {
+    // Build a private chain so other playlist versions keep their tracks
+    std::vector<AudioTrack*> tracks = getTracks();
+    PlaylistNode* rest = nullptr;
+    for (size_t k = tracks.size(); k > 0; --k) {
+        auto it = mapping.find(tracks[k - 1]);
+        PlaylistNode* node = new PlaylistNode(it != mapping.end() ? it->second : tracks[k - 1]);
+        node->next = rest;
+        rest = node;
+    }
+    release(head);
+    head = rest;
+}
+
+size_t Playlist::remove_track_object(const AudioTrack* track) {
+    std::vector<AudioTrack*> tracks = getTracks();
+    size_t removed = static_cast<size_t>(std::count(tracks.begin(), tracks.end(), track));
+    if (removed == 0) {
+        return 0;
+    }
+    // Build a private chain without the track so other playlist versions keep it
+    PlaylistNode* rest = nullptr;
+    for (size_t k = tracks.size(); k > 0; --k) {
+        if (tracks[k - 1] != track) {
+            PlaylistNode* node = new PlaylistNode(tracks[k - 1]);
+            node->next = rest;
+            rest = node;
+        }
+    }
+    release(head);
+    head = rest;
+    track_count -= static_cast<int>(removed);
+    return removed;
 }
\ No newline at end of file
@@ -0,0 +1,347 @@
+#include "PlaylistOptimizer.h"
+#include "ParallelFor.h"
+#include <algorithm>
+#include <cstdlib>
+#include <list>
+#include <unordered_map>
+
+namespace {
+    const size_t NONE = static_cast<size_t>(-1);
+    const unsigned STARTS_PER_THREAD = 2;
+    const size_t MIN_STARTS = 4;
+    const size_t MAX_LOCAL_SEARCH_PASSES = 100;
+    const size_t MAX_OR_OPT_SEGMENT = 3;
+    // Moves only look this many positions away; the greedy seeds are already
+    // BPM-local, so long-range moves almost never pay off on real sets
+    const size_t MOVE_WINDOW = 128;
+}
+
+PlaylistOptimizer::PlaylistOptimizer(int bpm_tolerance, bool auto_sync, unsigned thread_count)
+    : bpm_tolerance(bpm_tolerance), auto_sync(auto_sync), thread_count(resolve_thread_count(thread_count)),
+      sync_penalty(100) {}
+
+long long PlaylistOptimizer::edge_cost(int a, int b) const {
+    long long jump = std::abs(a - b);
+    return (jump > bpm_tolerance) ? jump + sync_penalty : jump;
+}
+
+long long PlaylistOptimizer::path_cost(const std::vector<int>& bpms, const std::vector<size_t>& order) const {
+    long long total = 0;
+    for (size_t k = 1; k < order.size(); ++k) {
+        total += edge_cost(bpms[order[k - 1]], bpms[order[k]]);
+    }
+    return total;
+}
+
+PlaylistOptimizer::OrderStats PlaylistOptimizer::evaluate(const std::vector<int>& bpms,
+                                                          const std::vector<size_t>& order) const {
+    OrderStats stats;
+    if (order.empty()) {
+        return stats;
+    }
+
+    // Same rules as MixingEngineService::loadTrackToDeck: an out-of-tolerance
+    // track is synced to the average of the active deck and itself
+    int active_bpm = bpms[order[0]];
+    for (size_t k = 1; k < order.size(); ++k) {
+        int next_bpm = bpms[order[k]];
+        int jump = std::abs(active_bpm - next_bpm);
+        stats.total_bpm_jump += jump;
+        if (jump > bpm_tolerance) {
+            stats.sync_events++;
+            active_bpm = auto_sync ? (active_bpm + next_bpm) / 2 : next_bpm;
+        } else {
+            active_bpm = next_bpm;
+        }
+    }
+    return stats;
+}
+
+std::vector<size_t> PlaylistOptimizer::greedy_order(const std::vector<int>& bpms,
+                                                    const std::vector<size_t>& sorted,
+                                                    size_t start_rank) const {
+    // In one dimension the nearest unvisited track is always the closest
+    // unvisited neighbour in BPM order, so keep the unvisited ranks in a
+    // doubly linked list and unlink them as we go
+    size_t n = sorted.size();
+    std::vector<size_t> left(n), right(n);
+    for (size_t r = 0; r < n; ++r) {
+        left[r] = (r == 0) ? NONE : r - 1;
+        right[r] = (r + 1 == n) ? NONE : r + 1;
+    }
+
+    std::vector<size_t> order;
+    order.reserve(n);
+    size_t current = start_rank;
+    while (current != NONE) {
+        order.push_back(sorted[current]);
+
+        size_t l = left[current];
+        size_t r = right[current];
+        if (l != NONE) right[l] = r;
+        if (r != NONE) left[r] = l;
+
+        if (l == NONE) {
+            current = r;
+        } else if (r == NONE) {
+            current = l;
+        } else {
+            int bpm = bpms[sorted[current]];
+            current = (std::abs(bpms[sorted[l]] - bpm) <= std::abs(bpms[sorted[r]] - bpm)) ? l : r;
+        }
+    }
+    return order;
+}
+
+bool PlaylistOptimizer::two_opt_pass(const std::vector<int>& bpms, std::vector<size_t>& order) const {
+    size_t n = order.size();
+    bool improved = false;
+
+    for (size_t i = 0; i + 1 < n; ++i) {
+        size_t j_end = std::min(n, i + 1 + MOVE_WINDOW);
+        for (size_t j = i + 1; j < j_end; ++j) {
+            // Reversing order[i..j] only changes the two edges at its ends
+            long long before = 0;
+            long long after = 0;
+            if (i > 0) {
+                before += edge_cost(bpms[order[i - 1]], bpms[order[i]]);
+                after += edge_cost(bpms[order[i - 1]], bpms[order[j]]);
+            }
+            if (j + 1 < n) {
+                before += edge_cost(bpms[order[j]], bpms[order[j + 1]]);
+                after += edge_cost(bpms[order[i]], bpms[order[j + 1]]);
+            }
+            if (after < before) {
+                std::reverse(order.begin() + i, order.begin() + j + 1);
+                improved = true;
+            }
+        }
+    }
+    return improved;
+}
+
+bool PlaylistOptimizer::or_opt_pass(const std::vector<int>& bpms, std::vector<size_t>& order) const {
+    size_t n = order.size();
+    bool improved = false;
+
+    for (size_t len = 1; len <= MAX_OR_OPT_SEGMENT && len < n; ++len) {
+        for (size_t i = 0; i + len <= n; ++i) {
+            size_t last = i + len - 1;
+            int first_bpm = bpms[order[i]];
+            int last_bpm = bpms[order[last]];
+
+            // Cost saved by cutting order[i..last] out and closing the gap
+            long long removed = 0;
+            if (i > 0) removed += edge_cost(bpms[order[i - 1]], first_bpm);
+            if (last + 1 < n) removed += edge_cost(last_bpm, bpms[order[last + 1]]);
+            if (i > 0 && last + 1 < n) removed -= edge_cost(bpms[order[i - 1]], bpms[order[last + 1]]);
+
+            // Try every gap outside the segment; gap g sits between order[g-1] and order[g]
+            size_t g_begin = (i > MOVE_WINDOW) ? i - MOVE_WINDOW : 0;
+            size_t g_end = std::min(n, last + 1 + MOVE_WINDOW);
+            for (size_t g = g_begin; g <= g_end; ++g) {
+                if (g >= i && g <= last + 1) {
+                    continue;
+                }
+                long long added = 0;
+                if (g > 0) added += edge_cost(bpms[order[g - 1]], first_bpm);
+                if (g < n) added += edge_cost(last_bpm, bpms[order[g]]);
+                if (g > 0 && g < n) added -= edge_cost(bpms[order[g - 1]], bpms[order[g]]);
+
+                if (added < removed) {
+                    if (g < i) {
+                        std::rotate(order.begin() + g, order.begin() + i, order.begin() + last + 1);
+                    } else {
+                        std::rotate(order.begin() + i, order.begin() + last + 1, order.begin() + g);
+                    }
+                    improved = true;
+                    break;
+                }
+            }
+        }
+    }
+    return improved;
+}
+
+void PlaylistOptimizer::local_search(const std::vector<int>& bpms, std::vector<size_t>& order) const {
+    for (size_t pass = 0; pass < MAX_LOCAL_SEARCH_PASSES; ++pass) {
+        bool changed = two_opt_pass(bpms, order);
+        changed = or_opt_pass(bpms, order) || changed;
+        if (!changed) {
+            break;
+        }
+    }
+}
+
+std::vector<size_t> PlaylistOptimizer::optimize(const std::vector<int>& bpms) const {
+    size_t n = bpms.size();
+    std::vector<size_t> identity(n);
+    for (size_t i = 0; i < n; ++i) {
+        identity[i] = i;
+    }
+    if (n < 3) {
+        return identity;
+    }
+
+    std::vector<size_t> sorted(identity);
+    std::stable_sort(sorted.begin(), sorted.end(),
+                     [&bpms](size_t a, size_t b) { return bpms[a] < bpms[b]; });
+
+    // Greedy tours started at ranks spread evenly over the BPM range (always
+    // including both ends), each polished by local search
+    size_t start_count = std::min(n, std::max(MIN_STARTS, static_cast<size_t>(thread_count) * STARTS_PER_THREAD));
+    std::vector<std::vector<size_t>> candidates(start_count);
+
+    parallel_for(start_count, thread_count, [&](size_t begin, size_t end) {
+        for (size_t c = begin; c < end; ++c) {
+            size_t start_rank = c * (n - 1) / (start_count - 1);
+            candidates[c] = greedy_order(bpms, sorted, start_rank);
+            local_search(bpms, candidates[c]);
+        }
+    });
+
+    // Pick the candidate that does best under the mixer's real sync rules;
+    // never return something worse than the order we were given
+    std::vector<size_t> best = identity;
+    OrderStats best_stats = evaluate(bpms, identity);
+    long long best_cost = path_cost(bpms, identity);
+    for (const std::vector<size_t>& candidate : candidates) {
+        OrderStats stats = evaluate(bpms, candidate);
+        long long cost = path_cost(bpms, candidate);
+        if (stats.sync_events < best_stats.sync_events ||
+            (stats.sync_events == best_stats.sync_events && cost < best_cost)) {
+            best = candidate;
+            best_stats = stats;
+            best_cost = cost;
+        }
+    }
+    return best;
+}
+
+
+std::vector<size_t> PlaylistOptimizer::cache_order(const std::vector<std::string>& keys, const std::vector<int>& bpms,
+                                                   size_t capacity, int max_bpm_jump) {
+    size_t n = keys.size();
+    std::vector<size_t> order;
+    order.reserve(n);
+    if (capacity == 0) {
+        for (size_t i = 0; i < n; ++i) {
+            order.push_back(i);
+        }
+        return order;
+    }
+
+    // Positions of every occurrence of each key, in play order
+    std::unordered_map<std::string, std::vector<size_t>> occurrences;
+    for (size_t i = 0; i < n; ++i) {
+        occurrences[keys[i]].push_back(i);
+    }
+
+    struct PendingRepeat {
+        size_t position;    // Index into keys of the pulled repeat
+        size_t deadline;    // Last output slot where it is still a cache hit
+    };
+    std::vector<PendingRepeat> pending;
+    std::vector<bool> emitted(n, false);
+    std::vector<bool> pulled(n, false);
+    size_t cursor = 0;
+
+    auto fits = [&](size_t position) {
+        return max_bpm_jump <= 0 || order.empty() ||
+               std::abs(bpms[order.back()] - bpms[position]) <= max_bpm_jump;
+    };
+    auto take_pending = [&](size_t index) {
+        size_t position = pending[index].position;
+        pending.erase(pending.begin() + index);
+        return position;
+    };
+
+    while (order.size() < n) {
+        size_t slot = order.size();
+        size_t chosen = NONE;
+
+        size_t earliest = NONE;
+        for (size_t p = 0; p < pending.size(); ++p) {
+            if (earliest == NONE || pending[p].deadline < pending[earliest].deadline) {
+                earliest = p;
+            }
+        }
+
+        // A repeat at its deadline goes now, or back to its original place
+        if (earliest != NONE && pending[earliest].deadline <= slot) {
+            if (fits(pending[earliest].position)) {
+                chosen = take_pending(earliest);
+            } else {
+                pulled[take_pending(earliest)] = false;
+                continue;
+            }
+        }
+
+        if (chosen == NONE) {
+            while (cursor < n && emitted[cursor]) {
+                cursor++;
+            }
+            if (cursor == n) {
+                break;
+            }
+            if (pulled[cursor]) {
+                // The repeat came up in the original order before its deadline
+                for (size_t p = 0; p < pending.size(); ++p) {
+                    if (pending[p].position == cursor) {
+                        chosen = take_pending(p);
+                        break;
+                    }
+                }
+            } else if (!fits(cursor)) {
+                // Bridge the BPM gap with a pending repeat if one fits
+                for (size_t p = 0; p < pending.size(); ++p) {
+                    if (fits(pending[p].position)) {
+                        chosen = take_pending(p);
+                        break;
+                    }
+                }
+            }
+            if (chosen == NONE) {
+                chosen = cursor;
+            }
+        }
+
+        order.push_back(chosen);
+        emitted[chosen] = true;
+
+        // Pull the next repeat of this track into the cache's reuse window
+        const std::vector<size_t>& positions = occurrences[keys[chosen]];
+        for (size_t position : positions) {
+            if (!emitted[position]) {
+                if (!pulled[position]) {
+                    pulled[position] = true;
+                    PendingRepeat repeat = { position, slot + capacity };
+                    pending.push_back(repeat);
+                }
+                break;
+            }
+        }
+    }
+    return order;
+}
+
+size_t PlaylistOptimizer::predict_cache_hits(const std::vector<std::string>& keys, const std::vector<size_t>& order,
+                                             size_t capacity) {
+    // Most recently used first, same policy as LRUCache
+    std::list<std::string> cached;
+    size_t hits = 0;
+    for (size_t position : order) {
+        const std::string& key = keys[position];
+        std::list<std::string>::iterator it = std::find(cached.begin(), cached.end(), key);
+        if (it != cached.end()) {
+            hits++;
+            cached.splice(cached.begin(), cached, it);
+        } else if (capacity > 0) {
+            if (cached.size() >= capacity) {
+                cached.pop_back();
+            }
+            cached.push_front(key);
+        }
+    }
+    return hits;
+}
\ No newline at end of file
@@ -1,24 +1,186 @@
 #include "SessionFileParser.h"
+#include "MappedFile.h"
+#include "ParallelFor.h"
+#include "ConfigCache.h"
+#include "ConfigurationManager.h"
 #include <iostream>
-#include <sstream>
 #include <algorithm>
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <dirent.h>
+
+namespace {
+// Target size of a parallel parsing chunk (a chunk runs on to the next newline)
+const size_t CONFIG_CHUNK_BYTES = 1 << 20;
+// Smallest config given a parsed-config cache; smaller ones parse about as fast as the cache loads
+const size_t CONFIG_CACHE_MIN_BYTES = 1 << 20;
+}
 
 // ========== PUBLIC METHODS (PROVIDED FOR STUDENTS) ==========
 
 bool SessionFileParser::parse_config_file(const std::string& config_path, SessionConfig& config) {
-    std::ifstream file(config_path);
+    return parse_config_file(config_path, config, [&config](std::vector<SessionConfig::TrackInfo>& batch) {
+        for (SessionConfig::TrackInfo& track_info : batch) {
+            config.library_tracks.push_back(std::move(track_info));
+        }
+    });
+}
+
+bool SessionFileParser::parse_config_file(const std::string& config_path, SessionConfig& config,
+                                          const TrackBatchHandler& on_tracks, size_t batch_size,
+                                          unsigned thread_count, bool use_cache) {
+    MappedFile file;
     
-    if (!file.is_open()) {
+    if (!file.open(config_path)) {
         std::cout << "[ERROR] Cannot open config file: " << config_path << std::endl;
         return false;
     }
+    file.advise_sequential();
     
-    std::string line;
-    int line_number = 0;
+    size_t track_count = 0;
+    if (batch_size == 0) {
+        batch_size = 1;
+    }
     
-    while (std::getline(file, line)) {
-        line_number++;
-        line = trim_string(line);
+    // A large config whose contents were parsed before is replayed from its cache
+    std::unique_ptr<ConfigCache> cache;
+    const std::string cache_path = ConfigCache::path_for(config_path);
+    if (use_cache && file.size() >= CONFIG_CACHE_MIN_BYTES) {
+        uint64_t content_hash = ConfigCache::hash_contents(file.data(), file.size());
+        // Settings are decoded into a scratch object: config sees nothing unless the
+        // whole cache is readable, and the handler gets the tracks a batch at a time
+        SessionConfig cached;
+        unsigned assigned = 0;
+        switch (ConfigCache::replay(cache_path, content_hash, file.size(), batch_size, on_tracks, cached, assigned,
+                                    track_count)) {
+            case ConfigCache::LoadResult::LOADED: {
+                apply_settings(cached, assigned, config);
+                for (std::pair<const std::string, std::vector<int>>& playlist : cached.playlists) {
+                    config.playlists[playlist.first] = std::move(playlist.second);
+                }
+                std::cout << "Parsed config file (cached): " << track_count << " tracks found, "
+                          << config.playlists.size() << " playlists found" << std::endl;
+                return true;
+            }
+            case ConfigCache::LoadResult::CORRUPT:
+                // Parsed as if there were no cache; the write below replaces the sidecar
+                std::cout << "[WARNING] Config cache is corrupt; parsing instead: " << cache_path << std::endl;
+                break;
+            case ConfigCache::LoadResult::MISSING:
+                break;
+        }
+        cache.reset(new ConfigCache(cache_path, content_hash, file.size()));
+    }
+    SessionConfig file_settings;        // What the whole file assigns, for the cache
+    unsigned file_assigned = 0;
+    std::ostringstream warning_text;
+    
+    // Each round cuts up to one chunk per worker off the file, parses them in
+    // parallel, then merges them in file order on this thread
+    unsigned workers = resolve_thread_count(thread_count);
+    std::vector<ConfigChunk> chunks(workers);
+    const char* cursor = file.data();
+    const char* file_end = cursor + file.size();
+    int first_line = 1;
+    while (cursor != file_end) {
+        size_t chunk_count = 0;
+        while (chunk_count < workers && cursor != file_end) {
+            // End each chunk just past a newline, so no line is split
+            const char* stop = file_end;
+            if (static_cast<size_t>(file_end - cursor) > CONFIG_CHUNK_BYTES) {
+                const char* from = cursor + CONFIG_CHUNK_BYTES - 1;
+                const void* newline = std::memchr(from, '\n', static_cast<size_t>(file_end - from));
+                stop = newline ? static_cast<const char*>(newline) + 1 : file_end;
+            }
+            chunks[chunk_count++].text = StringSlice(cursor, static_cast<size_t>(stop - cursor));
+            cursor = stop;
+        }
+        
+        parallel_for(chunk_count, workers, [&chunks, batch_size](size_t begin, size_t end) {
+            for (size_t c = begin; c < end; ++c) {
+                parse_config_chunk(chunks[c], batch_size);
+            }
+        });
+        
+        for (size_t c = 0; c < chunk_count; ++c) {
+            ConfigChunk& chunk = chunks[c];
+            
+            // Hand over the chunk's batches; each warning is printed after the
+            // tracks that precede its line and before the batch holding the next one
+            auto emit_warning = [&](const ConfigWarning& warning) {
+                if (cache) {
+                    warning_text.str(std::string());
+                    print_warning(warning_text, warning, first_line);
+                    cache->add_warning(warning_text.str());
+                    std::cout << warning_text.str() << std::endl;
+                } else {
+                    print_warning(std::cout, warning, first_line);
+                    std::cout << std::endl;
+                }
+            };
+            size_t next_warning = 0;
+            for (size_t first = 0; first < chunk.track_count; first += batch_size) {
+                std::vector<SessionConfig::TrackInfo>& batch = chunk.batches[first / batch_size];
+                batch.resize(std::min(batch_size, chunk.track_count - first));
+                while (next_warning < chunk.warnings.size() &&
+                       chunk.warnings[next_warning].track_position < first + batch.size()) {
+                    emit_warning(chunk.warnings[next_warning++]);
+                }
+                if (cache) {
+                    cache->add_tracks(batch);   // Before the handler can move from them
+                }
+                on_tracks(batch);
+            }
+            while (next_warning < chunk.warnings.size()) {
+                emit_warning(chunk.warnings[next_warning++]);
+            }
+            track_count += chunk.track_count;
+            
+            // Later chunks overwrite earlier settings, as later lines do
+            apply_settings(chunk.settings, chunk.assigned, config);
+            if (cache) {
+                apply_settings(chunk.settings, chunk.assigned, file_settings);
+                file_assigned |= chunk.assigned;
+            }
+            for (std::pair<std::string, std::vector<int>>& playlist : chunk.playlists) {
+                if (cache) {
+                    file_settings.playlists[playlist.first] = playlist.second;
+                }
+                config.playlists[playlist.first] = std::move(playlist.second);
+            }
+            
+            first_line += chunk.line_count;
+        }
+    }
+    
+    file.close();
+    if (cache) {
+        cache->write(file_settings, file_assigned);
+    }
+    
+    std::cout << "Parsed config file: " << track_count << " tracks found, " 
+              << config.playlists.size() << " playlists found" << std::endl;
+    return true;
+}
+
+void SessionFileParser::parse_config_chunk(ConfigChunk& chunk, size_t batch_size) {
+    chunk.line_count = 0;
+    chunk.track_count = 0;
+    chunk.assigned = 0;
+    chunk.settings.tuning.clear();
+    chunk.playlists.clear();
+    chunk.warnings.clear();
+    
+    std::vector<int> track_indices;
+    std::vector<StringSlice> invalid_indices;
+    
+    // Lines are slices of the mapped file; nothing is copied until a value is stored
+    StringSlice rest = chunk.text;
+    StringSlice raw_line;
+    while (StringSlice::next_token(rest, '\n', raw_line)) {
+        int line_number = ++chunk.line_count;
+        StringSlice line = raw_line.trim();
         
         // Skip empty lines and comments
         if (line.empty() || is_comment_line(line)) {
@@ -26,64 +188,255 @@ bool SessionFileParser::parse_config_file(const std::string& config_path, Sessio
         }
         
         // Parse configuration entries
-        std::string key, value;
+        StringSlice key, value;
         if (parse_key_value(line, key, value)) {
             
             if (key == "app_name") {
-                config.app_name = value;
+                chunk.settings.app_name.assign(value.data(), value.size());
+                chunk.assigned |= SET_APP_NAME;
                 
             } else if (key == "version") {
-                config.version = value;
+                chunk.settings.version.assign(value.data(), value.size());
+                chunk.assigned |= SET_VERSION;
                 
-            } else if (key.find("library_track_") == 0) {
+            } else if (key.starts_with("library_track_")) {
                 // Handle library_track_1, library_track_2, etc.
-                SessionConfig::TrackInfo track_info;
-                if (parse_library_track(value, track_info)) {
-                    config.library_tracks.push_back(track_info);
+                // Entries left by the previous chunk are overwritten in place, so
+                // their strings keep their capacity
+                size_t batch_index = chunk.track_count / batch_size;
+                size_t slot = chunk.track_count % batch_size;
+                if (batch_index == chunk.batches.size()) {
+                    chunk.batches.emplace_back();
+                }
+                std::vector<SessionConfig::TrackInfo>& batch = chunk.batches[batch_index];
+                if (slot == batch.size()) {
+                    batch.emplace_back();
+                }
+                if (parse_library_track(value, batch[slot])) {
+                    chunk.track_count++;
                 } else {
-                    std::cout << "[WARNING] Invalid track format at line " << line_number << std::endl;
+                    chunk.warnings.push_back(ConfigWarning(ConfigWarning::INVALID_TRACK, line_number,
+                                                           chunk.track_count));
                 }
                 
             } else if (key == "controller_cache_size") {
-                try {
-                    config.controller_cache_size = std::stoi(value);
-                } catch (const std::exception& e) {
-                    std::cout << "[WARNING] Invalid cache size at line " << line_number << std::endl;
+                if (parse_int(value, chunk.settings.controller_cache_size) == IntegerParseError::NONE) {
+                    chunk.assigned |= SET_CACHE_SIZE;
+                } else {
+                    chunk.warnings.push_back(ConfigWarning(ConfigWarning::INVALID_CACHE_SIZE, line_number,
+                                                           chunk.track_count));
+                }
+                
+            } else if (key == "cache_order_max_bpm_jump") {
+                if (parse_int(value, chunk.settings.cache_order_max_bpm_jump) == IntegerParseError::NONE) {
+                    chunk.assigned |= SET_BPM_JUMP;
+                } else {
+                    chunk.warnings.push_back(ConfigWarning(ConfigWarning::INVALID_BPM_JUMP, line_number,
+                                                           chunk.track_count));
                 }
                 
             } else if (key == "bpm_tolerance") {
-                try {
-                    config.bpm_tolerance = std::stoi(value);
-                } catch (const std::exception& e) {
-                    std::cout << "[WARNING] Invalid BPM tolerance at line " << line_number << std::endl;
+                if (parse_int(value, chunk.settings.bpm_tolerance) == IntegerParseError::NONE) {
+                    chunk.assigned |= SET_BPM_TOLERANCE;
+                } else {
+                    chunk.warnings.push_back(ConfigWarning(ConfigWarning::INVALID_BPM_TOLERANCE, line_number,
+                                                           chunk.track_count));
+                }
+                
+            } else if (key == "default_crossfade_time") {
+                int seconds = 0;
+                if (parse_int(value, seconds) == IntegerParseError::NONE && seconds >= 0) {
+                    chunk.settings.default_crossfade_time = seconds;
+                    chunk.assigned |= SET_CROSSFADE_TIME;
+                } else {
+                    chunk.warnings.push_back(ConfigWarning(ConfigWarning::INVALID_CROSSFADE_TIME, line_number,
+                                                           chunk.track_count));
+                }
+                
+            } else if (key == "crossfade_curve") {
+                if (parse_crossfade_curve(value.begin(), value.end(), chunk.settings.crossfade_curve)) {
+                    chunk.assigned |= SET_CROSSFADE_CURVE;
+                } else {
+                    chunk.warnings.push_back(ConfigWarning(ConfigWarning::INVALID_CROSSFADE_CURVE, line_number,
+                                                           chunk.track_count, value));
                 }
                 
             } else if (key == "auto_sync") {
-                config.auto_sync = parse_bool(value);
+                chunk.settings.auto_sync = parse_bool(value);
+                chunk.assigned |= SET_AUTO_SYNC;
+                
+            } else if (key == "playlists_directory") {
+                chunk.settings.playlists_directory.assign(value.data(), value.size());
+                chunk.assigned |= SET_PLAYLISTS_DIRECTORY;
+                
+            } else if (key.starts_with(ConfigurationManager::TUNING_PREFIX)) {
+                // Checked by ConfigurationManager once the whole file is read
+                size_t prefix_length = std::strlen(ConfigurationManager::TUNING_PREFIX);
+                chunk.settings.tuning[key.substr(prefix_length).str()] = value.str();
                 
             } else {
                 // Check if it's a playlist definition (any other key=value where value contains numbers/commas)
-                std::string playlist_name;
-                std::vector<int> track_indices;
-                if (parse_playlist_line(line, playlist_name, track_indices)) {
-                    config.playlists[playlist_name] = track_indices;
+                bool is_playlist = parse_playlist_line(value, track_indices, invalid_indices);
+                for (const StringSlice& index_text : invalid_indices) {
+                    chunk.warnings.push_back(ConfigWarning(ConfigWarning::INVALID_PLAYLIST_INDEX, line_number,
+                                                           chunk.track_count, key, index_text));
+                }
+                if (is_playlist) {
+                    chunk.playlists.push_back(std::make_pair(key.str(), track_indices));
                 } else {
-                    std::cout << "[WARNING] Unknown config key '" << key << "' at line " << line_number << std::endl;
+                    chunk.warnings.push_back(ConfigWarning(ConfigWarning::UNKNOWN_KEY, line_number,
+                                                           chunk.track_count, key));
                 }
             }
             
         } else {
-            std::cout << "[WARNING] Cannot parse line " << line_number << ": " << line << std::endl;
+            chunk.warnings.push_back(ConfigWarning(ConfigWarning::UNPARSABLE_LINE, line_number,
+                                                   chunk.track_count, line));
         }
     }
+}
+
+void SessionFileParser::print_warning(std::ostream& out, const ConfigWarning& warning, int first_line) {
+    int line_number = first_line + warning.line - 1;
+    switch (warning.kind) {
+        case ConfigWarning::INVALID_TRACK:
+            out << "[WARNING] Invalid track format at line " << line_number;
+            break;
+        case ConfigWarning::INVALID_CACHE_SIZE:
+            out << "[WARNING] Invalid cache size at line " << line_number;
+            break;
+        case ConfigWarning::INVALID_BPM_JUMP:
+            out << "[WARNING] Invalid cache order BPM limit at line " << line_number;
+            break;
+        case ConfigWarning::INVALID_BPM_TOLERANCE:
+            out << "[WARNING] Invalid BPM tolerance at line " << line_number;
+            break;
+        case ConfigWarning::INVALID_CROSSFADE_TIME:
+            out << "[WARNING] Invalid crossfade time at line " << line_number;
+            break;
+        case ConfigWarning::INVALID_CROSSFADE_CURVE:
+            out << "[WARNING] Unknown crossfade curve '" << warning.text << "' at line " << line_number
+                << " (expected equal_power or linear)";
+            break;
+        case ConfigWarning::INVALID_PLAYLIST_INDEX:
+            out << "[WARNING] Invalid track index in playlist '" << warning.text << "': "
+                << warning.index_text;
+            break;
+        case ConfigWarning::UNKNOWN_KEY:
+            out << "[WARNING] Unknown config key '" << warning.text << "' at line " << line_number;
+            break;
+        case ConfigWarning::UNPARSABLE_LINE:
+            out << "[WARNING] Cannot parse line " << line_number << ": " << warning.text;
+            break;
+    }
+}
+
+bool SessionFileParser::parse_playlist_file(const std::string& playlist_path, PlaylistData& playlist_data) {
+    MappedFile file;
+    if (!file.open(playlist_path)) {
+        std::cout << "[ERROR] Cannot open playlist file: " << playlist_path << std::endl;
+        return false;
+    }
     
-    file.close();
+    std::vector<int> invalid_lines;
+    playlist_data.name = extract_playlist_name(playlist_path);
+    parse_playlist_text(StringSlice(file.data(), file.size()), playlist_data, invalid_lines);
+    for (int line_number : invalid_lines) {
+        std::cout << "[WARNING] Invalid track format in " << playlist_path << " at line " << line_number << std::endl;
+    }
+    return true;
+}
+
+bool SessionFileParser::parse_playlist_directory(const std::string& directory, std::vector<PlaylistData>& playlists,
+                                                 unsigned thread_count) {
+    DIR* dir = opendir(directory.c_str());
+    if (dir == nullptr) {
+        return false;
+    }
     
-    std::cout << "Parsed config file: " << config.library_tracks.size() << " tracks found, " 
-              << config.playlists.size() << " playlists found" << std::endl;
+    static const char EXTENSION[] = ".playlist";
+    const size_t extension_length = sizeof(EXTENSION) - 1;
+    std::vector<std::string> file_names;
+    while (dirent* entry = readdir(dir)) {
+        size_t length = std::strlen(entry->d_name);
+        if (length > extension_length && entry->d_type != DT_DIR &&
+            std::memcmp(entry->d_name + length - extension_length, EXTENSION, extension_length) == 0) {
+            file_names.push_back(std::string(entry->d_name, length));
+        }
+    }
+    // readdir order depends on the file system
+    std::sort(file_names.begin(), file_names.end());
+    
+    // Files are opened relative to the directory, so the path is not resolved again per file
+    int directory_fd = dirfd(dir);
+    std::vector<PlaylistData> parsed(file_names.size());
+    std::vector<std::vector<int>> invalid_lines(file_names.size());
+    std::vector<char> readable(file_names.size(), 0);
+    parallel_for(file_names.size(), thread_count, [&](size_t begin, size_t end) {
+        std::string buffer;
+        for (size_t i = begin; i < end; ++i) {
+            if (read_file_at(directory_fd, file_names[i].c_str(), buffer)) {
+                readable[i] = 1;
+                parsed[i].name = extract_playlist_name(file_names[i]);
+                parse_playlist_text(StringSlice(buffer), parsed[i], invalid_lines[i]);
+            }
+        }
+    });
+    closedir(dir);
+    
+    playlists.clear();
+    playlists.reserve(file_names.size());
+    size_t track_count = 0;
+    for (size_t i = 0; i < file_names.size(); ++i) {
+        std::string path = directory + "/" + file_names[i];
+        if (!readable[i]) {
+            std::cout << "[WARNING] Cannot read playlist file: " << path << std::endl;
+            continue;
+        }
+        for (int line_number : invalid_lines[i]) {
+            std::cout << "[WARNING] Invalid track format in " << path << " at line " << line_number << std::endl;
+        }
+        track_count += parsed[i].tracks.size();
+        playlists.push_back(std::move(parsed[i]));
+    }
+    
+    std::cout << "Parsed playlist directory " << directory << ": " << playlists.size() << " playlists, "
+              << track_count << " tracks found" << std::endl;
     return true;
 }
 
+void SessionFileParser::apply_settings(const SessionConfig& settings, unsigned assigned, SessionConfig& config) {
+    if (assigned & SET_APP_NAME) {
+        config.app_name = settings.app_name;
+    }
+    if (assigned & SET_VERSION) {
+        config.version = settings.version;
+    }
+    if (assigned & SET_CACHE_SIZE) {
+        config.controller_cache_size = settings.controller_cache_size;
+    }
+    if (assigned & SET_BPM_JUMP) {
+        config.cache_order_max_bpm_jump = settings.cache_order_max_bpm_jump;
+    }
+    if (assigned & SET_BPM_TOLERANCE) {
+        config.bpm_tolerance = settings.bpm_tolerance;
+    }
+    if (assigned & SET_AUTO_SYNC) {
+        config.auto_sync = settings.auto_sync;
+    }
+    if (assigned & SET_PLAYLISTS_DIRECTORY) {
+        config.playlists_directory = settings.playlists_directory;
+    }
+    if (assigned & SET_CROSSFADE_TIME) {
+        config.default_crossfade_time = settings.default_crossfade_time;
+    }
+    if (assigned & SET_CROSSFADE_CURVE) {
+        config.crossfade_curve = settings.crossfade_curve;
+    }
+    for (const auto& entry : settings.tuning) {
+        config.tuning[entry.first] = entry.second;
+    }
+}
 
 std::string SessionFileParser::extract_playlist_name(const std::string& playlist_path) {
     // TODO: Students implement name extraction
@@ -125,132 +478,183 @@ bool SessionFileParser::validate_track_format(const std::string& line) {
 
 // ========== PRIVATE HELPER METHODS ==========
 
-std::vector<std::string> SessionFileParser::split_string(const std::string& str, char delimiter) {
-    std::vector<std::string> tokens;
-    std::stringstream ss(str);
-    std::string token;
-    
-    while (std::getline(ss, token, delimiter)) {
-        tokens.push_back(trim_string(token));
-    }
-    
-    return tokens;
-}
 
-std::string SessionFileParser::trim_string(const std::string& str) {
-    const std::string whitespace = " \t\n\r";
-    
-    size_t start = str.find_first_not_of(whitespace);
-    if (start == std::string::npos) {
-        return "";
+bool SessionFileParser::parse_bool(const StringSlice& str) {
+    // Case-insensitive "true", "1" or "yes"
+    static const char* const accepted[] = { "true", "1", "yes" };
+    for (const char* word : accepted) {
+        size_t length = std::char_traits<char>::length(word);
+        if (str.size() != length) {
+            continue;
+        }
+        bool same = true;
+        for (size_t i = 0; i < length && same; ++i) {
+            char c = str[i];
+            same = ((c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c) == word[i];
+        }
+        if (same) {
+            return true;
+        }
     }
-    
-    size_t end = str.find_last_not_of(whitespace);
-    return str.substr(start, end - start + 1);
-}
-
-bool SessionFileParser::parse_bool(const std::string& str) {
-    std::string lower_str = str;
-    std::transform(lower_str.begin(), lower_str.end(), lower_str.begin(), ::tolower);
-    
-    return (lower_str == "true" || lower_str == "1" || lower_str == "yes");
+    return false;
 }
 
-bool SessionFileParser::is_comment_line(const std::string& line) {
+bool SessionFileParser::is_comment_line(const StringSlice& line) {
     return !line.empty() && line[0] == '#';
 }
 
-bool SessionFileParser::parse_key_value(const std::string& line, std::string& key, std::string& value) {
+bool SessionFileParser::parse_key_value(const StringSlice& line, StringSlice& key, StringSlice& value) {
     size_t equals_pos = line.find('=');
-    if (equals_pos == std::string::npos) {
+    if (equals_pos == StringSlice::npos) {
         return false;
     }
     
-    key = trim_string(line.substr(0, equals_pos));
-    value = trim_string(line.substr(equals_pos + 1));
+    key = line.substr(0, equals_pos).trim();
+    value = line.substr(equals_pos + 1).trim();
     
     return !key.empty();
 }
 
-bool SessionFileParser::parse_library_track(const std::string& line, SessionConfig::TrackInfo& track_info) {
+bool SessionFileParser::parse_library_track(const StringSlice& line, SessionConfig::TrackInfo& track_info) {
     // Expected format: MP3,title,{artist1;artist2;},duration,bpm,bitrate,has_tags
     // or: WAV,title,{artist1;artist2;},duration,bpm,sample_rate,bit_depth
     
-    std::vector<std::string> parts = split_string(line, ',');
-    
-    if (parts.size() < 7) {
+    // Validate everything before allocating anything
+    StringSlice parts[TRACK_FIELD_COUNT];
+    if (!parse_track_fields(line, parts, track_info.duration_seconds, track_info.bpm,
+                            track_info.extra_param1, track_info.extra_param2)) {
         return false;
     }
     
-    try {
-        track_info.type = parts[0];
-        track_info.title = parts[1];
-        
-        // Parse artist list from {artist1;artist2;...} format
-        track_info.artists = parse_artist_list(parts[2]);
-        
-        track_info.duration_seconds = std::stoi(parts[3]);
-        track_info.bpm = std::stoi(parts[4]);
-        track_info.extra_param1 = std::stoi(parts[5]);  // bitrate or sample_rate
-        track_info.extra_param2 = std::stoi(parts[6]);  // has_tags or bit_depth
-        
-        // Validate track type is MP3 or WAV
-        if (track_info.type != "MP3" && track_info.type != "WAV") {
-            return false;
-        }
-        
-        return true;
-        
-    } catch (const std::exception& e) {
-        return false;
-    }
+    track_info.type.assign(parts[0].data(), parts[0].size());
+    track_info.title.assign(parts[1].data(), parts[1].size());
+    
+    // Parse artist list from {artist1;artist2;...} format
+    parse_artist_list(parts[2], track_info.artists);
+    
+    return true;
 }
 
-std::vector<std::string> SessionFileParser::parse_artist_list(const std::string& artist_str) {
-    std::vector<std::string> artists;
-    std::string cleaned = trim_string(artist_str);
+void SessionFileParser::parse_artist_list(const StringSlice& artist_str, std::vector<std::string>& artists) {
+    StringSlice cleaned = artist_str.trim();
     
     // Remove curly braces
-    if (cleaned.length() >= 2 && cleaned.front() == '{' && cleaned.back() == '}') {
-        cleaned = cleaned.substr(1, cleaned.length() - 2);
+    if (cleaned.size() >= 2 && cleaned.front() == '{' && cleaned.back() == '}') {
+        cleaned = cleaned.substr(1, cleaned.size() - 2);
     }
     
-    // Split by semicolon
-    std::vector<std::string> artist_parts = split_string(cleaned, ';');
-    for (const auto& artist : artist_parts) {
-        std::string trimmed = trim_string(artist);
+    // Split by semicolon, reusing the strings already in artists
+    size_t count = 0;
+    StringSlice rest = cleaned;
+    StringSlice artist;
+    while (StringSlice::next_token(rest, ';', artist)) {
+        StringSlice trimmed = artist.trim();
         if (!trimmed.empty()) {
-            artists.push_back(trimmed);
+            if (count < artists.size()) {
+                artists[count].assign(trimmed.data(), trimmed.size());
+            } else {
+                artists.push_back(trimmed.str());
+            }
+            count++;
         }
     }
+    artists.resize(count);
     
     // If no artists found, add a default
     if (artists.empty()) {
         artists.push_back("Unknown Artist");
     }
+}
+
+bool SessionFileParser::parse_track_fields(const StringSlice& line, StringSlice (&fields)[TRACK_FIELD_COUNT],
+                                           int& duration_seconds, int& bpm, int& extra_param1, int& extra_param2) {
+    // Only the first seven fields are used; anything after them is ignored
+    size_t field_count = 0;
+    StringSlice rest = line;
+    StringSlice token;
+    while (field_count < TRACK_FIELD_COUNT && StringSlice::next_token(rest, ',', token)) {
+        fields[field_count++] = token.trim();
+    }
+    
+    if (field_count < TRACK_FIELD_COUNT) {
+        return false;
+    }
+    
+    if (parse_int(fields[3], duration_seconds) != IntegerParseError::NONE ||
+        parse_int(fields[4], bpm) != IntegerParseError::NONE ||
+        parse_int(fields[5], extra_param1) != IntegerParseError::NONE ||   // bitrate or sample_rate
+        parse_int(fields[6], extra_param2) != IntegerParseError::NONE) {   // has_tags or bit_depth
+        return false;
+    }
     
-    return artists;
+    // Validate track type is MP3 or WAV
+    return fields[0] == "MP3" || fields[0] == "WAV";
 }
 
-bool SessionFileParser::parse_playlist_line(const std::string& line, std::string& playlist_name, std::vector<int>& track_indices) {
-    // Expected format: playlist_name=1,2,3,4
-    std::string key, value;
-    if (!parse_key_value(line, key, value)) {
+bool SessionFileParser::parse_playlist_track(const StringSlice& line, PlaylistData::PlaylistTrack& track) {
+    // Expected format: MP3,title,artist,duration,bpm,bitrate,has_tags
+    // or: WAV,title,artist,duration,bpm,sample_rate,bit_depth
+    StringSlice parts[TRACK_FIELD_COUNT];
+    if (!parse_track_fields(line, parts, track.duration_seconds, track.bpm,
+                            track.extra_param1, track.extra_param2)) {
         return false;
     }
     
-    playlist_name = key;
+    track.type.assign(parts[0].data(), parts[0].size());
+    track.title.assign(parts[1].data(), parts[1].size());
+    track.artist.assign(parts[2].data(), parts[2].size());
+    return true;
+}
+
+void SessionFileParser::parse_playlist_text(const StringSlice& text, PlaylistData& playlist_data,
+                                            std::vector<int>& invalid_lines) {
+    playlist_data.comment.clear();
+    playlist_data.tracks.clear();
+    invalid_lines.clear();
+    
+    int line_number = 0;
+    StringSlice rest = text;
+    StringSlice raw_line;
+    while (StringSlice::next_token(rest, '\n', raw_line)) {
+        line_number++;
+        StringSlice line = raw_line.trim();
+        if (line.empty()) {
+            continue;
+        }
+        if (is_comment_line(line)) {
+            // Only a comment on the first line describes the playlist
+            if (line_number == 1) {
+                StringSlice comment = line.substr(1).trim();
+                playlist_data.comment.assign(comment.data(), comment.size());
+            }
+            continue;
+        }
+        
+        playlist_data.tracks.emplace_back();
+        if (!parse_playlist_track(line, playlist_data.tracks.back())) {
+            playlist_data.tracks.pop_back();
+            invalid_lines.push_back(line_number);
+        }
+    }
+}
+
+bool SessionFileParser::parse_playlist_line(const StringSlice& value, std::vector<int>& track_indices,
+                                            std::vector<StringSlice>& invalid_indices) {
+    // Expected format: playlist_name=1,2,3,4
     track_indices.clear();
+    invalid_indices.clear();
     
     // Parse comma-separated indices
-    std::vector<std::string> index_strs = split_string(value, ',');
-    for (const auto& idx_str : index_strs) {
-        try {
-            int idx = std::stoi(trim_string(idx_str));
+    StringSlice rest = value;
+    StringSlice token;
+    while (StringSlice::next_token(rest, ',', token)) {
+        StringSlice idx_str = token.trim();
+        int idx = 0;
+        if (parse_int(idx_str, idx) == IntegerParseError::NONE) {
             track_indices.push_back(idx);
-        } catch (const std::exception& e) {
+        } else {
             // Skip invalid indices
-            std::cout << "[WARNING] Invalid track index in playlist '" << playlist_name << "': " << idx_str << std::endl;
+            invalid_indices.push_back(idx_str);
         }
     }
     
@@ -0,0 +1,232 @@
+#include "TrackMetadataTable.h"
+#include "LibrarySnapshot.h"
+#include "MP3Track.h"
+#include "WAVTrack.h"
+
+TrackMetadataTable::TrackMetadataTable()
+    : bpm_column(), duration_column(), format_column(), rate_column(), depth_column(),
+      quality_column(), title_column(), artist_column(), removed_column(), removed_count(0), snapshot() {}
+
+size_t TrackMetadataTable::size() const {
+    return snapshot ? snapshot->track_count() : bpm_column.size();
+}
+
+ColumnView<int> TrackMetadataTable::bpms() const {
+    return ColumnView<int>(snapshot ? snapshot->bpms() : bpm_column.data(), size());
+}
+
+ColumnView<int> TrackMetadataTable::durations() const {
+    return ColumnView<int>(snapshot ? snapshot->durations() : duration_column.data(), size());
+}
+
+ColumnView<uint8_t> TrackMetadataTable::formats() const {
+    return ColumnView<uint8_t>(snapshot ? snapshot->formats() : format_column.data(), size());
+}
+
+ColumnView<int> TrackMetadataTable::rates() const {
+    return ColumnView<int>(snapshot ? snapshot->rates() : rate_column.data(), size());
+}
+
+ColumnView<int> TrackMetadataTable::depths() const {
+    return ColumnView<int>(snapshot ? snapshot->depths() : depth_column.data(), size());
+}
+
+ColumnView<double> TrackMetadataTable::quality_scores() const {
+    return ColumnView<double>(snapshot ? snapshot->quality_scores() : quality_column.data(), size());
+}
+
+std::string TrackMetadataTable::title(size_t row) const {
+    return snapshot ? snapshot->title(row) : title_column[row];
+}
+
+std::vector<std::string> TrackMetadataTable::artists_of(size_t row) const {
+    return snapshot ? snapshot->artists(row) : artist_column[row];
+}
+
+void TrackMetadataTable::attach(const std::shared_ptr<const LibrarySnapshot>& source) {
+    clear();
+    snapshot = source;
+}
+
+void TrackMetadataTable::detach() {
+    std::shared_ptr<const LibrarySnapshot> source = snapshot;
+    snapshot.reset();
+    size_t rows = source->track_count();
+    reserve(rows);
+    for (size_t row = 0; row < rows; ++row) {
+        bpm_column.push_back(source->bpms()[row]);
+        duration_column.push_back(source->durations()[row]);
+        format_column.push_back(source->formats()[row]);
+        rate_column.push_back(source->rates()[row]);
+        depth_column.push_back(source->depths()[row]);
+        quality_column.push_back(source->quality_scores()[row]);
+        title_column.push_back(source->title(row));
+        artist_column.push_back(source->artists(row));
+    }
+    removed_column.assign(rows, 0);
+}
+
+size_t TrackMetadataTable::append(const SessionConfig::TrackInfo& track_info) {
+    if (snapshot) {
+        detach();
+    }
+    size_t row = bpm_column.size();
+    bpm_column.push_back(0);
+    duration_column.push_back(0);
+    format_column.push_back(FORMAT_MP3);
+    rate_column.push_back(0);
+    depth_column.push_back(0);
+    quality_column.push_back(0.0);
+    title_column.push_back(std::string());
+    artist_column.push_back(std::vector<std::string>());
+    removed_column.push_back(0);
+    assign(row, track_info);
+    return row;
+}
+
+void TrackMetadataTable::update(size_t row, const SessionConfig::TrackInfo& track_info) {
+    if (snapshot) {
+        detach();
+    }
+    assign(row, track_info);
+}
+
+void TrackMetadataTable::assign(size_t row, const SessionConfig::TrackInfo& track_info) {
+    // Same format rule as the rest of the library: anything but MP3 is WAV
+    bool is_mp3 = (track_info.type == "MP3" || track_info.type == "mp3");
+
+    bpm_column[row] = track_info.bpm;
+    duration_column[row] = track_info.duration_seconds;
+    format_column[row] = is_mp3 ? FORMAT_MP3 : FORMAT_WAV;
+    rate_column[row] = track_info.extra_param1;
+    depth_column[row] = track_info.extra_param2;
+    quality_column[row] = is_mp3
+        ? MP3Track::compute_quality_score(track_info.extra_param1, track_info.extra_param2 != 0)
+        : WAVTrack::compute_quality_score(track_info.extra_param1, track_info.extra_param2);
+    title_column[row] = track_info.title;
+    artist_column[row] = track_info.artists;
+}
+
+bool TrackMetadataTable::matches(size_t row, const SessionConfig::TrackInfo& track_info) const {
+    bool is_mp3 = (track_info.type == "MP3" || track_info.type == "mp3");
+    if (is_removed(row) ||
+        bpms()[row] != track_info.bpm ||
+        durations()[row] != track_info.duration_seconds ||
+        formats()[row] != (is_mp3 ? FORMAT_MP3 : FORMAT_WAV) ||
+        rates()[row] != track_info.extra_param1 ||
+        depths()[row] != track_info.extra_param2) {
+        return false;
+    }
+    // Cold columns last; owned rows are compared in place
+    if (snapshot) {
+        return snapshot->title(row) == track_info.title && snapshot->artists(row) == track_info.artists;
+    }
+    return title_column[row] == track_info.title && artist_column[row] == track_info.artists;
+}
+
+void TrackMetadataTable::remove(size_t row) {
+    if (snapshot) {
+        detach();
+    }
+    if (removed_column[row] == 0) {
+        removed_column[row] = 1;
+        removed_count++;
+    }
+}
+
+void TrackMetadataTable::reserve(size_t rows) {
+    bpm_column.reserve(rows);
+    duration_column.reserve(rows);
+    format_column.reserve(rows);
+    rate_column.reserve(rows);
+    depth_column.reserve(rows);
+    quality_column.reserve(rows);
+    title_column.reserve(rows);
+    artist_column.reserve(rows);
+    removed_column.reserve(rows);
+}
+
+void TrackMetadataTable::clear() {
+    bpm_column.clear();
+    duration_column.clear();
+    format_column.clear();
+    rate_column.clear();
+    depth_column.clear();
+    quality_column.clear();
+    title_column.clear();
+    artist_column.clear();
+    removed_column.clear();
+    removed_count = 0;
+    snapshot.reset();
+}
+
+AudioTrack* TrackMetadataTable::materialize(size_t row) const {
+    std::string track_title = title(row);
+    std::vector<std::string> track_artists = artists_of(row);
+    int duration = durations()[row];
+    int bpm = bpms()[row];
+    int rate = rates()[row];
+    int depth = depths()[row];
+    bool is_mp3 = formats()[row] == FORMAT_MP3;
+
+    size_t sample_count = 0;
+    const double* waveform = snapshot ? snapshot->waveform(row, sample_count) : nullptr;
+    if (waveform != nullptr) {
+        if (is_mp3) {
+            return new MP3Track(track_title, track_artists, duration, bpm, rate, depth != 0, waveform, sample_count);
+        }
+        return new WAVTrack(track_title, track_artists, duration, bpm, rate, depth, waveform, sample_count);
+    }
+    // Config rows (or a snapshot with a corrupt waveform index) get a generated waveform
+    if (is_mp3) {
+        return new MP3Track(track_title, track_artists, duration, bpm, rate, depth != 0);
+    }
+    return new WAVTrack(track_title, track_artists, duration, bpm, rate, depth);
+}
+
+long long TrackMetadataTable::total_duration() const {
+    ColumnView<int> durations_view = durations();
+    const uint8_t* removed = removed_rows();
+    long long total = 0;
+    for (size_t i = 0; i < durations_view.size(); ++i) {
+        if (removed != nullptr && removed[i]) continue;
+        total += durations_view[i];
+    }
+    return total;
+}
+
+double TrackMetadataTable::average_bpm() const {
+    ColumnView<int> bpms_view = bpms();
+    if (live_size() == 0) {
+        return 0.0;
+    }
+    const uint8_t* removed = removed_rows();
+    long long total = 0;
+    for (size_t i = 0; i < bpms_view.size(); ++i) {
+        if (removed != nullptr && removed[i]) continue;
+        total += bpms_view[i];
+    }
+    return static_cast<double>(total) / live_size();
+}
+
+size_t TrackMetadataTable::count_in_bpm_range(int min_bpm, int max_bpm) const {
+    ColumnView<int> bpms_view = bpms();
+    const uint8_t* removed = removed_rows();
+    size_t count = 0;
+    for (size_t i = 0; i < bpms_view.size(); ++i) {
+        if (removed != nullptr && removed[i]) continue;
+        count += (bpms_view[i] >= min_bpm && bpms_view[i] <= max_bpm) ? 1 : 0;
+    }
+    return count;
+}
+
+size_t TrackMetadataTable::count_with_quality(double min_quality) const {
+    ColumnView<double> quality_view = quality_scores();
+    const uint8_t* removed = removed_rows();
+    size_t count = 0;
+    for (size_t i = 0; i < quality_view.size(); ++i) {
+        if (removed != nullptr && removed[i]) continue;
+        count += (quality_view[i] >= min_quality) ? 1 : 0;
+    }
+    return count;
+}
@@ -0,0 +1,393 @@
+#include "TrackQueryIndex.h"
+#include <algorithm>
+#include <climits>
+
+namespace {
+    const size_t NO_DRIVER = static_cast<size_t>(-1);
+    // The unsorted delta is merged once it exceeds max(MIN_DELTA, rows / DELTA_FRACTION)
+    const size_t MIN_DELTA = 1024;
+    const size_t DELTA_FRACTION = 64;
+
+    void set_bit(std::vector<uint64_t>& bitmap, size_t row) {
+        bitmap[row >> 6] |= uint64_t(1) << (row & 63);
+    }
+
+    void clear_bit(std::vector<uint64_t>& bitmap, size_t row) {
+        bitmap[row >> 6] &= ~(uint64_t(1) << (row & 63));
+    }
+}
+
+TrackQueryIndex::TrackQueryIndex()
+    : row_count(0), rows_by_bpm(), sorted_bpms(), rows_by_duration(), sorted_durations(),
+      format_bitmaps(), quality_bitmaps(), artist_postings(), live_rows(), row_flags(), pending_rows(),
+      stale_entries(0) {}
+
+size_t TrackQueryIndex::quality_bucket(double score) {
+    if (score <= 0.0) {
+        return 0;
+    }
+    return std::min(QUALITY_BUCKETS - 1, static_cast<size_t>(score / 10.0));
+}
+
+void TrackQueryIndex::build(const TrackMetadataTable& table) {
+    row_count = table.size();
+    ColumnView<int> bpms = table.bpms();
+    ColumnView<int> durations = table.durations();
+    ColumnView<uint8_t> formats = table.formats();
+    ColumnView<double> qualities = table.quality_scores();
+
+    // Sorted indexes: stable sort keeps equal values in row (ID) order
+    rows_by_bpm.clear();
+    rows_by_bpm.reserve(table.live_size());
+    for (size_t row = 0; row < row_count; ++row) {
+        if (!table.is_removed(row)) {
+            rows_by_bpm.push_back(static_cast<uint32_t>(row));
+        }
+    }
+    rows_by_duration = rows_by_bpm;
+    std::stable_sort(rows_by_bpm.begin(), rows_by_bpm.end(),
+                     [&bpms](uint32_t a, uint32_t b) { return bpms[a] < bpms[b]; });
+    std::stable_sort(rows_by_duration.begin(), rows_by_duration.end(),
+                     [&durations](uint32_t a, uint32_t b) { return durations[a] < durations[b]; });
+    sorted_bpms.resize(rows_by_bpm.size());
+    sorted_durations.resize(rows_by_duration.size());
+    for (size_t i = 0; i < rows_by_bpm.size(); ++i) {
+        sorted_bpms[i] = bpms[rows_by_bpm[i]];
+        sorted_durations[i] = durations[rows_by_duration[i]];
+    }
+
+    // Bitmaps
+    size_t words = (row_count + 63) / 64;
+    for (Bitmap& bitmap : format_bitmaps) {
+        bitmap.assign(words, 0);
+    }
+    for (Bitmap& bitmap : quality_bitmaps) {
+        bitmap.assign(words, 0);
+    }
+    live_rows.assign(words, 0);
+    row_flags.assign(row_count, ROW_SORTED);
+    pending_rows.clear();
+    stale_entries = 0;
+    artist_postings.clear();
+    for (size_t row = 0; row < row_count; ++row) {
+        if (table.is_removed(row)) {
+            row_flags[row] = 0;
+            continue;
+        }
+        set_bit(live_rows, row);
+        set_bit(format_bitmaps[formats[row] == TrackMetadataTable::FORMAT_MP3 ? 0 : 1], row);
+        set_bit(quality_bitmaps[quality_bucket(qualities[row])], row);
+        // Rows are visited in order, so every posting list stays sorted
+        for (const std::string& artist : table.artists_of(row)) {
+            std::vector<uint32_t>& postings = artist_postings[artist];
+            if (postings.empty() || postings.back() != row) {
+                postings.push_back(static_cast<uint32_t>(row));
+            }
+        }
+    }
+}
+
+void TrackQueryIndex::insert(const TrackMetadataTable& table, size_t row) {
+    if (row >= row_count) {
+        row_count = row + 1;
+        size_t words = (row_count + 63) / 64;
+        for (Bitmap& bitmap : format_bitmaps) {
+            bitmap.resize(words, 0);
+        }
+        for (Bitmap& bitmap : quality_bitmaps) {
+            bitmap.resize(words, 0);
+        }
+        live_rows.resize(words, 0);
+        row_flags.resize(row_count, 0);
+    }
+    if (is_live(row)) {
+        return;
+    }
+
+    set_bit(live_rows, row);
+    set_bit(format_bitmaps[table.formats()[row] == TrackMetadataTable::FORMAT_MP3 ? 0 : 1], row);
+    set_bit(quality_bitmaps[quality_bucket(table.quality_scores()[row])], row);
+    for (const std::string& artist : table.artists_of(row)) {
+        std::vector<uint32_t>& postings = artist_postings[artist];
+        std::vector<uint32_t>::iterator it = std::lower_bound(postings.begin(), postings.end(), row);
+        if (it == postings.end() || *it != row) {
+            postings.insert(it, static_cast<uint32_t>(row));
+        }
+    }
+    if (!(row_flags[row] & ROW_PENDING)) {
+        pending_rows.push_back(static_cast<uint32_t>(row));
+        row_flags[row] |= ROW_PENDING;
+    }
+    compact_if_needed(table);
+}
+
+void TrackQueryIndex::erase(const TrackMetadataTable& table, size_t row) {
+    if (row >= row_count || !is_live(row)) {
+        return;
+    }
+
+    clear_bit(live_rows, row);
+    clear_bit(format_bitmaps[table.formats()[row] == TrackMetadataTable::FORMAT_MP3 ? 0 : 1], row);
+    clear_bit(quality_bitmaps[quality_bucket(table.quality_scores()[row])], row);
+    for (const std::string& artist : table.artists_of(row)) {
+        auto postings = artist_postings.find(artist);
+        if (postings == artist_postings.end()) {
+            continue;
+        }
+        std::vector<uint32_t>::iterator it = std::lower_bound(postings->second.begin(), postings->second.end(), row);
+        if (it != postings->second.end() && *it == row) {
+            postings->second.erase(it);
+        }
+        if (postings->second.empty()) {
+            artist_postings.erase(postings);
+        }
+    }
+    if (row_flags[row] & ROW_SORTED) {
+        row_flags[row] &= ~ROW_SORTED;
+        stale_entries++;
+    }
+    compact_if_needed(table);
+}
+
+void TrackQueryIndex::compact_if_needed(const TrackMetadataTable& table) {
+    if (pending_rows.size() + stale_entries <= std::max(MIN_DELTA, row_count / DELTA_FRACTION)) {
+        return;
+    }
+    ColumnView<int> bpms = table.bpms();
+    ColumnView<int> durations = table.durations();
+
+    std::vector<uint32_t> added;
+    for (uint32_t row : pending_rows) {
+        if (is_live(row)) {
+            added.push_back(row);
+        }
+    }
+    std::sort(added.begin(), added.end(), [&bpms](uint32_t a, uint32_t b) {
+        return bpms[a] < bpms[b] || (bpms[a] == bpms[b] && a < b);
+    });
+    merge_sorted(rows_by_bpm, sorted_bpms, added, bpms, row_flags);
+    std::sort(added.begin(), added.end(), [&durations](uint32_t a, uint32_t b) {
+        return durations[a] < durations[b] || (durations[a] == durations[b] && a < b);
+    });
+    merge_sorted(rows_by_duration, sorted_durations, added, durations, row_flags);
+
+    for (uint32_t row : pending_rows) {
+        row_flags[row] = is_live(row) ? ROW_SORTED : 0;
+    }
+    pending_rows.clear();
+    stale_entries = 0;
+}
+
+void TrackQueryIndex::merge_sorted(std::vector<uint32_t>& sorted_rows, std::vector<int>& sorted_values,
+                                   const std::vector<uint32_t>& rows, const ColumnView<int>& values,
+                                   const std::vector<uint8_t>& row_flags) {
+    std::vector<uint32_t> merged_rows;
+    std::vector<int> merged_values;
+    merged_rows.reserve(sorted_rows.size() + rows.size());
+    merged_values.reserve(sorted_rows.size() + rows.size());
+
+    size_t next = 0;
+    for (size_t i = 0; i < sorted_rows.size(); ++i) {
+        uint32_t row = sorted_rows[i];
+        if (!(row_flags[row] & ROW_SORTED)) {
+            continue;
+        }
+        while (next < rows.size() && (values[rows[next]] < sorted_values[i] ||
+                                      (values[rows[next]] == sorted_values[i] && rows[next] < row))) {
+            merged_rows.push_back(rows[next]);
+            merged_values.push_back(values[rows[next]]);
+            next++;
+        }
+        merged_rows.push_back(row);
+        merged_values.push_back(sorted_values[i]);
+    }
+    for (; next < rows.size(); ++next) {
+        merged_rows.push_back(rows[next]);
+        merged_values.push_back(values[rows[next]]);
+    }
+    sorted_rows.swap(merged_rows);
+    sorted_values.swap(merged_values);
+}
+
+const std::vector<uint32_t>* TrackQueryIndex::artist_rows(const std::string& artist) const {
+    auto it = artist_postings.find(artist);
+    return (it != artist_postings.end()) ? &it->second : nullptr;
+}
+
+void TrackQueryIndex::value_range(const std::vector<int>& sorted_values, int lo, int hi,
+                                  size_t& begin, size_t& end) {
+    begin = std::lower_bound(sorted_values.begin(), sorted_values.end(), lo) - sorted_values.begin();
+    end = std::upper_bound(sorted_values.begin(), sorted_values.end(), hi) - sorted_values.begin();
+    if (end < begin) {
+        end = begin;
+    }
+}
+
+bool TrackQueryIndex::matches(const TrackMetadataTable& table, const TrackQuery& query, size_t row,
+                              const std::vector<uint32_t>* artist_rows) const {
+    int bpm = table.bpms()[row];
+    int duration = table.durations()[row];
+    if (query.min_bpm >= 0 && bpm < query.min_bpm) return false;
+    if (query.max_bpm >= 0 && bpm > query.max_bpm) return false;
+    if (query.min_duration >= 0 && duration < query.min_duration) return false;
+    if (query.max_duration >= 0 && duration > query.max_duration) return false;
+    if (query.format == TrackQuery::MP3_ONLY && table.formats()[row] != TrackMetadataTable::FORMAT_MP3) return false;
+    if (query.format == TrackQuery::WAV_ONLY && table.formats()[row] == TrackMetadataTable::FORMAT_MP3) return false;
+    if (query.min_quality >= 0.0 && table.quality_scores()[row] < query.min_quality) return false;
+    if (artist_rows != nullptr &&
+        !std::binary_search(artist_rows->begin(), artist_rows->end(), static_cast<uint32_t>(row))) {
+        return false;
+    }
+    return true;
+}
+
+std::vector<int> TrackQueryIndex::run(const TrackMetadataTable& table, const TrackQuery& query) const {
+    std::vector<uint32_t> hits;
+    if (row_count == 0 || row_count != table.size()) {
+        return std::vector<int>();
+    }
+
+    const std::vector<uint32_t>* artist_rows = nullptr;
+    if (!query.artist.empty()) {
+        auto it = artist_postings.find(query.artist);
+        if (it == artist_postings.end()) {
+            return std::vector<int>();
+        }
+        artist_rows = &it->second;
+    }
+
+    // Candidate ranges from the sorted indexes
+    bool has_bpm = query.min_bpm >= 0 || query.max_bpm >= 0;
+    bool has_duration = query.min_duration >= 0 || query.max_duration >= 0;
+    size_t bpm_begin = 0, bpm_end = 0, duration_begin = 0, duration_end = 0;
+    if (has_bpm) {
+        value_range(sorted_bpms, query.min_bpm >= 0 ? query.min_bpm : INT_MIN,
+                    query.max_bpm >= 0 ? query.max_bpm : INT_MAX, bpm_begin, bpm_end);
+    }
+    if (has_duration) {
+        value_range(sorted_durations, query.min_duration >= 0 ? query.min_duration : INT_MIN,
+                    query.max_duration >= 0 ? query.max_duration : INT_MAX, duration_begin, duration_end);
+    }
+
+    // Drive from the smallest candidate list: 0 = BPM, 1 = duration, 2 = artist
+    size_t driver = NO_DRIVER;
+    size_t driver_size = row_count;
+    if (has_bpm && bpm_end - bpm_begin <= driver_size) {
+        driver = 0;
+        driver_size = bpm_end - bpm_begin;
+    }
+    if (has_duration && duration_end - duration_begin < driver_size) {
+        driver = 1;
+        driver_size = duration_end - duration_begin;
+    }
+    if (artist_rows != nullptr && artist_rows->size() < driver_size) {
+        driver = 2;
+        driver_size = artist_rows->size();
+    }
+
+    bool in_order = false;   // hits already sorted the way the query wants
+    if (driver == 0 || driver == 1) {
+        const std::vector<uint32_t>& sorted_rows = (driver == 0) ? rows_by_bpm : rows_by_duration;
+        size_t begin = (driver == 0) ? bpm_begin : duration_begin;
+        size_t end = (driver == 0) ? bpm_end : duration_end;
+        bool index_order = (driver == 0 && query.order_by == TrackQuery::BY_BPM) ||
+                           (driver == 1 && query.order_by == TrackQuery::BY_DURATION);
+        // Rows added or changed since the last merge are not in the sorted indexes
+        for (uint32_t row : pending_rows) {
+            if (is_live(row) && matches(table, query, row, artist_rows)) {
+                hits.push_back(row);
+            }
+        }
+        in_order = index_order && hits.empty();
+        size_t sorted_hits = 0;
+        for (size_t i = begin; i < end; ++i) {
+            uint32_t row = sorted_rows[i];
+            if ((row_flags[row] & ROW_SORTED) && matches(table, query, row, artist_rows)) {
+                hits.push_back(row);
+                // Index order is (value, ID), so the first k hits are the top k of the sorted part
+                if (index_order && query.limit > 0 && ++sorted_hits == query.limit) {
+                    break;
+                }
+            }
+        }
+    } else if (driver == 2) {
+        in_order = (query.order_by == TrackQuery::BY_ID);
+        for (uint32_t row : *artist_rows) {
+            if (matches(table, query, row, artist_rows)) {
+                hits.push_back(row);
+                // Postings are in ID order
+                if (in_order && hits.size() == query.limit) {
+                    break;
+                }
+            }
+        }
+    } else {
+        // No selective range: intersect the format and quality bitmaps
+        size_t words = (row_count + 63) / 64;
+        bool use_format = query.format != TrackQuery::ANY_FORMAT;
+        const Bitmap& format_bitmap = format_bitmaps[query.format == TrackQuery::MP3_ONLY
+                                                         ? TrackMetadataTable::FORMAT_MP3
+                                                         : TrackMetadataTable::FORMAT_WAV];
+        size_t first_bucket = (query.min_quality >= 0.0) ? quality_bucket(query.min_quality) : 0;
+        in_order = (query.order_by == TrackQuery::BY_ID);
+
+        for (size_t w = 0; w < words && !(in_order && query.limit > 0 && hits.size() >= query.limit); ++w) {
+            uint64_t word = live_rows[w];
+            if (use_format) {
+                word &= format_bitmap[w];
+            }
+            if (first_bucket > 0) {
+                uint64_t quality_word = 0;
+                for (size_t b = first_bucket; b < QUALITY_BUCKETS; ++b) {
+                    quality_word |= quality_bitmaps[b][w];
+                }
+                word &= quality_word;
+            }
+            while (word != 0) {
+                size_t row = w * 64 + static_cast<size_t>(__builtin_ctzll(word));
+                word &= word - 1;
+                // Still checks the exact quality inside the lowest bucket
+                if (matches(table, query, row, artist_rows)) {
+                    hits.push_back(static_cast<uint32_t>(row));
+                }
+            }
+        }
+    }
+
+    if (!in_order) {
+        ColumnView<int> bpms = table.bpms();
+        ColumnView<int> durations = table.durations();
+        ColumnView<double> qualities = table.quality_scores();
+        auto before = [&](uint32_t a, uint32_t b) {
+            switch (query.order_by) {
+                case TrackQuery::BY_BPM:
+                    if (bpms[a] != bpms[b]) return bpms[a] < bpms[b];
+                    break;
+                case TrackQuery::BY_DURATION:
+                    if (durations[a] != durations[b]) return durations[a] < durations[b];
+                    break;
+                case TrackQuery::BY_QUALITY_DESC:
+                    if (qualities[a] != qualities[b]) return qualities[a] > qualities[b];
+                    break;
+                case TrackQuery::BY_ID:
+                    break;
+            }
+            return a < b;
+        };
+        if (query.limit > 0 && query.limit < hits.size()) {
+            std::partial_sort(hits.begin(), hits.begin() + query.limit, hits.end(), before);
+        } else {
+            std::sort(hits.begin(), hits.end(), before);
+        }
+    }
+    if (query.limit > 0 && hits.size() > query.limit) {
+        hits.resize(query.limit);
+    }
+
+    std::vector<int> ids;
+    ids.reserve(hits.size());
+    for (uint32_t row : hits) {
+        ids.push_back(static_cast<int>(row) + 1);
+    }
+    return ids;
+}
@@ -0,0 +1,92 @@
+#include "TrackStore.h"
+#include <utility>
+
+TrackStore::TrackStore() : mp3_tracks(), mp3_rows(), wav_tracks(), wav_rows(), slots() {}
+
+bool TrackStore::assign(const std::vector<AudioTrack*>& tracks) {
+    clear();
+    slots.reserve(tracks.size());
+    bool all_known = true;
+    for (const AudioTrack* track : tracks) {
+        // The only per-track type test; the kernels never repeat it
+        if (const MP3Track* mp3 = dynamic_cast<const MP3Track*>(track)) {
+            add(MP3Track(*mp3));
+        } else if (const WAVTrack* wav = dynamic_cast<const WAVTrack*>(track)) {
+            add(WAVTrack(*wav));
+        } else {
+            all_known = false;
+        }
+    }
+    return all_known;
+}
+
+size_t TrackStore::add(MP3Track&& track) {
+    Slot slot = { static_cast<uint32_t>(mp3_tracks.size()), MP3_PARTITION };
+    mp3_tracks.push_back(std::move(track));
+    mp3_rows.push_back(static_cast<uint32_t>(slots.size()));
+    slots.push_back(slot);
+    return slots.size() - 1;
+}
+
+size_t TrackStore::add(WAVTrack&& track) {
+    Slot slot = { static_cast<uint32_t>(wav_tracks.size()), WAV_PARTITION };
+    wav_tracks.push_back(std::move(track));
+    wav_rows.push_back(static_cast<uint32_t>(slots.size()));
+    slots.push_back(slot);
+    return slots.size() - 1;
+}
+
+void TrackStore::clear() {
+    mp3_tracks.clear();
+    mp3_rows.clear();
+    wav_tracks.clear();
+    wav_rows.clear();
+    slots.clear();
+}
+
+const AudioTrack& TrackStore::at(size_t row) const {
+    const Slot& slot = slots[row];
+    if (slot.partition == MP3_PARTITION) {
+        return mp3_tracks[slot.index];
+    }
+    return wav_tracks[slot.index];
+}
+
+std::vector<double> TrackStore::score_all() const {
+    std::vector<double> scores(slots.size());
+    for (size_t i = 0; i < mp3_tracks.size(); ++i) {
+        const MP3Track& track = mp3_tracks[i];
+        scores[mp3_rows[i]] = MP3Track::compute_quality_score(track.get_bitrate(), track.has_tags());
+    }
+    for (size_t i = 0; i < wav_tracks.size(); ++i) {
+        const WAVTrack& track = wav_tracks[i];
+        scores[wav_rows[i]] = WAVTrack::compute_quality_score(track.get_sample_rate(), track.get_bit_depth());
+    }
+    return scores;
+}
+
+std::vector<TrackStore::BeatgridAnalysis> TrackStore::analyze_all() const {
+    std::vector<BeatgridAnalysis> results(slots.size());
+    for (size_t i = 0; i < mp3_tracks.size(); ++i) {
+        const MP3Track& track = mp3_tracks[i];
+        BeatgridAnalysis analysis = { track.get_estimated_beats(), track.get_precision_factor() };
+        results[mp3_rows[i]] = analysis;
+    }
+    for (size_t i = 0; i < wav_tracks.size(); ++i) {
+        const WAVTrack& track = wav_tracks[i];
+        BeatgridAnalysis analysis = { track.get_estimated_beats(), track.get_precision_factor() };
+        results[wav_rows[i]] = analysis;
+    }
+    return results;
+}
+
+void TrackStore::prepare_all() {
+    for (MP3Track& track : mp3_tracks) {
+        track.load();
+        track.analyze_beatgrid();
+    }
+    for (WAVTrack& track : wav_tracks) {
+        track.load();
+        track.analyze_beatgrid();
+    }
+}
@@ -0,0 +1,247 @@
+#include "TrackSuggestionIndex.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // The tree is rebuilt once pending rows and stale points exceed max(MIN_DELTA, rows / DELTA_FRACTION)
+    const size_t MIN_DELTA = 1024;
+    const size_t DELTA_FRACTION = 64;
+}
+
+TrackSuggestionIndex::TrackSuggestionIndex()
+    : weights(), scales(), points(), split_dims(), row_flags(), pending_rows(), stale_points(0) {
+    scales[0] = weights.bpm;
+    scales[1] = weights.quality;
+    scales[2] = weights.duration;
+}
+
+void TrackSuggestionIndex::features(int bpm, double quality, int duration, double* coords) {
+    coords[0] = bpm;
+    coords[1] = quality;
+    coords[2] = duration;
+}
+
+double TrackSuggestionIndex::squared_distance(const double* a, const double* b) const {
+    double total = 0.0;
+    for (size_t d = 0; d < DIMENSIONS; ++d) {
+        double diff = (a[d] - b[d]) * scales[d];
+        total += diff * diff;
+    }
+    return total;
+}
+
+void TrackSuggestionIndex::build(const TrackMetadataTable& table, const Weights& new_weights) {
+    weights = new_weights;
+    scales[0] = weights.bpm;
+    scales[1] = weights.quality;
+    scales[2] = weights.duration;
+
+    row_flags.assign(table.size(), 0);
+    for (size_t row = 0; row < table.size(); ++row) {
+        if (!table.is_removed(row)) {
+            row_flags[row] = ROW_LIVE;
+        }
+    }
+    pending_rows.clear();
+    rebuild(table);
+}
+
+void TrackSuggestionIndex::rebuild(const TrackMetadataTable& table) {
+    ColumnView<int> bpms = table.bpms();
+    ColumnView<double> qualities = table.quality_scores();
+    ColumnView<int> durations = table.durations();
+
+    points.clear();
+    for (size_t row = 0; row < row_flags.size(); ++row) {
+        row_flags[row] &= ROW_LIVE;
+        if (row_flags[row] & ROW_LIVE) {
+            Point point;
+            features(bpms[row], qualities[row], durations[row], point.coords);
+            point.row = static_cast<uint32_t>(row);
+            points.push_back(point);
+            row_flags[row] |= ROW_IN_TREE;
+        }
+    }
+    pending_rows.clear();
+    stale_points = 0;
+    split_dims.assign(points.size(), 0);
+    build_range(0, points.size());
+}
+
+void TrackSuggestionIndex::rebuild_if_needed(const TrackMetadataTable& table) {
+    if (pending_rows.size() + stale_points > std::max(MIN_DELTA, row_flags.size() / DELTA_FRACTION)) {
+        rebuild(table);
+    }
+}
+
+void TrackSuggestionIndex::insert(const TrackMetadataTable& table, size_t row) {
+    if (row >= row_flags.size()) {
+        row_flags.resize(row + 1, 0);
+    }
+    if (row_flags[row] & ROW_LIVE) {
+        return;
+    }
+    row_flags[row] |= ROW_LIVE;
+    if (!(row_flags[row] & ROW_PENDING)) {
+        pending_rows.push_back(static_cast<uint32_t>(row));
+        row_flags[row] |= ROW_PENDING;
+    }
+    rebuild_if_needed(table);
+}
+
+void TrackSuggestionIndex::erase(const TrackMetadataTable& table, size_t row) {
+    if (row >= row_flags.size() || !(row_flags[row] & ROW_LIVE)) {
+        return;
+    }
+    row_flags[row] &= ~ROW_LIVE;
+    if (row_flags[row] & ROW_IN_TREE) {
+        row_flags[row] &= ~ROW_IN_TREE;
+        stale_points++;
+    }
+    rebuild_if_needed(table);
+}
+
+void TrackSuggestionIndex::offer(const Candidate& candidate, size_t k, std::vector<Candidate>& heap) {
+    if (heap.size() < k) {
+        heap.push_back(candidate);
+        std::push_heap(heap.begin(), heap.end());
+    } else if (candidate < heap.front()) {
+        std::pop_heap(heap.begin(), heap.end());
+        heap.back() = candidate;
+        std::push_heap(heap.begin(), heap.end());
+    }
+}
+
+void TrackSuggestionIndex::build_range(size_t begin, size_t end) {
+    if (end - begin <= 1) {
+        return;
+    }
+    // Split on the dimension with the widest weighted spread in this range
+    double low[DIMENSIONS], high[DIMENSIONS];
+    for (size_t d = 0; d < DIMENSIONS; ++d) {
+        low[d] = high[d] = points[begin].coords[d];
+    }
+    for (size_t i = begin + 1; i < end; ++i) {
+        for (size_t d = 0; d < DIMENSIONS; ++d) {
+            low[d] = std::min(low[d], points[i].coords[d]);
+            high[d] = std::max(high[d], points[i].coords[d]);
+        }
+    }
+    size_t dim = 0;
+    for (size_t d = 1; d < DIMENSIONS; ++d) {
+        if ((high[d] - low[d]) * scales[d] > (high[dim] - low[dim]) * scales[dim]) {
+            dim = d;
+        }
+    }
+
+    size_t mid = begin + (end - begin) / 2;
+    std::nth_element(points.begin() + begin, points.begin() + mid, points.begin() + end,
+                     [dim](const Point& a, const Point& b) { return a.coords[dim] < b.coords[dim]; });
+    split_dims[mid] = static_cast<uint8_t>(dim);
+    build_range(begin, mid);
+    build_range(mid + 1, end);
+}
+
+void TrackSuggestionIndex::search(size_t begin, size_t end, const double* target, size_t k,
+                                  const std::vector<uint32_t>& excluded, std::vector<Candidate>& heap) const {
+    if (begin >= end) {
+        return;
+    }
+    size_t mid = begin + (end - begin) / 2;
+    const Point& point = points[mid];
+
+    if ((row_flags[point.row] & ROW_IN_TREE) &&
+        !std::binary_search(excluded.begin(), excluded.end(), point.row)) {
+        Candidate candidate = { squared_distance(point.coords, target), point.row };
+        offer(candidate, k, heap);
+    }
+
+    if (end - begin == 1) {
+        return;
+    }
+    size_t dim = split_dims[mid];
+    double diff = (target[dim] - point.coords[dim]) * scales[dim];
+    bool go_left = target[dim] < point.coords[dim];
+    if (go_left) {
+        search(begin, mid, target, k, excluded, heap);
+    } else {
+        search(mid + 1, end, target, k, excluded, heap);
+    }
+    // The other side can only help if the splitting plane is within the current k-th
+    // distance (<= so that equal-distance points with a lower ID are still found)
+    if (heap.size() < k || diff * diff <= heap.front().squared_distance) {
+        if (go_left) {
+            search(mid + 1, end, target, k, excluded, heap);
+        } else {
+            search(begin, mid, target, k, excluded, heap);
+        }
+    }
+}
+
+std::vector<TrackSuggestionIndex::Suggestion> TrackSuggestionIndex::nearest(
+        const TrackMetadataTable& table, const TrackQueryIndex& artist_index, const Query& query, size_t k) const {
+    std::vector<Suggestion> result;
+    if (k == 0 || row_flags.size() != table.size()) {
+        return result;
+    }
+    double target[DIMENSIONS];
+    features(query.bpm, query.quality, query.duration, target);
+
+    // Rows sharing an artist with the query are scored separately (with the bonus)
+    std::vector<uint32_t> sharing;
+    for (const std::string& artist : query.artists) {
+        const std::vector<uint32_t>* rows = artist_index.artist_rows(artist);
+        if (rows != nullptr) {
+            sharing.insert(sharing.end(), rows->begin(), rows->end());
+        }
+    }
+    std::sort(sharing.begin(), sharing.end());
+    sharing.erase(std::unique(sharing.begin(), sharing.end()), sharing.end());
+
+    std::vector<uint32_t> excluded(sharing);
+    if (query.exclude_row < row_flags.size()) {
+        excluded.insert(std::lower_bound(excluded.begin(), excluded.end(), static_cast<uint32_t>(query.exclude_row)),
+                        static_cast<uint32_t>(query.exclude_row));
+    }
+
+    std::vector<Candidate> heap;
+    heap.reserve(k + 1);
+    search(0, points.size(), target, k, excluded, heap);
+
+    // Rows added or changed since the last rebuild are not in the tree
+    ColumnView<int> bpms = table.bpms();
+    ColumnView<double> qualities = table.quality_scores();
+    ColumnView<int> durations = table.durations();
+    for (uint32_t row : pending_rows) {
+        if ((row_flags[row] & ROW_LIVE) && !std::binary_search(excluded.begin(), excluded.end(), row)) {
+            double coords[DIMENSIONS];
+            features(bpms[row], qualities[row], durations[row], coords);
+            Candidate candidate = { squared_distance(coords, target), row };
+            offer(candidate, k, heap);
+        }
+    }
+
+    for (const Candidate& candidate : heap) {
+        Suggestion suggestion = { static_cast<int>(candidate.row) + 1, std::sqrt(candidate.squared_distance) };
+        result.push_back(suggestion);
+    }
+
+    for (uint32_t row : sharing) {
+        if (row == query.exclude_row) {
+            continue;
+        }
+        double coords[DIMENSIONS];
+        features(bpms[row], qualities[row], durations[row], coords);
+        Suggestion suggestion = { static_cast<int>(row) + 1,
+                                  std::sqrt(squared_distance(coords, target)) - weights.shared_artist_bonus };
+        result.push_back(suggestion);
+    }
+
+    size_t count = std::min(k, result.size());
+    std::partial_sort(result.begin(), result.begin() + count, result.end(),
+                      [](const Suggestion& a, const Suggestion& b) {
+                          return a.distance < b.distance || (a.distance == b.distance && a.track_id < b.track_id);
+                      });
+    result.resize(count);
+    return result;
+}
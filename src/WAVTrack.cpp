@@ -4,10 +4,17 @@
 WAVTrack::WAVTrack(const std::string& title, const std::vector<std::string>& artists, 
                    int duration, int bpm, int sample_rate, int bit_depth)
     : AudioTrack(title, artists, duration, bpm), sample_rate(sample_rate), bit_depth(bit_depth) {
-
+    #ifdef DEBUG
     std::cout << "WAVTrack created: " << sample_rate << "Hz/" << bit_depth << "bit" << std::endl;
+    #endif
 }
 
+WAVTrack::WAVTrack(const std::string& title, const std::vector<std::string>& artists, 
+                   int duration, int bpm, int sample_rate, int bit_depth,
+                   const double* waveform, size_t waveform_samples)
+    : AudioTrack(title, artists, duration, bpm, waveform, waveform_samples),
+      sample_rate(sample_rate), bit_depth(bit_depth) {}
+
 // ========== TODO: STUDENTS IMPLEMENT THESE VIRTUAL FUNCTIONS ==========
 
 void WAVTrack::load() {
@@ -32,7 +39,7 @@ void WAVTrack::analyze_beatgrid() {
     // 2. Calculate beats: (duration_seconds / 60.0) * bpm
     // 3. Print number of beats and mention uncompressed precision
     // should print "  → Estimated beats: <beats>  → Precision factor: 1.0 (uncompressed audio)"
-    double beats = ((double)duration_seconds / 60.0) * bpm;
+    double beats = get_estimated_beats();
     std::cout << " -> Estimated beats: " << beats 
               << " -> Precision factor: 1 (uncompressed audio)" 
               << std::endl; 
@@ -42,21 +49,7 @@ double WAVTrack::get_quality_score() const {
     // TODO: Implement WAV quality scoring
     // NOTE: Use exactly 2 spaces before each arrow (→) character
     // NOTE: Cast beats to integer when printing
-    double score = 70.0;
-    if (sample_rate >= 44100) {
-        score += 10.0;
-    }
-    if (sample_rate >= 96000) {
-        score += 5.0;
-    }
-    if (bit_depth >= 16) {
-        score += 10.0;
-    }
-     if (bit_depth >= 24) {
-        score += 5.0;
-    }
-    score = std::min(100.0, score);
-    return score;
+    return compute_quality_score(sample_rate, bit_depth);
 }
 
 PointerWrapper<AudioTrack> WAVTrack::clone() const {
@@ -13,6 +13,9 @@
 #include "DJControllerService.h"
 #include "MixingEngineService.h"
 #include "PointerWrapper.h"
+#include "ConfigGenerator.h"
+#include "Benchmarks.h"
+#include "IntegerParsing.h"
 /**
  * DJ Track Session Manager - Test Program
  * 
@@ -23,7 +26,7 @@
  * Students must fix the issues to make this program run cleanly.
  */
 
-bool del = false; // hint: what is the purpose of this variable? how it changes the ownership semantics?
+bool del = true; // Playlists borrow their tracks, so whoever created them deletes them
 void test_phase_1_memory_leaks() {
     
     std::cout << "\n======== PHASE 1: MEMORY LEAK TESTING ========" << std::endl;
@@ -161,21 +164,77 @@ int main(int argc, char* argv[]) {
     /**
      * Command-line argument parsing
      * - If "-I" is provided as the first argument, run interactive DJ software
-     * - If "-A" is provided as the second argument, enable play_all mode
+     * - If "-A" is provided after it, enable play_all mode
+     * - "-P" / "-O" preview or apply the BPM-optimized playlist order
+     * - "-C" apply the cache-optimized playlist order
+     * - "-S" as the only argument compiles bin/dj_config.txt into bin/dj_config.djlib and exits
+     * - "-G <dir> [name=value ...]" writes a synthetic workload (dir/bin/dj_config.txt and
+     *   optionally dir/playlists) for benchmarks and exits; see ConfigGenerator::parse_option
+     * - "-M [samples] [threads]" benchmarks the crossfade kernels and exits
+     * - "-B <name> [name=value ...]" runs a checked benchmark on a generated workload and exits;
+     *   see Benchmarks
      */
     bool run_software = false;
     bool play_all = false;
+    DJSession::OrderMode order_mode = DJSession::OrderMode::AS_CONFIGURED;
+    if (argc > 1 && std::string(argv[1]) == "-S") {
+        return DJSession::compile_library_snapshot() ? 0 : 1;
+    }
+    if (argc > 2 && std::string(argv[1]) == "-G") {
+        ConfigGenerator::Options options;
+        for (int i = 3; i < argc; ++i) {
+            if (!ConfigGenerator::parse_option(argv[i], options)) {
+                return 1;
+            }
+        }
+        return ConfigGenerator(options).generate(argv[2]) ? 0 : 1;
+    }
+    if (argc > 1 && std::string(argv[1]) == "-M") {
+        size_t sample_count = 1 << 24;
+        unsigned thread_count = 1;
+        for (int i = 2; i < argc && i < 4; ++i) {
+            std::string arg(argv[i]);
+            int value = 0;
+            IntegerParseResult result = parse_integer(arg.data(), arg.data() + arg.size(), value);
+            if (result.error != IntegerParseError::NONE || result.ptr != arg.data() + arg.size() || value < (i == 2 ? 1 : 0)) {
+                std::cerr << "[ERROR] Invalid " << (i == 2 ? "sample count" : "thread count") << ": " << arg << std::endl;
+                return 1;
+            }
+            if (i == 2) {
+                sample_count = static_cast<size_t>(value);
+            } else {
+                thread_count = static_cast<unsigned>(value);
+            }
+        }
+        return MixingEngineService::run_crossfade_benchmark(sample_count, thread_count) ? 0 : 1;
+    }
+    if (argc > 2 && std::string(argv[1]) == "-B") {
+        std::vector<std::string> options(argv + 3, argv + argc);
+        return Benchmarks::run(argv[2], options) ? 0 : 1;
+    }
     if (argc > 1 && std::string(argv[1]) == "-I") {
         run_software = true;
     }
 
-    if (argc > 2 && std::string(argv[2]) == "-A") {
-        play_all = true;
+    // Remaining flags may come in any order:
+    // -A play all playlists, -P preview BPM-optimized order, -O play in BPM-optimized order,
+    // -C play in cache-optimized order
+    for (int i = 2; i < argc; ++i) {
+        std::string flag(argv[i]);
+        if (flag == "-A") {
+            play_all = true;
+        } else if (flag == "-P") {
+            order_mode = DJSession::OrderMode::PREVIEW;
+        } else if (flag == "-O") {
+            order_mode = DJSession::OrderMode::BPM_OPTIMIZED;
+        } else if (flag == "-C") {
+            order_mode = DJSession::OrderMode::CACHE_OPTIMIZED;
+        }
     }
 
     if (run_software) {
         std::cout << "\n============= RUNNING INTERACTIVE SOFTWARE =============" << std::endl;
-        DJSession live_session("Interactive Session", play_all);
+        DJSession live_session("Interactive Session", play_all, order_mode);
         live_session.simulate_dj_performance();
         std::cout << "============= INTERACTIVE SESSION ENDED =============\n" << std::endl;
     } else {